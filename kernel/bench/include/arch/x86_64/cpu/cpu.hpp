@@ -0,0 +1,30 @@
+#ifndef ARCH_CPU_HPP
+#define ARCH_CPU_HPP 1
+
+// Hosted stand-in for the CPU layer used by the page-table code. CR3 loads
+// are dropped and TLB invalidations are only counted.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define FEATURE_HUGE_PAGE 26
+
+namespace arch::x86_64::cpu {
+// Pages invalidated since start, for the simulator's report.
+inline size_t invalidations = 0;
+// Whether the simulated CPU has 1 GiB pages.
+inline bool huge_pages = true;
+
+inline bool test_feature(int bit) {
+  return (bit == FEATURE_HUGE_PAGE) && huge_pages;
+}
+
+inline void invalidate_page(uintptr_t) {
+  invalidations++;
+}
+
+inline void write_cr3(uintptr_t) {
+}
+}  // namespace arch::x86_64::cpu
+
+#endif  // ARCH_CPU_HPP
@@ -0,0 +1,59 @@
+#ifndef KERNEL_LOG_HPP
+#define KERNEL_LOG_HPP
+
+// Hosted stand-in for the kernel log, for the memory simulator. Debug and
+// info records are dropped so that they do not dominate the timings;
+// warnings and errors go to stderr and a panic aborts.
+
+#include "format.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define LOG_HOST_PRINT(label, fmt, ...) \
+  fprintf(stderr, label " " fmt "\n" __VA_OPT__(, ) __VA_ARGS__)
+
+// Never printed, but the arguments still count as used.
+#define LOG_HOST_DROP(...)             \
+  do {                                 \
+    if (false) {                       \
+      LOG_HOST_PRINT("", __VA_ARGS__); \
+    }                                  \
+  } while (0)
+
+#define debug(...) LOG_HOST_DROP(__VA_ARGS__)
+
+#define info(...) LOG_HOST_DROP(__VA_ARGS__)
+
+#define warning(...) LOG_HOST_PRINT("[WARNING]", __VA_ARGS__)
+
+#define err(...) LOG_HOST_PRINT("[ERROR  ]", __VA_ARGS__)
+
+#define panic(...)                            \
+  do {                                        \
+    LOG_HOST_PRINT("[PANIC  ]", __VA_ARGS__); \
+    abort();                                  \
+  } while (0)
+
+#define log_debug(cat, ...) debug(__VA_ARGS__)
+
+#define log_info(cat, ...) info(__VA_ARGS__)
+
+#define log_warning(cat, ...) warning(__VA_ARGS__)
+
+#define log_err(cat, ...) err(__VA_ARGS__)
+
+namespace log {
+// Console output, formatted as the kernel does it.
+template <format::fixed_string Fmt, typename... Args>
+void print(const Args&... args) {
+  char line[384];
+  format::buffer_sink sink(line, sizeof(line));
+
+  format::format_printf<Fmt>(sink, args...);
+  sink.finish();
+  fputs(line, stdout);
+}
+}  // namespace log
+
+#endif  // KERNEL_LOG_HPP
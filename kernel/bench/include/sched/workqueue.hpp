@@ -0,0 +1,40 @@
+#ifndef SCHED_WORKQUEUE_HPP
+#define SCHED_WORKQUEUE_HPP 1
+
+// Hosted stand-in for the workqueue. The simulator is single threaded, so
+// queued work runs immediately in the caller.
+
+namespace sched {
+using WorkFunc = void (*)(void* cookie);
+
+class Work {
+ public:
+  constexpr Work() = default;
+
+  Work(const Work&) = delete;
+  Work(Work&&) = delete;
+
+  Work& operator=(const Work&) = delete;
+  Work& operator=(Work&&) = delete;
+
+  void set_callback(WorkFunc func, void* cookie = nullptr) {
+    this->func = func;
+    this->cookie = cookie;
+  }
+
+  void run() {
+    this->func(this->cookie);
+  }
+
+ private:
+  WorkFunc func = nullptr;
+  void* cookie = nullptr;
+};
+
+inline bool queue_unbound_work(Work* work) {
+  work->run();
+  return true;
+}
+}  // namespace sched
+
+#endif  // SCHED_WORKQUEUE_HPP
@@ -0,0 +1,786 @@
+// Memory-manager simulator. The kernel's PhysicalMemoryManager and PageMap
+// are built for the host against a synthetic Limine memory map. One large
+// anonymous mapping stands in for the HHDM, so "physical" addresses are
+// offsets into it. Allocation and mapping traces are replayed against a
+// freshly initialized allocator each. The report gives throughput, free
+// blocks and fragmentation by order, and the page-table footprint.
+//
+// Usage: memory-sim [--memory MiB] [--ops N] [--seed N] [--dump] [trace...]
+//
+// A trace is a built-in name (pages, mixed, lifo, map, sparse, huge) or a
+// file. With no trace every built-in runs. --dump prints the traces instead
+// of running them, as a starting point for hand-written ones.
+//
+// Trace format, one operation per line, '#' starts a comment:
+//   a <id> <bytes>               allocate, remember the block as <id>
+//   f <id>                       free block <id>
+//   m <virt> <length> [4k|2m|1g]  map freshly allocated pages
+//   u <virt> <length> [4k|2m|1g]  unmap and free them
+// Numbers are decimal or 0x-prefixed hex.
+
+#include "arch/paging.hpp"
+#include "arch/x86_64/cpu/cpu.hpp"
+#include "boot.hpp"
+#include "memory/memory.hpp"
+#include "memory/pagemap.hpp"
+#include "memory/physical.hpp"
+#include "microbench.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// User-half bases for the mapping traces, away from each other.
+#define SIM_MAP_BASE 0x0000100000000000ull
+#define SIM_HUGE_BASE 0x0000200000000000ull
+// Bound on the user half for the sparse trace (47-bit addresses).
+#define SIM_USER_PAGES (1ull << 35)
+
+namespace boot {
+volatile limine_memmap_request memmap_request = {};
+volatile limine_hhdm_request hhdm_request = {};
+volatile limine_executable_file_request file_request = {};
+volatile limine_executable_address_request address_request = {};
+volatile limine_paging_mode_request paging_mode_request = {};
+}  // namespace boot
+
+namespace {
+using namespace memory;
+
+struct Op {
+  char kind;
+  uint64_t a;
+  uint64_t b;
+  PageSizeType type = PageSmall;
+};
+
+struct Options {
+  size_t memory = 1024ull << 20;
+  size_t ops = 1000000;
+  uint64_t seed = 1;
+  bool dump = false;
+};
+
+// xorshift64*: cheap and the same on every host, so traces are
+// reproducible from the seed.
+struct Rng {
+  uint64_t state;
+
+  uint64_t next() {
+    this->state ^= this->state >> 12;
+    this->state ^= this->state << 25;
+    this->state ^= this->state >> 27;
+    return this->state * 0x2545f4914f6cdd1dull;
+  }
+
+  uint64_t below(uint64_t limit) {
+    return this->next() % limit;
+  }
+};
+
+// Bytes the buddy allocator hands out for a request of `bytes`.
+size_t block_bytes(size_t bytes) {
+  const size_t pages = std::max<size_t>(
+      div_roundup(bytes, std::to_underlying(PageSize4KiB)), 1);
+  const int order = pages <= 1 ? 0 : 64 - __builtin_clzll(pages - 1);
+  return std::to_underlying(PageSize4KiB) << order;
+}
+
+size_t mapped_bytes(const Op& op) {
+  const size_t page = memory::arch::from_type(op.type);
+  return div_roundup(op.b, page) * page;
+}
+
+// Tracks live blocks so generated frees always name a live id and the live
+// total stays under a budget.
+class AllocGen {
+ public:
+  AllocGen(std::vector<Op>& ops, size_t budget) : ops(ops), budget(budget) {
+  }
+
+  bool alloc(size_t bytes) {
+    const size_t charge = block_bytes(bytes);
+
+    if (this->live_bytes + charge > this->budget) {
+      return false;
+    }
+
+    uint64_t id = this->next_id;
+
+    if (!this->free_ids.empty()) {
+      id = this->free_ids.back();
+      this->free_ids.pop_back();
+    } else {
+      this->next_id++;
+    }
+
+    this->ops.push_back({'a', id, bytes});
+    this->live.push_back({id, charge});
+    this->live_bytes += charge;
+    return true;
+  }
+
+  void free(size_t index) {
+    const auto [id, charge] = this->live[index];
+
+    this->ops.push_back({'f', id, 0});
+    this->live[index] = this->live.back();
+    this->live.pop_back();
+    this->free_ids.push_back(id);
+    this->live_bytes -= charge;
+  }
+
+  void free_random(Rng& rng) {
+    this->free(rng.below(this->live.size()));
+  }
+
+  void free_last() {
+    this->free(this->live.size() - 1);
+  }
+
+  size_t count() const {
+    return this->live.size();
+  }
+
+ private:
+  std::vector<Op>& ops;
+  size_t budget;
+  size_t live_bytes = 0;
+  uint64_t next_id = 0;
+  std::vector<std::pair<uint64_t, size_t>> live;
+  std::vector<uint64_t> free_ids;
+};
+
+// Mixed request sizes: mostly single pages, some small multi-page buffers,
+// a few large ones.
+size_t mixed_size(Rng& rng) {
+  const uint64_t pick = rng.below(100);
+
+  if (pick < 60) {
+    return PageSize4KiB;
+  }
+
+  if (pick < 85) {
+    return (2 + rng.below(7)) * PageSize4KiB;
+  }
+
+  if (pick < 95) {
+    return 0x10000 + rng.below(0x30000);
+  }
+
+  if (pick < 99) {
+    return PageSize2MiB / 2 + rng.below(PageSize2MiB / 2);
+  }
+
+  return (4ull << 20) << rng.below(3);
+}
+
+// Single-page churn around a steady live set.
+void gen_pages(std::vector<Op>& ops, const Options& opt, Rng& rng) {
+  AllocGen gen(ops, opt.memory / 2);
+
+  while (ops.size() < opt.ops) {
+    if ((gen.count() == 0) || (rng.below(2) == 0)) {
+      if (gen.alloc(PageSize4KiB)) {
+        continue;
+      }
+    }
+
+    gen.free_random(rng);
+  }
+}
+
+// Mixed sizes freed in random order, the fragmenting case.
+void gen_mixed(std::vector<Op>& ops, const Options& opt, Rng& rng) {
+  AllocGen gen(ops, opt.memory / 2);
+
+  while (ops.size() < opt.ops) {
+    if ((gen.count() == 0) || (rng.below(2) == 0)) {
+      if (gen.alloc(mixed_size(rng))) {
+        continue;
+      }
+    }
+
+    gen.free_random(rng);
+  }
+}
+
+// Mixed sizes in bursts freed in reverse, the best case for coalescing.
+void gen_lifo(std::vector<Op>& ops, const Options& opt, Rng& rng) {
+  AllocGen gen(ops, opt.memory / 2);
+
+  while (ops.size() < opt.ops) {
+    const size_t burst = 1 + rng.below(64);
+
+    for (size_t i = 0; i < burst; ++i) {
+      gen.alloc(mixed_size(rng));
+    }
+
+    while (gen.count() != 0) {
+      gen.free_last();
+    }
+  }
+}
+
+// Maps and unmaps regions in fixed slots, tracking what is mapped.
+class MapGen {
+ public:
+  MapGen(std::vector<Op>& ops, size_t budget) : ops(ops), budget(budget) {
+  }
+
+  bool map(uint64_t virt, uint64_t length, PageSizeType type) {
+    const Op op = {'m', virt, length, type};
+    const size_t charge = mapped_bytes(op);
+
+    if (this->live_bytes + charge > this->budget) {
+      return false;
+    }
+
+    this->ops.push_back(op);
+    this->live.push_back(op);
+    this->live_bytes += charge;
+    return true;
+  }
+
+  // Unmap a random live region and return its address.
+  uint64_t unmap_random(Rng& rng) {
+    const size_t index = rng.below(this->live.size());
+    Op op = this->live[index];
+
+    this->live[index] = this->live.back();
+    this->live.pop_back();
+    this->live_bytes -= mapped_bytes(op);
+
+    op.kind = 'u';
+    this->ops.push_back(op);
+    return op.a;
+  }
+
+  size_t count() const {
+    return this->live.size();
+  }
+
+ private:
+  std::vector<Op>& ops;
+  size_t budget;
+  size_t live_bytes = 0;
+  std::vector<Op> live;
+};
+
+// Regions of 4 to 512 KiB in 4 MiB slots, like process heaps and stacks.
+void gen_map(std::vector<Op>& ops, const Options& opt, Rng& rng) {
+  const size_t budget = opt.memory / 4;
+  const size_t slots = 2 * budget / PageSize2MiB;
+  MapGen gen(ops, budget);
+  std::vector<uint64_t> free_slots;
+
+  for (size_t i = slots; i > 0; --i) {
+    free_slots.push_back(SIM_MAP_BASE + (i - 1) * 2 * PageSize2MiB);
+  }
+
+  // Every mapped page is allocated and cleared, so fewer operations keep
+  // the run time in line with the allocation traces.
+  while (ops.size() < opt.ops / 64) {
+    if (!free_slots.empty() &&
+        ((gen.count() == 0) || (rng.below(2) == 0))) {
+      const uint64_t length = (1 + rng.below(128)) * PageSize4KiB;
+
+      if (gen.map(free_slots.back(), length, PageSmall)) {
+        free_slots.pop_back();
+        continue;
+      }
+    }
+
+    free_slots.push_back(gen.unmap_random(rng));
+  }
+}
+
+// Single pages scattered over the user half: the page-table worst case.
+// Addresses come from a fixed pool so the table count stays bounded.
+void gen_sparse(std::vector<Op>& ops, const Options& opt, Rng& rng) {
+  const size_t budget = opt.memory / 32;
+  const size_t pool = 2 * budget / PageSize4KiB;
+  MapGen gen(ops, budget);
+  std::unordered_set<uint64_t> seen;
+  std::vector<uint64_t> free_pages;
+
+  while (free_pages.size() < pool) {
+    const uint64_t virt = rng.below(SIM_USER_PAGES) * PageSize4KiB;
+
+    if (seen.insert(virt).second) {
+      free_pages.push_back(virt);
+    }
+  }
+
+  while (ops.size() < opt.ops) {
+    if (!free_pages.empty() &&
+        ((gen.count() == 0) || (rng.below(2) == 0))) {
+      const size_t index = rng.below(free_pages.size());
+
+      if (gen.map(free_pages[index], PageSize4KiB, PageSmall)) {
+        free_pages[index] = free_pages.back();
+        free_pages.pop_back();
+        continue;
+      }
+    }
+
+    free_pages.push_back(gen.unmap_random(rng));
+  }
+}
+
+// Runs of 1 to 8 2 MiB pages in 16 MiB slots.
+void gen_huge(std::vector<Op>& ops, const Options& opt, Rng& rng) {
+  const size_t budget = opt.memory / 4;
+  const size_t slots = 2 * budget / PageSize2MiB;
+  MapGen gen(ops, budget);
+  std::vector<uint64_t> free_slots;
+
+  for (size_t i = slots; i > 0; --i) {
+    free_slots.push_back(SIM_HUGE_BASE + (i - 1) * 8 * PageSize2MiB);
+  }
+
+  // Each map or unmap clears or frees up to 16 MiB.
+  while (ops.size() < opt.ops / 256) {
+    if (!free_slots.empty() &&
+        ((gen.count() == 0) || (rng.below(2) == 0))) {
+      const uint64_t length = (1 + rng.below(8)) * PageSize2MiB;
+
+      if (gen.map(free_slots.back(), length, PageMedium)) {
+        free_slots.pop_back();
+        continue;
+      }
+    }
+
+    free_slots.push_back(gen.unmap_random(rng));
+  }
+}
+
+struct Generator {
+  const char* name;
+  void (*generate)(std::vector<Op>&, const Options&, Rng&);
+};
+
+constexpr Generator generators[] = {
+    {"pages", gen_pages}, {"mixed", gen_mixed},   {"lifo", gen_lifo},
+    {"map", gen_map},     {"sparse", gen_sparse}, {"huge", gen_huge},
+};
+
+const char* type_name(PageSizeType type) {
+  switch (type) {
+    case PageMedium:
+      return "2m";
+    case PageLarge:
+      return "1g";
+    default:
+      return "4k";
+  }
+}
+
+bool parse_type(const char* str, PageSizeType& type) {
+  if (strcmp(str, "4k") == 0) {
+    type = PageSmall;
+  } else if (strcmp(str, "2m") == 0) {
+    type = PageMedium;
+  } else if (strcmp(str, "1g") == 0) {
+    type = PageLarge;
+  } else {
+    return false;
+  }
+
+  return true;
+}
+
+bool load_trace(const char* path, std::vector<Op>& ops) {
+  FILE* file = fopen(path, "r");
+
+  if (file == nullptr) {
+    fprintf(stderr, "%s: cannot open\n", path);
+    return false;
+  }
+
+  char line[256];
+  size_t line_no = 0;
+  bool ok = true;
+
+  while (ok && fgets(line, sizeof(line), file) != nullptr) {
+    line_no++;
+
+    if (char* comment = strchr(line, '#')) {
+      *comment = '\0';
+    }
+
+    char kind = 0;
+    char a[32] = {};
+    char b[32] = {};
+    char type[8] = "4k";
+    const int fields = sscanf(line, " %c %31s %31s %7s", &kind, a, b, type);
+
+    if (fields <= 0) {
+      continue;
+    }
+
+    Op op = {kind, strtoull(a, nullptr, 0), strtoull(b, nullptr, 0)};
+
+    switch (kind) {
+      case 'a':
+        ok = fields == 3;
+        break;
+      case 'f':
+        ok = fields == 2;
+        break;
+      case 'm':
+      case 'u':
+        ok = (fields >= 3) && parse_type(type, op.type);
+        break;
+      default:
+        ok = false;
+        break;
+    }
+
+    if (!ok) {
+      fprintf(stderr, "%s:%zu: malformed operation\n", path, line_no);
+      break;
+    }
+
+    ops.push_back(op);
+  }
+
+  fclose(file);
+  return ok;
+}
+
+void dump_trace(const char* name, const std::vector<Op>& ops) {
+  printf("# %s\n", name);
+
+  for (const Op& op : ops) {
+    switch (op.kind) {
+      case 'a':
+        printf("a %lu %lu\n", op.a, op.b);
+        break;
+      case 'f':
+        printf("f %lu\n", op.a);
+        break;
+      default:
+        printf("%c 0x%lx 0x%lx %s\n", op.kind, op.a, op.b,
+               type_name(op.type));
+        break;
+    }
+  }
+}
+
+// Roughly what QEMU's q35 hands Limine: low memory under the EBDA, the
+// kernel and bootloader data in the middle and firmware pages at the top.
+// The odd sizes exercise the greedy block split in initialize().
+struct Memmap {
+  limine_memmap_entry entries[8];
+  limine_memmap_entry* pointers[8];
+  limine_memmap_response response = {};
+
+  explicit Memmap(size_t memory) {
+    const uint64_t mid =
+        align_down(memory / 2, std::to_underlying(PageSize2MiB));
+    const uint64_t top = memory - 0x203000;
+
+    this->entries[0] = {0x0, 0x1000, LIMINE_MEMMAP_RESERVED};
+    this->entries[1] = {0x1000, 0x9e000, LIMINE_MEMMAP_USABLE};
+    this->entries[2] = {0x9f000, 0x61000, LIMINE_MEMMAP_RESERVED};
+    this->entries[3] = {0x100000, mid - 0x900000, LIMINE_MEMMAP_USABLE};
+    this->entries[4] = {mid - 0x800000, 0x400000,
+                        LIMINE_MEMMAP_EXECUTABLE_AND_MODULES};
+    this->entries[5] = {mid - 0x400000, 0x400000,
+                        LIMINE_MEMMAP_BOOTLOADER_RECLAIMABLE};
+    this->entries[6] = {mid, top - mid, LIMINE_MEMMAP_USABLE};
+    this->entries[7] = {top, memory - top, LIMINE_MEMMAP_RESERVED};
+
+    for (size_t i = 0; i < 8; ++i) {
+      this->pointers[i] = &this->entries[i];
+    }
+
+    this->response.entry_count = 8;
+    this->response.entries = this->pointers;
+  }
+};
+
+// Bring up the allocator and the kernel page map over `memory` bytes of
+// simulated RAM.
+void boot_memory(const Options& opt) {
+  static limine_hhdm_response hhdm = {};
+  static limine_paging_mode_response paging_mode = {};
+  static Memmap* memmap = new Memmap(opt.memory);
+
+  // Populated up front so first-touch faults stay out of the timings.
+  void* ram = mmap(nullptr, opt.memory, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+
+  if (ram == MAP_FAILED) {
+    perror("mmap");
+    exit(2);
+  }
+
+  hhdm.offset = reinterpret_cast<uintptr_t>(ram);
+  paging_mode.mode = LIMINE_PAGING_MODE_X86_64_4LVL;
+  boot::hhdm_request.response = &hhdm;
+  boot::paging_mode_request.response = &paging_mode;
+  boot::memmap_request.response = &memmap->response;
+
+  PhysicalMemoryManager::instance().initialize(&memmap->response);
+  kernel_pagemap.initialize();
+}
+
+size_t free_block_bytes(const PhysicalMemoryStats& stats) {
+  size_t total = 0;
+
+  for (int order = MIN_ORDER; order <= MAX_ORDER; ++order) {
+    total += stats.free_blocks[order] * (PageSize4KiB << order);
+  }
+
+  return total;
+}
+
+// Free blocks by order with the unusable free space index: the share of
+// free memory in blocks too small for a request of that order.
+void print_orders(const PhysicalMemoryStats& stats) {
+  printf("  order    block  free blocks  free MiB  unusable\n");
+
+  size_t below = 0;
+
+  for (int order = MIN_ORDER; order <= MAX_ORDER; ++order) {
+    const size_t block = PageSize4KiB << order;
+    const size_t bytes = stats.free_blocks[order] * block;
+    const bool mib = block >= (1u << 20);
+
+    printf("  %5d %5zu %s %12zu %9.2f %8.1f%%\n", order,
+           mib ? block >> 20 : block >> 10, mib ? "MiB" : "KiB",
+           stats.free_blocks[order], bytes / 1048576.0,
+           stats.free_memory ? 100.0 * below / stats.free_memory : 0.0);
+    below += bytes;
+  }
+}
+
+struct Block {
+  uintptr_t addr = 0;
+  size_t size = 0;
+};
+
+// Replay `ops` on a fresh allocator, report and check the outcome.
+void run_trace(const char* name, const std::vector<Op>& ops,
+               const Options& opt) {
+  boot_memory(opt);
+
+  PhysicalMemoryManager& pmm = PhysicalMemoryManager::instance();
+  PageMap pagemap;
+
+  const PhysicalMemoryStats start_stats = pmm.get_stats();
+  const size_t start_free = start_stats.free_memory;
+  const size_t start_invalidations = ::arch::x86_64::cpu::invalidations;
+
+  uint64_t max_id = 0;
+
+  for (const Op& op : ops) {
+    if (op.kind == 'a' || op.kind == 'f') {
+      max_id = std::max(max_id, op.a);
+    }
+  }
+
+  std::vector<Block> blocks(max_id + 1);
+  size_t live = 0;
+  size_t peak = 0;
+  size_t failed = 0;
+
+  const auto start = std::chrono::steady_clock::now();
+
+  for (const Op& op : ops) {
+    switch (op.kind) {
+      case 'a': {
+        Block& block = blocks[op.a];
+        block.addr = pmm.allocate<uintptr_t>(op.b);
+        block.size = block_bytes(op.b);
+        live += block.size;
+        break;
+      }
+      case 'f': {
+        Block& block = blocks[op.a];
+        pmm.deallocate(block.addr);
+        live -= block.size;
+        block = {};
+        break;
+      }
+      case 'm':
+        failed += !pagemap.map(op.a, op.b, FlagRw, op.type);
+        live += mapped_bytes(op);
+        break;
+      case 'u':
+        failed += !pagemap.unmap_dealloc(op.a, op.b, op.type);
+        live -= mapped_bytes(op);
+        break;
+    }
+
+    peak = std::max(peak, live);
+  }
+
+  const double ns = std::chrono::duration<double, std::nano>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+
+  const PhysicalMemoryStats end_stats = pmm.get_stats();
+  const size_t tables = start_free - end_stats.free_memory - live;
+
+  printf("== %s: %zu ops over %zu MiB\n", name, ops.size(),
+         opt.memory >> 20);
+  printf("  replay %10.2f ms %10.1f ns/op %10.0f ops/s\n", ns / 1e6,
+         ns / ops.size(), ops.size() * 1e9 / ns);
+  printf("  live   %10.2f MiB peak, %.2f MiB at end\n", peak / 1048576.0,
+         live / 1048576.0);
+  printf("  tables %10zu (%zu KiB), %zu invalidations\n",
+         tables / PageSize4KiB, tables >> 10,
+         ::arch::x86_64::cpu::invalidations - start_invalidations);
+  print_orders(end_stats);
+
+  BENCH_CHECK(failed == 0);
+  BENCH_CHECK(free_block_bytes(end_stats) == end_stats.free_memory);
+
+  // Live blocks must not overlap each other.
+  std::vector<Block> sorted;
+
+  for (const Block& block : blocks) {
+    if (block.size != 0) {
+      sorted.push_back(block);
+    }
+  }
+
+  std::sort(sorted.begin(), sorted.end(),
+            [](const Block& x, const Block& y) { return x.addr < y.addr; });
+
+  for (size_t i = 1; i < sorted.size(); ++i) {
+    BENCH_CHECK(sorted[i - 1].addr + sorted[i - 1].size <= sorted[i].addr);
+  }
+
+  // Every live mapping must translate, then everything is released.
+  std::map<uint64_t, Op> mappings;
+
+  for (const Op& op : ops) {
+    if (op.kind == 'm') {
+      mappings[op.a] = op;
+    } else if (op.kind == 'u') {
+      mappings.erase(op.a);
+    }
+  }
+
+  for (const auto& [virt, op] : mappings) {
+    BENCH_CHECK(pagemap.translate(virt, op.type).has_value());
+    BENCH_CHECK(pagemap.unmap_dealloc(virt, op.b, op.type));
+  }
+
+  for (const Block& block : sorted) {
+    pmm.deallocate(block.addr);
+  }
+
+  // Page tables are never reclaimed; everything else must come back, and
+  // without them the free lists must coalesce back to the starting state.
+  const PhysicalMemoryStats final_stats = pmm.get_stats();
+  BENCH_CHECK(final_stats.free_memory == start_free - tables);
+
+  if (tables == 0) {
+    BENCH_CHECK(std::equal(std::begin(final_stats.free_blocks),
+                           std::end(final_stats.free_blocks),
+                           std::begin(start_stats.free_blocks)));
+  }
+}
+
+// Each trace runs in its own process so it starts from a freshly booted
+// allocator.
+bool run_isolated(const char* name, const std::vector<Op>& ops,
+                  const Options& opt) {
+  fflush(stdout);
+
+  const pid_t pid = fork();
+
+  if (pid == 0) {
+    run_trace(name, ops, opt);
+    fflush(stdout);
+    _exit(microbench::failures != 0);
+  }
+
+  int status = 0;
+  waitpid(pid, &status, 0);
+
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    printf("  %s: checks FAILED\n", name);
+    return false;
+  }
+
+  return true;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options opt;
+  std::vector<std::string> traces;
+
+  for (int i = 1; i < argc; ++i) {
+    const char* arg = argv[i];
+
+    if (strcmp(arg, "--memory") == 0 && i + 1 < argc) {
+      opt.memory = strtoull(argv[++i], nullptr, 0) << 20;
+    } else if (strcmp(arg, "--ops") == 0 && i + 1 < argc) {
+      opt.ops = strtoull(argv[++i], nullptr, 0);
+    } else if (strcmp(arg, "--seed") == 0 && i + 1 < argc) {
+      opt.seed = strtoull(argv[++i], nullptr, 0);
+    } else if (strcmp(arg, "--dump") == 0) {
+      opt.dump = true;
+    } else {
+      traces.push_back(arg);
+    }
+  }
+
+  if (opt.memory < (64ull << 20)) {
+    fprintf(stderr, "--memory must be at least 64 MiB\n");
+    return 2;
+  }
+
+  if (traces.empty()) {
+    for (const Generator& gen : generators) {
+      traces.push_back(gen.name);
+    }
+  }
+
+  bool ok = true;
+
+  for (const std::string& trace : traces) {
+    std::vector<Op> ops;
+    Rng rng = {opt.seed * 0x9e3779b97f4a7c15ull | 1};
+    const auto* gen = std::find_if(
+        std::begin(generators), std::end(generators),
+        [&](const Generator& g) { return trace == g.name; });
+
+    if (gen != std::end(generators)) {
+      gen->generate(ops, opt, rng);
+    } else if (!load_trace(trace.c_str(), ops)) {
+      return 2;
+    }
+
+    if (opt.dump) {
+      dump_trace(trace.c_str(), ops);
+    } else {
+      ok &= run_isolated(trace.c_str(), ops, opt);
+    }
+  }
+
+  if (opt.dump) {
+    return 0;
+  }
+
+  printf(ok ? "all checks ok\n" : "checks FAILED\n");
+  return ok ? 0 : 1;
+}
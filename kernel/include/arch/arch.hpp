@@ -5,12 +5,26 @@
 #endif  // __x86_64__
 
 namespace arch {
+using ARCH_NAMESPACE_PREFIX::clear_page;
+using ARCH_NAMESPACE_PREFIX::copy_page;
+using ARCH_NAMESPACE_PREFIX::cpu_id;
+using ARCH_NAMESPACE_PREFIX::cycles;
+using ARCH_NAMESPACE_PREFIX::cycles_begin;
+using ARCH_NAMESPACE_PREFIX::cycles_end;
+using ARCH_NAMESPACE_PREFIX::exit_emulator;
 using ARCH_NAMESPACE_PREFIX::halt;
+using ARCH_NAMESPACE_PREFIX::has_ordered_cycles;
+using ARCH_NAMESPACE_PREFIX::idle;
+using ARCH_NAMESPACE_PREFIX::in_kernel_fpu;
 using ARCH_NAMESPACE_PREFIX::initialize;
+using ARCH_NAMESPACE_PREFIX::InputNotify;
 using ARCH_NAMESPACE_PREFIX::int_status;
 using ARCH_NAMESPACE_PREFIX::int_switch;
 using ARCH_NAMESPACE_PREFIX::pause;
+using ARCH_NAMESPACE_PREFIX::read;
+using ARCH_NAMESPACE_PREFIX::set_input_notify;
 using ARCH_NAMESPACE_PREFIX::write;
+using ARCH_NAMESPACE_PREFIX::write_flush;
 }  // namespace arch
 
 #undef ARCH_NAMESPACE_PREFIX
@@ -0,0 +1,13 @@
+#ifdef __x86_64__
+#include "arch/x86_64/sched/context.hpp"
+
+#define ARCH_NAMESPACE_PREFIX x86_64
+#endif
+
+namespace sched::arch {
+using ARCH_NAMESPACE_PREFIX::initialize_stack;
+using ARCH_NAMESPACE_PREFIX::switch_to;
+using ARCH_NAMESPACE_PREFIX::ThreadStart;
+}  // namespace sched::arch
+
+#undef ARCH_NAMESPACE_PREFIX
@@ -0,0 +1,13 @@
+#ifdef __x86_64__
+#include "arch/x86_64/memory/page_ops.hpp"
+
+#define ARCH_NAMESPACE_PREFIX x86_64
+#endif
+
+namespace memory::arch {
+using ARCH_NAMESPACE_PREFIX::flush_cache_range;
+using ARCH_NAMESPACE_PREFIX::stream_clear_pages;
+using ARCH_NAMESPACE_PREFIX::stream_copy_pages;
+}  // namespace memory::arch
+
+#undef ARCH_NAMESPACE_PREFIX
@@ -0,0 +1,17 @@
+#ifdef __x86_64__
+#include "arch/x86_64/timer/tsc.hpp"
+
+#define ARCH_NAMESPACE_PREFIX x86_64
+#endif
+
+namespace timer::arch {
+using ARCH_NAMESPACE_PREFIX::clear_deadline;
+using ARCH_NAMESPACE_PREFIX::counter_frequency;
+using ARCH_NAMESPACE_PREFIX::enable_events;
+using ARCH_NAMESPACE_PREFIX::EventHandler;
+using ARCH_NAMESPACE_PREFIX::initialize;
+using ARCH_NAMESPACE_PREFIX::read_counter;
+using ARCH_NAMESPACE_PREFIX::set_deadline;
+}  // namespace timer::arch
+
+#undef ARCH_NAMESPACE_PREFIX
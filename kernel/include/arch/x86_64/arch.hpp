@@ -1,18 +1,81 @@
 #ifndef ARCH_HPP
 #define ARCH_HPP 1
 
+#include "arch/x86_64/cpu/percpu.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+
 namespace arch::x86_64 {
 [[noreturn]] void halt(bool interrupts = true);
+// Leave QEMU through its isa-debug-exit device with status (code << 1) | 1.
+// Without the device, or on hardware, this just halts.
+[[noreturn]] void exit_emulator(uint8_t code);
 inline void pause() {
   asm volatile("pause");
 }
 
+// Enable interrupts and halt until the next one arrives. `sti` delays
+// interrupt recognition by one instruction, so no wakeup can be lost between
+// the two.
+inline void idle() {
+  asm volatile("sti\n\thlt" ::: "memory");
+}
+
+inline uint32_t cpu_id() {
+  return cpu::cpu_id();
+}
+
+// Free-running cycle counter, for measuring short intervals.
+inline uint64_t cycles() {
+  return __builtin_ia32_rdtsc();
+}
+
+// Cycle counter reads that bracket a timed region. The start read is fenced
+// on both sides so nothing before or after overlaps it. The end read uses
+// RDTSCP, which waits for the timed instructions to finish, then fences off
+// the ones that follow. Check has_ordered_cycles() before use.
+inline uint64_t cycles_begin() {
+  uint32_t lo = 0;
+  uint32_t hi = 0;
+  asm volatile("lfence\n\trdtsc\n\tlfence" : "=a"(lo), "=d"(hi)::"memory");
+  return (static_cast<uint64_t>(hi) << 32) | lo;
+}
+
+inline uint64_t cycles_end() {
+  uint32_t lo = 0;
+  uint32_t hi = 0;
+  uint32_t aux = 0;
+  asm volatile("rdtscp\n\tlfence" : "=a"(lo), "=d"(hi), "=c"(aux)::"memory");
+  return (static_cast<uint64_t>(hi) << 32) | lo;
+}
+
+bool has_ordered_cycles();
+
 bool int_status();
 void int_switch(bool on);
 
 void initialize();
+
+// True while this CPU is inside a kernel_fpu_begin() section, which must not
+// be left by blocking.
+bool in_kernel_fpu();
+
+// Copy or clear one page-aligned 4 KiB page, using vector registers when the
+// CPU has them.
+void copy_page(void* dest, const void* src);
+void clear_page(void* dest);
+
 void write(char ch);
 void write(const char* ch);
+// Push console output still queued in the driver out to the wire.
+void write_flush();
+
+// Console input. `notify` runs in interrupt context when bytes arrive; read()
+// has a single consumer.
+using InputNotify = void (*)(void* cookie);
+size_t read(char* out, size_t length);
+void set_input_notify(InputNotify notify, void* cookie);
 }  // namespace arch::x86_64
 
 #endif  // ARCH_HPP
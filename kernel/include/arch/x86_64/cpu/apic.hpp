@@ -0,0 +1,23 @@
+#ifndef ARCH_CPU_APIC_HPP
+#define ARCH_CPU_APIC_HPP 1
+
+#include <stdint.h>
+
+namespace arch::x86_64::cpu {
+// Local APIC driven through the x2APIC MSR interface. Only the pieces needed
+// for per-CPU timer events and EOI are provided.
+class Apic {
+ public:
+  static bool initialize();
+  static bool is_enabled();
+
+  static void eoi();
+  static uint32_t id();
+
+  // Route the LVT timer to `vector` in TSC-deadline mode.
+  static void enable_tsc_deadline(uint8_t vector);
+  static void mask_timer();
+};
+}  // namespace arch::x86_64::cpu
+
+#endif  // ARCH_CPU_APIC_HPP
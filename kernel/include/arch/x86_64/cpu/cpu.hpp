@@ -72,6 +72,7 @@
 #define FEATURE_AVX512VPDQ CPUID_BIT(0x7, 2, 14)
 #define FEATURE_AVX512QVNNIW CPUID_BIT(0x7, 3, 2)
 #define FEATURE_AVX512QFMA CPUID_BIT(0x7, 3, 3)
+#define FEATURE_FSRM CPUID_BIT(0x7, 3, 4)
 #define FEATURE_MD_CLEAR CPUID_BIT(0x7, 3, 10)
 #define FEATURE_IBRS_IBPB CPUID_BIT(0x7, 3, 26)
 #define FEATURE_STIBP CPUID_BIT(0x7, 3, 27)
@@ -177,6 +178,37 @@ inline void write_cr3(uintptr_t addr) {
   asm volatile("mov %0, %%cr3" ::"r"(addr) : "memory");
 }
 
+inline uint64_t read_cr0() {
+  uint64_t val = 0;
+  asm volatile("mov %0, cr0" : "=r"(val));
+  return val;
+}
+
+inline void write_cr0(uint64_t val) {
+  asm volatile("mov cr0, %0" ::"r"(val) : "memory");
+}
+
+inline uint64_t read_cr4() {
+  uint64_t val = 0;
+  asm volatile("mov %0, cr4" : "=r"(val));
+  return val;
+}
+
+inline void write_cr4(uint64_t val) {
+  asm volatile("mov cr4, %0" ::"r"(val) : "memory");
+}
+
+inline uint64_t read_xcr(uint32_t xcr_id) {
+  uint32_t val_lo = 0;
+  uint32_t val_hi = 0;
+  asm volatile("xgetbv" : "=a"(val_lo), "=d"(val_hi) : "c"(xcr_id));
+  return (static_cast<uint64_t>(val_hi) << 32) | val_lo;
+}
+
+inline void write_xcr(uint32_t xcr_id, uint64_t val) {
+  asm volatile("xsetbv" ::"c"(xcr_id), "a"(val & 0xffffffff), "d"(val >> 32));
+}
+
 inline uint64_t read_msr(uint32_t msr_id) {
   uint32_t val_lo = 0;
   uint32_t val_hi = 0;
@@ -194,8 +226,16 @@ inline void write_msr(uint32_t msr_id, uint64_t val) {
   asm volatile("wrmsr" ::"c"(msr_id), "a"(val & 0xffffffff), "d"(val >> 32));
 }
 
+inline uint64_t read_tsc() {
+  uint32_t val_lo = 0;
+  uint32_t val_hi = 0;
+  asm volatile("rdtsc" : "=a"(val_lo), "=d"(val_hi));
+  return (static_cast<uint64_t>(val_hi) << 32) | val_lo;
+}
+
 void enable_pat();
 bool test_feature(CpuidBit bit);
+const CpuidLeaf* get_leaf(CpuidLeafNum leaf);
 ModelInfo get_model_info();
 void initialize();
 }  // namespace arch::x86_64::cpu
@@ -78,6 +78,15 @@ struct NmiFrame {
 
 using HandlerFunc = void (*)(IFrame*, void*);
 
+// Handler for the fast dispatch path. The stub only saves caller-saved
+// registers, so there is no IFrame; the EOI is sent by the stub afterwards.
+using FastHandlerFunc = void (*)(uint8_t vector);
+
+struct InterruptStats {
+  uint64_t count;
+  uint64_t cycles;
+};
+
 struct InterruptHandler {
  public:
   constexpr InterruptHandler() = default;
@@ -116,11 +125,21 @@ struct InterruptHandler {
     return this->vector != 0;
   }
 
+  constexpr uint8_t get_vector() const {
+    return this->vector;
+  }
+
   constexpr void reset() {
     this->handler = nullptr;
     this->cookie = nullptr;
   }
 
+  // Give the vector back to allocate_handler().
+  constexpr void release() {
+    this->reset();
+    this->vector = 0;
+  }
+
   bool operator()(IFrame* frame) {
     if (!this->is_reserved()) {
       return false;
@@ -138,6 +157,15 @@ struct InterruptHandler {
 
 InterruptHandler& allocate_handler(int hint = platformInterruptBase);
 InterruptHandler& get_handler(int vector);
+
+// Route a reserved vector through its dedicated fast stub.
+bool install_fast_handler(InterruptHandler& handler, FastHandlerFunc func);
+
+#if NOISE_DEBUG
+// Entry-to-exit cycles per vector, including register save/restore.
+const InterruptStats& get_interrupt_stats(uint8_t vector);
+void print_interrupt_stats();
+#endif
 }  // namespace arch::x86_64::cpu
 
 #endif  // ARCH_CPU_EXCEPTIONS_HPP
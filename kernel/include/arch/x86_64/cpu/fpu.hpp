@@ -0,0 +1,38 @@
+#ifndef ARCH_CPU_FPU_HPP
+#define ARCH_CPU_FPU_HPP 1
+
+#include <stdint.h>
+
+// XSAVE area per CPU for the section a nested one interrupted. Large enough
+// for x87, SSE, AVX and AVX-512 state in the standard format.
+#define FPU_SAVE_AREA 4096
+// A thread plus one interrupt on top of it. Deeper callers fall back to
+// their scalar path.
+#define FPU_MAX_DEPTH 2
+
+namespace arch::x86_64::cpu {
+// The kernel is built without SSE, so vector registers are free for
+// explicitly bracketed sections:
+//
+//   if (kernel_fpu_begin()) {
+//     ... vector code ...
+//     kernel_fpu_end();
+//   }
+//
+// The outermost section owns the registers without saving anything, since
+// no other kernel code touches them. A section that interrupts another one
+// saves the live state first and restores it in kernel_fpu_end(). Sections
+// must not block or yield. kernel_fpu_begin() returns false before
+// initialize_fpu() has run and when nested too deeply.
+bool kernel_fpu_begin();
+void kernel_fpu_end();
+bool in_kernel_fpu();
+
+// State components enabled in XCR0, usable inside a section.
+uint64_t fpu_features();
+
+// Enable SSE/AVX state on the calling CPU. Needs the per-CPU block.
+void initialize_fpu();
+}  // namespace arch::x86_64::cpu
+
+#endif  // ARCH_CPU_FPU_HPP
@@ -65,6 +65,8 @@ struct IdtTable {
   void initialize();
   void print() const;
 
+  void set_entry(uint8_t vector, uintptr_t base);
+
  private:
   IdtSegment entries[MAX_IDT_ENTRIES];
 };
@@ -93,6 +95,9 @@ class Idt {
 
 // Helper to signal End-Of-Interrupt to the PIC/APIC.
 void send_eoi(uint8_t vector);
+
+// Point `vector` of the loaded IDT at a different stub.
+void set_interrupt_gate(uint8_t vector, uintptr_t base);
 }  // namespace arch::x86_64::cpu
 
 #endif  // ARCH_CPU_IDT_HPP
@@ -0,0 +1,38 @@
+#ifndef ARCH_CPU_PERCPU_HPP
+#define ARCH_CPU_PERCPU_HPP 1
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Upper bound for statically sized per-CPU tables.
+#define MAX_CPUS 32
+
+namespace arch::x86_64::cpu {
+// Per-CPU control block. While running in the kernel, the GS base of every
+// CPU points at its own block, so the fields below are one `gs:` load away.
+struct PerCpu {
+  PerCpu* self;
+  uint32_t cpu_id;
+  uint32_t apic_id;
+};
+
+void initialize_percpu(uint32_t cpu_id);
+
+inline PerCpu* current_cpu() {
+  PerCpu* self = nullptr;
+  asm volatile("mov %0, qword ptr gs:[%c1]"
+               : "=r"(self)
+               : "i"(offsetof(PerCpu, self)));
+  return self;
+}
+
+inline uint32_t cpu_id() {
+  uint32_t id = 0;
+  asm volatile("mov %0, dword ptr gs:[%c1]"
+               : "=r"(id)
+               : "i"(offsetof(PerCpu, cpu_id)));
+  return id;
+}
+}  // namespace arch::x86_64::cpu
+
+#endif  // ARCH_CPU_PERCPU_HPP
@@ -0,0 +1,45 @@
+#ifndef ARCH_CPU_THREADED_IRQ_HPP
+#define ARCH_CPU_THREADED_IRQ_HPP 1
+
+#include "arch/x86_64/cpu/exceptions.hpp"
+#include "sched/thread.hpp"
+
+#include <stdint.h>
+
+#include <atomic>
+
+#define MAX_THREADED_IRQS 16
+
+namespace arch::x86_64::cpu {
+enum class IrqReturn : uint8_t {
+  None,        // Not ours
+  Handled,     // Fully handled in hard-IRQ context
+  WakeThread,  // Run the threaded handler
+};
+
+using PrimaryHandler = IrqReturn (*)(IFrame* frame, void* cookie);
+using ThreadedHandler = void (*)(void* cookie);
+
+// Interrupt whose handling is split between a short primary handler in
+// hard-IRQ context and a dedicated kernel thread.
+struct ThreadedIrq {
+  PrimaryHandler primary;
+  ThreadedHandler handler;
+  void* cookie;
+
+  sched::Thread* thread;
+  std::atomic<bool> pending;
+
+  uint64_t count;
+  uint8_t vector;
+};
+
+// Reserve a vector (searching from `hint`) for a threaded handler. A null
+// `primary` always wakes the thread. Legacy PIC lines stay masked from the
+// primary handler until the thread is done with them.
+ThreadedIrq* request_threaded_irq(int hint, PrimaryHandler primary,
+                                  ThreadedHandler handler, void* cookie,
+                                  const char* name);
+}  // namespace arch::x86_64::cpu
+
+#endif  // ARCH_CPU_THREADED_IRQ_HPP
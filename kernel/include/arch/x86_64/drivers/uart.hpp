@@ -2,9 +2,25 @@
 #define ARCH_DRIVERS_UART_HPP 1
 
 #include "drivers/manager.hpp"
+#include "ring.hpp"
+#include "spinlock.hpp"
 
+#include <stddef.h>
 #include <stdint.h>
 
+// Input clock of the divisor latch; divisor 1 runs the line at this rate.
+#define UART_CLOCK_HZ 115200
+#ifndef UART_DEFAULT_BAUD
+#define UART_DEFAULT_BAUD 115200
+#endif
+
+// Transmit queue in bytes, power of two.
+#define UART_TX_BUFFER 4096
+// Bytes the 16550 transmit FIFO takes per THRE.
+#define UART_FIFO_SIZE 16
+// Receive queue in bytes, power of two. Input beyond it is dropped.
+#define UART_RX_BUFFER 256
+
 namespace drivers {
 
 constexpr uint16_t PORT_A = 0x3f8;
@@ -14,18 +30,58 @@ constexpr uint16_t PORT_D = 0x2e8;
 
 class UartDriver final : public IDriver {
  public:
-  UartDriver() : IDriver(), m_port(PORT_A) {
+  // Runs in interrupt context after received bytes were queued.
+  using RxNotify = void (*)(void* cookie);
+
+  UartDriver() : UartDriver(PORT_A) {
   }
 
-  explicit UartDriver(const uint16_t port) : IDriver(), m_port(port) {
+  explicit UartDriver(const uint16_t port)
+      : IDriver(),
+        m_port(port),
+        m_divisor(UART_CLOCK_HZ / UART_DEFAULT_BAUD),
+        m_tx_lock("uart") {
   }
 
   // Initialize UART (baud, line control, FIFOs, modem ctrl).
   bool initialize() override;
   void shutdown() override;
 
-  // Transmit a single byte (blocking until TX empty).
-  void putchar(uint8_t ch) const;
+  // Queue a byte for transmission. Until enable_interrupts() the queue goes
+  // out in FIFO-sized bursts, and in full at the end of every line.
+  void putchar(uint8_t ch);
+
+  // Queue `length` bytes; same rules as putchar().
+  void transmit(const char* data, size_t length);
+
+  // Send everything queued by polling the line. For panics and any path
+  // that cannot wait for the interrupt.
+  void flush();
+
+  // Pop up to `length` received bytes. Single consumer.
+  size_t receive(char* out, size_t length);
+
+  void set_rx_notify(RxNotify notify, void* cookie) noexcept {
+    this->m_rx_cookie = cookie;
+    this->m_rx_notify = notify;
+  }
+
+  // Move transmission onto the THRE interrupt and start taking input. Needs
+  // the IDT and the PIC.
+  bool enable_interrupts();
+
+  // COM interrupt entry.
+  void handle_interrupt();
+
+  // Baud rate programmed by initialize(). Must divide UART_CLOCK_HZ.
+  bool set_baud(uint32_t baud) noexcept {
+    if ((baud == 0) || ((UART_CLOCK_HZ % baud) != 0)) {
+      return false;
+    }
+
+    this->m_divisor = UART_CLOCK_HZ / baud;
+    return true;
+  }
 
   // Change I/O port at runtime.
   void set_port(const uint16_t port) noexcept {
@@ -36,7 +92,35 @@ class UartDriver final : public IDriver {
   void write(uint16_t reg, uint8_t val) const;
   uint8_t read(uint16_t reg) const;
 
+  // Helpers below run with the transmit lock held.
+  void enqueue(uint8_t ch);
+  void kick(bool end_of_line);
+  size_t fill_fifo();
+  void drain();
+  void set_ier(uint8_t bits, bool on);
+  void receive_pending();
+
+  size_t queued() const {
+    return this->m_tx_head - this->m_tx_tail;
+  }
+
   uint16_t m_port;
+  uint16_t m_divisor;
+
+  bool m_irq_mode = false;
+  uint8_t m_ier = 0;
+  // THRE interrupt enabled, the handler owns the queue.
+  bool m_tx_active = false;
+
+  libs::IrqLock m_tx_lock;
+  size_t m_tx_head = 0;
+  size_t m_tx_tail = 0;
+  uint8_t m_tx_buffer[UART_TX_BUFFER];
+
+  // Filled by the interrupt handler only.
+  libs::SpscRing<uint8_t, UART_RX_BUFFER> m_rx_ring;
+  RxNotify m_rx_notify = nullptr;
+  void* m_rx_cookie = nullptr;
 };
 }  // namespace drivers
 
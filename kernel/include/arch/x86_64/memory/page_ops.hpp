@@ -0,0 +1,83 @@
+#ifndef ARCH_MEMORY_PAGE_OPS_HPP
+#define ARCH_MEMORY_PAGE_OPS_HPP 1
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CACHE_LINE_SIZE 64
+#define STREAM_PAGE_SIZE 4096
+
+namespace memory::arch::x86_64 {
+// Whole-page clear and copy with non-temporal stores. movnti writes through
+// the write-combining buffers without allocating cache lines, so zeroing or
+// cloning pages nobody reads soon does not evict the working set. Only
+// general-purpose registers are used: no FPU section is needed and these
+// are safe in any context. The header has no kernel dependencies so host
+// benchmarks can include it.
+
+inline void stream_store(uint64_t* dest, uint64_t value) {
+  asm volatile("movnti %0, %1" : "=m"(*dest) : "r"(value));
+}
+
+// Streaming stores are weakly ordered; fence before publishing the pages.
+inline void stream_fence() {
+  asm volatile("sfence" ::: "memory");
+}
+
+// Zero `count` pages at page-aligned `dest`.
+inline void stream_clear_pages(void* dest, size_t count) {
+  auto* out = static_cast<uint64_t*>(dest);
+  const size_t words = count * (STREAM_PAGE_SIZE / sizeof(uint64_t));
+
+  for (size_t i = 0; i < words; i += 8) {
+    stream_store(out + i, 0);
+    stream_store(out + i + 1, 0);
+    stream_store(out + i + 2, 0);
+    stream_store(out + i + 3, 0);
+    stream_store(out + i + 4, 0);
+    stream_store(out + i + 5, 0);
+    stream_store(out + i + 6, 0);
+    stream_store(out + i + 7, 0);
+  }
+
+  stream_fence();
+}
+
+// Copy `count` pages between page-aligned buffers. Only the destination
+// bypasses the cache; a prefetchnta on the source halved throughput on large
+// copies for little gain.
+inline void stream_copy_pages(void* dest, const void* src, size_t count) {
+  auto* out = static_cast<uint64_t*>(dest);
+  const auto* in = static_cast<const uint64_t*>(src);
+  const size_t words = count * (STREAM_PAGE_SIZE / sizeof(uint64_t));
+
+  for (size_t i = 0; i < words; i += 8) {
+    const uint64_t a = in[i];
+    const uint64_t b = in[i + 1];
+    const uint64_t c = in[i + 2];
+    const uint64_t d = in[i + 3];
+    const uint64_t e = in[i + 4];
+    const uint64_t f = in[i + 5];
+    const uint64_t g = in[i + 6];
+    const uint64_t h = in[i + 7];
+
+    stream_store(out + i, a);
+    stream_store(out + i + 1, b);
+    stream_store(out + i + 2, c);
+    stream_store(out + i + 3, d);
+    stream_store(out + i + 4, e);
+    stream_store(out + i + 5, f);
+    stream_store(out + i + 6, g);
+    stream_store(out + i + 7, h);
+  }
+
+  stream_fence();
+}
+
+// Write back the cache lines covering [addr, addr + length). With `evict`
+// they are dropped as well; otherwise CLWB keeps them cached where the CPU
+// supports it. Falls back to CLFLUSHOPT, then CLFLUSH.
+void flush_cache_range(const void* addr, size_t length, bool evict);
+}  // namespace memory::arch::x86_64
+
+#endif  // ARCH_MEMORY_PAGE_OPS_HPP
@@ -4,21 +4,28 @@
 #define INTERRUPT_STACK_SIZE (4096)
 #define PERCPU_INTERRUPT_STACKS_NMI_OFFSET 0x20e0
 
-#define IFRAME_OFFSET_RDI (0 * 8)
-#define IFRAME_OFFSET_RSI (1 * 8)
-#define IFRAME_OFFSET_RBP (2 * 8)
-#define IFRAME_OFFSET_RBX (3 * 8)
-#define IFRAME_OFFSET_RDX (4 * 8)
-#define IFRAME_OFFSET_RCX (5 * 8)
-#define IFRAME_OFFSET_RAX (6 * 8)
-#define IFRAME_OFFSET_VECTOR (7 * 8)
-#define IFRAME_OFFSET_ERR_CODE (8 * 8)
-#define IFRAME_OFFSET_RIP (9 * 8)
-#define IFRAME_OFFSET_CS (10 * 8)
-#define IFRAME_OFFSET_RFLAGS (11 * 8)
-#define IFRAME_OFFSET_RSP (12 * 8)
-#define IFRAME_OFFSET_USER_SS (13 * 8)
-#define IFRAME_SIZE (14 * 8)
+// Layout of `IFrame` as built by interrupt_common_stub (r15 on top).
+#define IFRAME_OFFSET_RBP (8 * 8)
+#define IFRAME_OFFSET_RDI (9 * 8)
+#define IFRAME_OFFSET_RSI (10 * 8)
+#define IFRAME_OFFSET_RDX (11 * 8)
+#define IFRAME_OFFSET_RCX (12 * 8)
+#define IFRAME_OFFSET_RBX (13 * 8)
+#define IFRAME_OFFSET_RAX (14 * 8)
+#define IFRAME_OFFSET_VECTOR (15 * 8)
+#define IFRAME_OFFSET_ERR_CODE (16 * 8)
+#define IFRAME_OFFSET_RIP (17 * 8)
+#define IFRAME_OFFSET_CS (18 * 8)
+#define IFRAME_OFFSET_RFLAGS (19 * 8)
+#define IFRAME_OFFSET_RSP (20 * 8)
+#define IFRAME_OFFSET_USER_SS (21 * 8)
+#define IFRAME_SIZE (22 * 8)
+
+// Fast interrupt stubs only save the nine caller-saved registers
+// (rax, rcx, rdx, rsi, rdi, r8-r11) on top of the hardware frame.
+#define FAST_IFRAME_OFFSET_RIP (9 * 8)
+#define FAST_IFRAME_OFFSET_CS (10 * 8)
+#define FAST_IFRAME_SIZE (14 * 8)
 
 #define CR0_PE 0x00000001
 #define CR0_MP 0x00000002
@@ -58,6 +65,14 @@
 #define EFER_LMA 0x00000400
 #define EFER_NXE 0x00000800
 
+#define XCR0_X87 0x00000001
+#define XCR0_SSE 0x00000002
+#define XCR0_AVX 0x00000004
+#define XCR0_OPMASK 0x00000020
+#define XCR0_ZMM_HI256 0x00000040
+#define XCR0_HI16_ZMM 0x00000080
+#define XCR0_AVX512 (XCR0_OPMASK | XCR0_ZMM_HI256 | XCR0_HI16_ZMM)
+
 #define MSR_PLATFORM_ID 0x00000017
 #define MSR_APIC_BASE 0x0000001b
 #define MSR_TSC_ADJUST 0x0000003b
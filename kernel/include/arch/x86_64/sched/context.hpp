@@ -0,0 +1,21 @@
+#ifndef ARCH_SCHED_CONTEXT_HPP
+#define ARCH_SCHED_CONTEXT_HPP 1
+
+#include <stdint.h>
+
+extern "C" void context_switch(uintptr_t* old_sp, uintptr_t new_sp);
+
+namespace sched::arch::x86_64 {
+using ThreadStart = void (*)(void* arg);
+
+// Build the initial frame of a thread so that the first switch to the
+// returned stack pointer calls `start(arg)`.
+uintptr_t initialize_stack(uintptr_t stack_top, ThreadStart start, void* arg);
+
+// Save the current callee-saved state to `*old_sp` and resume `new_sp`.
+inline void switch_to(uintptr_t* old_sp, uintptr_t new_sp) {
+  context_switch(old_sp, new_sp);
+}
+}  // namespace sched::arch::x86_64
+
+#endif  // ARCH_SCHED_CONTEXT_HPP
@@ -0,0 +1,34 @@
+#ifndef ARCH_SIMD_HPP
+#define ARCH_SIMD_HPP 1
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Below this many bytes compare() and checksum() stay scalar; entering an
+// FPU section costs more than the vector loop saves.
+#define SIMD_MIN_LENGTH 256
+
+namespace arch::x86_64::simd {
+// Vector versions of a few hot memory loops. initialize() picks the widest
+// implementation the CPU and XCR0 allow; every call falls back to scalar
+// code when no FPU section can be entered.
+
+// Copy or clear one 4 KiB page. Both pointers must be page aligned.
+void copy_page(void* dest, const void* src);
+void clear_page(void* dest);
+
+// Same result as memcmp().
+int compare(const void* a, const void* b, size_t length);
+
+// RFC 1071 ones' complement sum, folded but not inverted. An odd trailing
+// byte is padded with zero. The result is in memory byte order, so it can be
+// stored into a header as is.
+uint16_t checksum(const void* data, size_t length);
+
+// Name of the selected implementation, for diagnostics.
+const char* implementation();
+
+void initialize();
+}  // namespace arch::x86_64::simd
+
+#endif  // ARCH_SIMD_HPP
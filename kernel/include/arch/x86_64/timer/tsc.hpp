@@ -0,0 +1,27 @@
+#ifndef ARCH_TIMER_TSC_HPP
+#define ARCH_TIMER_TSC_HPP 1
+
+#include "arch/x86_64/cpu/cpu.hpp"
+
+#include <stdint.h>
+
+namespace timer::arch::x86_64 {
+using EventHandler = void (*)();
+
+// Calibrate the TSC and return its frequency in Hz (0 on failure).
+uint64_t initialize();
+// Route TSC-deadline expiries of the calling CPU to `handler`.
+bool enable_events(EventHandler handler);
+
+inline uint64_t read_counter() {
+  return ::arch::x86_64::cpu::read_tsc();
+}
+
+uint64_t counter_frequency();
+
+// Program the one-shot deadline of the calling CPU in raw TSC ticks.
+void set_deadline(uint64_t counter);
+void clear_deadline();
+}  // namespace timer::arch::x86_64
+
+#endif  // ARCH_TIMER_TSC_HPP
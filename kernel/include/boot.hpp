@@ -16,6 +16,12 @@ inline const uintptr_t get_hhdm_offset() {
 }
 
 const char* type_name(size_t memmap_type);
+
+// Look up `name` among the space-separated words of the kernel command line.
+// Returns nullptr if it is absent, otherwise the text after `name=` (empty
+// for a bare `name`) with its length, which stops at the next space, in
+// `length`.
+const char* cmdline_option(const char* name, size_t* length = nullptr);
 }  // namespace boot
 
 #endif  // BOOT_HPP
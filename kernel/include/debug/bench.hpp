@@ -0,0 +1,80 @@
+#ifndef DEBUG_BENCH_HPP
+#define DEBUG_BENCH_HPP 1
+
+#include "arch/arch.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Target length of one timed batch, and batches per benchmark. The reported
+// figures are the fastest and the median batch.
+#define BENCH_BATCH_NS 10000000ull
+#define BENCH_REPEATS 7
+
+#define BENCH_CONCAT_(a, b) a##b
+#define BENCH_CONCAT(a, b) BENCH_CONCAT_(a, b)
+
+// Register `func`, a void(debug::BenchState&), under `name`. The entries are
+// collected in the .bench section, so registration needs no constructor.
+#define BENCHMARK(name, func)                                         \
+  [[gnu::used, gnu::section(".bench")]]                               \
+  static const ::debug::Benchmark BENCH_CONCAT(bench_, __COUNTER__) = \
+      {name, func}
+
+namespace debug {
+// Handed to a benchmark body, which runs its operation `iterations()` times
+// between the timestamps taken around the call. Setup that must not be
+// counted goes between pause() and resume().
+class BenchState {
+ public:
+  explicit BenchState(size_t iterations) : count(iterations) {
+  }
+
+  size_t iterations() const {
+    return this->count;
+  }
+
+  void pause() {
+    this->paused_at = arch::cycles_begin();
+  }
+
+  void resume() {
+    this->excluded += arch::cycles_end() - this->paused_at;
+  }
+
+  uint64_t excluded_cycles() const {
+    return this->excluded;
+  }
+
+  // Bytes handled per iteration, reported as throughput.
+  void set_bytes(size_t bytes) {
+    this->bytes = bytes;
+  }
+
+  size_t get_bytes() const {
+    return this->bytes;
+  }
+
+ private:
+  size_t count;
+  uint64_t paused_at = 0;
+  uint64_t excluded = 0;
+  size_t bytes = 0;
+};
+
+struct Benchmark {
+  const char* name;
+  void (*func)(BenchState& state);
+};
+
+// Run the benchmarks whose name starts with the first `prefix_length` bytes
+// of `prefix`, printing one `bench:` line each. Returns how many ran.
+size_t run_benchmarks(const char* prefix, size_t prefix_length);
+
+// Boot hook. `bench` or `bench=<prefix>` on the kernel command line runs the
+// matching benchmarks; `bench_exit` then leaves QEMU through its
+// isa-debug-exit device, with exit status 1 if any ran and 3 otherwise.
+void run_boot_benchmarks();
+}  // namespace debug
+
+#endif  // DEBUG_BENCH_HPP
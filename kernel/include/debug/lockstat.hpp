@@ -0,0 +1,13 @@
+#ifndef DEBUG_LOCKSTAT_HPP
+#define DEBUG_LOCKSTAT_HPP 1
+
+#include <stddef.h>
+
+namespace debug {
+#if NOISE_DEBUG
+// Log the `top` lock classes with the most total wait time.
+void print_lock_stats(size_t top = 10);
+#endif
+}  // namespace debug
+
+#endif  // DEBUG_LOCKSTAT_HPP
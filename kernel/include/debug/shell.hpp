@@ -0,0 +1,13 @@
+#ifndef DEBUG_SHELL_HPP
+#define DEBUG_SHELL_HPP 1
+
+// Longest command line accepted; extra input is ignored.
+#define SHELL_LINE_MAX 80
+
+namespace debug {
+// Start the console shell thread. Needs the scheduler and console input
+// interrupts; type `help` on the serial line for the commands.
+void initialize_shell();
+}  // namespace debug
+
+#endif  // DEBUG_SHELL_HPP
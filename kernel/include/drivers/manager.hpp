@@ -28,6 +28,10 @@ class IDriver {
 size_t install(IDriver* driver);
 void uninstall(IDriver* driver);
 
+// Lock-free lookup. Call inside rcu::read_lock(); the driver stays valid
+// until rcu::read_unlock().
+IDriver* find(size_t driver_id);
+
 void initialize();
 }  // namespace drivers
 
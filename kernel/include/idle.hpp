@@ -0,0 +1,9 @@
+#ifndef KERNEL_IDLE_HPP
+#define KERNEL_IDLE_HPP 1
+
+namespace idle {
+// Halt the calling CPU until there is work, forever.
+[[noreturn]] void run();
+}  // namespace idle
+
+#endif  // KERNEL_IDLE_HPP
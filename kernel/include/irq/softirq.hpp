@@ -0,0 +1,46 @@
+#ifndef IRQ_SOFTIRQ_HPP
+#define IRQ_SOFTIRQ_HPP 1
+
+#include <stdint.h>
+
+// Rounds of softirq processing allowed on one interrupt exit before the rest
+// is handed to ksoftirqd.
+#define SOFTIRQ_MAX_RESTART 10
+// Time budget for softirq processing on one interrupt exit.
+#define SOFTIRQ_MAX_NS 2000000ull
+
+namespace irq {
+// Lower numbers run first.
+enum SoftirqVector : uint8_t {
+  softirqTimer = 0,    // Timer wheel expiry
+  softirqTasklet = 1,  // Tasklets
+  softirqRcu = 2,      // RCU callbacks
+  softirqMax,
+};
+
+using SoftirqHandler = void (*)();
+
+struct SoftirqStats {
+  uint64_t count;
+  uint64_t total_ns;
+  uint64_t max_ns;
+};
+
+void register_softirq(SoftirqVector vector, SoftirqHandler handler);
+
+// Mark `vector` pending on the calling CPU. Safe from any context.
+void raise_softirq(SoftirqVector vector);
+
+// Interrupt exit hook: runs pending softirqs with interrupts enabled unless
+// the CPU is already processing them.
+void exit();
+
+bool in_softirq();
+
+SoftirqStats get_softirq_stats(uint32_t cpu, SoftirqVector vector);
+
+// Start ksoftirqd on the calling CPU. Needs the scheduler.
+void initialize();
+}  // namespace irq
+
+#endif  // IRQ_SOFTIRQ_HPP
@@ -0,0 +1,50 @@
+#ifndef IRQ_TASKLET_HPP
+#define IRQ_TASKLET_HPP 1
+
+#include <atomic>
+
+namespace irq {
+class Tasklet;
+
+using TaskletFunc = void (*)(void* cookie);
+
+// Deferred function run from the tasklet softirq on the CPU that scheduled
+// it. Scheduling an already pending tasklet is a no-op, so a burst of
+// interrupts collapses into one run.
+class Tasklet {
+ public:
+  constexpr Tasklet() = default;
+
+  Tasklet(const Tasklet&) = delete;
+  Tasklet(Tasklet&&) = delete;
+
+  Tasklet& operator=(const Tasklet&) = delete;
+  Tasklet& operator=(Tasklet&&) = delete;
+
+  void set_callback(TaskletFunc func, void* cookie = nullptr) {
+    this->func = func;
+    this->cookie = cookie;
+  }
+
+  void schedule();
+
+  bool is_scheduled() const {
+    return this->scheduled.load(std::memory_order_relaxed);
+  }
+
+ private:
+  friend void run_tasklets();
+
+  Tasklet* next = nullptr;
+
+  TaskletFunc func = nullptr;
+  void* cookie = nullptr;
+
+  std::atomic<bool> scheduled = false;
+};
+
+void run_tasklets();
+void initialize_tasklets();
+}  // namespace irq
+
+#endif  // IRQ_TASKLET_HPP
@@ -2,23 +2,46 @@
 #define KERNEL_LOG_HPP
 
 #include <arch/arch.hpp>
+#include "format.hpp"
+#include "timer/clock.hpp"
 
-#include <printf_config.h>
+#include <stdint.h>
 
 #include <atomic>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 
-#include <printf/printf.h>
+// Emit a record if `level` is compiled in for `cat` and its category is
+// enabled. A call that is compiled out never evaluates its arguments. The
+// format string must be a literal: it is compiled along with the call.
+#define LOG_AT(level, cat, fmt, ...)                       \
+  do {                                                     \
+    if constexpr (log::compiled_in(level, cat)) {          \
+      if (log::enabled(level, cat)) {                      \
+        log::write<fmt>(level __VA_OPT__(, ) __VA_ARGS__); \
+      }                                                    \
+    }                                                      \
+  } while (0)
 
-#define debug(...) log::write(log::DEBUG, __VA_ARGS__)
+#define debug(...) LOG_AT(log::DEBUG, log::GENERAL, __VA_ARGS__)
 
-#define info(...) log::write(log::INFO, __VA_ARGS__)
+#define info(...) LOG_AT(log::INFO, log::GENERAL, __VA_ARGS__)
 
-#define warning(...) log::write(log::WARNING, __VA_ARGS__)
+#define warning(...) LOG_AT(log::WARNING, log::GENERAL, __VA_ARGS__)
 
-#define err(...) log::write(log::ERROR, __VA_ARGS__)
+#define err(...) LOG_AT(log::ERROR, log::GENERAL, __VA_ARGS__)
 
-#define panic(...) log::write(log::PANIC, __VA_ARGS__)
+#define panic(...) LOG_AT(log::PANIC, log::GENERAL, __VA_ARGS__)
+
+// Per-subsystem variants, e.g. log_debug(PMM, "...", ...).
+#define log_debug(cat, ...) LOG_AT(log::DEBUG, log::cat, __VA_ARGS__)
+
+#define log_info(cat, ...) LOG_AT(log::INFO, log::cat, __VA_ARGS__)
+
+#define log_warning(cat, ...) LOG_AT(log::WARNING, log::cat, __VA_ARGS__)
+
+#define log_err(cat, ...) LOG_AT(log::ERROR, log::cat, __VA_ARGS__)
 
 namespace log {
 enum log_level {
@@ -33,6 +56,94 @@ enum log_level {
 #define LOG_MIN_LEVEL log::DEBUG
 #endif
 
+enum category : uint8_t {
+  GENERAL,
+  PMM,
+  PG,
+  VMM,
+  IDT,
+  PIC,
+  CPU,
+  CATEGORY_MAX,
+};
+
+// Compile-time minimum level per category. Override with -DLOG_LEVEL_<CAT>;
+// calls below it are removed along with their arguments. The allocator and
+// page-table paths run on every page, so PMM and PG keep their debug output
+// compiled out.
+#ifndef LOG_LEVEL_GENERAL
+#define LOG_LEVEL_GENERAL LOG_MIN_LEVEL
+#endif
+#ifndef LOG_LEVEL_PMM
+#define LOG_LEVEL_PMM log::INFO
+#endif
+#ifndef LOG_LEVEL_PG
+#define LOG_LEVEL_PG log::INFO
+#endif
+#ifndef LOG_LEVEL_VMM
+#define LOG_LEVEL_VMM LOG_MIN_LEVEL
+#endif
+#ifndef LOG_LEVEL_IDT
+#define LOG_LEVEL_IDT LOG_MIN_LEVEL
+#endif
+#ifndef LOG_LEVEL_PIC
+#define LOG_LEVEL_PIC LOG_MIN_LEVEL
+#endif
+#ifndef LOG_LEVEL_CPU
+#define LOG_LEVEL_CPU LOG_MIN_LEVEL
+#endif
+
+constexpr log_level category_levels[CATEGORY_MAX] = {
+    LOG_LEVEL_GENERAL, LOG_LEVEL_PMM, LOG_LEVEL_PG,  LOG_LEVEL_VMM,
+    LOG_LEVEL_IDT,     LOG_LEVEL_PIC, LOG_LEVEL_CPU,
+};
+
+constexpr const char* category_name(category cat) {
+  switch (cat) {
+    case GENERAL:
+      return "general";
+    case PMM:
+      return "pmm";
+    case PG:
+      return "pg";
+    case VMM:
+      return "vmm";
+    case IDT:
+      return "idt";
+    case PIC:
+      return "pic";
+    case CPU:
+      return "cpu";
+    case CATEGORY_MAX:
+      break;
+  }
+
+  return nullptr;
+}
+
+// Panics are never compiled out; the caller relies on them not returning.
+constexpr bool compiled_in(log_level level, category cat) {
+  return (level == PANIC) ||
+         ((level >= LOG_MIN_LEVEL) && (level >= category_levels[cat]));
+}
+
+// Runtime mask over the compiled-in DEBUG and INFO calls, one bit per
+// category. Warnings and above always pass.
+inline std::atomic<uint32_t> category_mask{(1U << CATEGORY_MAX) - 1};
+
+inline bool enabled(log_level level, category cat) {
+  return (level >= WARNING) ||
+         ((category_mask.load(std::memory_order_relaxed) & (1U << cat)) != 0);
+}
+
+inline void set_category_enabled(category cat, bool on) {
+  if (on) {
+    category_mask.fetch_or(1U << cat, std::memory_order_relaxed);
+  } else {
+    category_mask.fetch_and(~(1U << cat), std::memory_order_relaxed);
+  }
+}
+
 // Define LOG_DISABLE_COLOR to strip ANSI color sequences.
 #ifdef LOG_DISABLE_COLOR
 constexpr const char* level_color(log_level) {
@@ -82,30 +193,260 @@ constexpr const char* level_label(log_level level) {
   return nullptr;
 }
 
+// Argument bytes kept per record. If the arguments do not fit, the record
+// prints as its bare format string followed by "...".
+#define LOG_RECORD_ARGS 160
+// Records buffered per CPU before new ones are dropped.
+#define LOG_RING_RECORDS 128
+// Longest console line, prefix included; longer ones are cut.
+#define LOG_LINE_MAX 384
+
 // Global monotonically increasing sequence number for log records.
 inline std::atomic<unsigned long long> g_log_seq{0};
 
-template <typename... Args>
-void write(log_level level, const char* fmt, Args&&... args) {
-  if (level < LOG_MIN_LEVEL) {
-    return;
+// Binary log record. The call site only copies its arguments; the format
+// string is referenced, not expanded, and formatting happens when the
+// record is printed. Integers and pointers take 8 bytes each, strings are
+// copied inline with their NUL. The format string's address doubles as a
+// static message ID when records are pulled out of a memory dump.
+struct Record {
+  // Raw clock counter, converted when the record is printed.
+  uint64_t stamp;
+  unsigned long long seq;
+  const char* fmt;
+  // The format compiled for the call site's argument types.
+  size_t (*render)(const Record& record, char* out, size_t size);
+  log_level level;
+
+  uint16_t arg_bytes;
+  bool truncated;
+
+  uint8_t args[LOG_RECORD_ARGS];
+};
+
+namespace details {
+class ArgWriter {
+ public:
+  explicit ArgWriter(Record& record) : record(record) {
+  }
+
+  void put(uint64_t value) {
+    if (!this->reserve(sizeof(value))) {
+      return;
+    }
+
+    __builtin_memcpy(&this->record.args[this->record.arg_bytes], &value,
+                     sizeof(value));
+    this->record.arg_bytes += sizeof(value);
+  }
+
+  void put(const char* str) {
+    if (str == nullptr) {
+      str = "(null)";
+    }
+
+    const size_t length = __builtin_strlen(str) + 1;
+
+    if (!this->reserve(length)) {
+      return;
+    }
+
+    __builtin_memcpy(&this->record.args[this->record.arg_bytes], str, length);
+    this->record.arg_bytes += length;
+  }
+
+  template <typename T>
+  void put_arg(const T& value) {
+    using D = std::decay_t<T>;
+
+    if constexpr (std::is_same_v<D, const char*> || std::is_same_v<D, char*>) {
+      this->put(static_cast<const char*>(value));
+    } else if constexpr (std::is_pointer_v<D> || std::is_null_pointer_v<D>) {
+      this->put(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value)));
+    } else if constexpr (std::is_enum_v<D>) {
+      this->put_arg(static_cast<std::underlying_type_t<D>>(value));
+    } else if constexpr (std::is_signed_v<D>) {
+      this->put(static_cast<uint64_t>(static_cast<int64_t>(value)));
+    } else {
+      this->put(static_cast<uint64_t>(value));
+    }
+  }
+
+ private:
+  bool reserve(size_t bytes) {
+    if (this->record.truncated ||
+        ((this->record.arg_bytes + bytes) > LOG_RECORD_ARGS)) {
+      this->record.truncated = true;
+      return false;
+    }
+
+    return true;
+  }
+
+  Record& record;
+};
+
+// Reads arguments back in the order ArgWriter stored them.
+class ArgReader {
+ public:
+  explicit ArgReader(const Record& record) : record(record), offset(0) {
+  }
+
+  bool get(uint64_t& value) {
+    if ((this->offset + sizeof(value)) > this->record.arg_bytes) {
+      return false;
+    }
+
+    __builtin_memcpy(&value, &this->record.args[this->offset], sizeof(value));
+    this->offset += sizeof(value);
+
+    return true;
+  }
+
+  bool get(const char*& str) {
+    if (this->offset >= this->record.arg_bytes) {
+      return false;
+    }
+
+    str = reinterpret_cast<const char*>(&this->record.args[this->offset]);
+
+    // ArgWriter always stores the NUL, so the string ends inside the record.
+    while ((this->offset < this->record.arg_bytes) &&
+           (this->record.args[this->offset] != '\0')) {
+      this->offset++;
+    }
+
+    this->offset++;
+
+    return true;
+  }
+
+  // The next argument as the type it was recorded from. Strings come back
+  // as const char*, pointing into the record.
+  template <typename T>
+  auto take() {
+    if constexpr (std::is_same_v<T, const char*> || std::is_same_v<T, char*>) {
+      const char* str = "";
+      this->get(str);
+      return str;
+    } else {
+      uint64_t value = 0;
+      this->get(value);
+
+      if constexpr (std::is_null_pointer_v<T>) {
+        return nullptr;
+      } else if constexpr (std::is_pointer_v<T>) {
+        return reinterpret_cast<T>(static_cast<uintptr_t>(value));
+      } else {
+        return static_cast<T>(value);
+      }
+    }
+  }
+
+ private:
+  const Record& record;
+  size_t offset;
+};
+
+// Record::render for one call site: decode the arguments as the types they
+// were recorded from and run the compiled format over them.
+template <format::fixed_string Fmt, typename... Args>
+size_t render(const Record& record, char* out, size_t size) {
+  format::buffer_sink sink(out, size);
+
+  if (record.truncated) {
+    sink.append(record.fmt);
+    sink.append("...");
+    return sink.finish();
+  }
+
+  ArgReader reader(record);
+  // Braced initialization reads the arguments in order.
+  const std::tuple<decltype(reader.take<Args>())...> args{
+      reader.take<Args>()...};
+
+  std::apply(
+      [&](const auto&... values) {
+        format::format_printf<Fmt>(sink, values...);
+      },
+      args);
+
+  return sink.finish();
+}
+
+// Format one console line into `line`, cut to LOG_LINE_MAX.
+template <format::fixed_string Fmt, typename... Args>
+void format_line(char (&line)[LOG_LINE_MAX], const Args&... args) {
+  format::buffer_sink sink(line, sizeof(line));
+
+  format::format_printf<Fmt>(sink, args...);
+
+  if (sink.finish() >= sizeof(line)) {
+    line[sizeof(line) - 2] = '\n';
   }
+}
+}  // namespace details
+
+// Queue a record on this CPU's ring. Never blocks; before the drain thread
+// runs, the record is printed right away instead.
+void submit(const Record& record);
 
-  const unsigned long long seq =
-      g_log_seq.fetch_add(1ULL, std::memory_order_relaxed);
+// Print a PANIC record right away, after whatever is still queued, without
+// going through the ring, where a full ring would drop it.
+void submit_panic(const Record& record);
 
-  // Prefix now only: color + [SEQ][LEVEL]
-  printf("%s[%06llu]%s%s%s ", level_color(level), seq, color_reset(),
-         level_color(level), level_label(level));
+// Expand a record into `out`, printf style. Returns the length of the full
+// text, which may exceed `size`.
+size_t format_record(const Record& record, char* out, size_t size);
 
-  printf(fmt, std::forward<Args>(args)...);
+// Print everything buffered on all CPUs and push it out of the console
+// driver, from the caller's context. Only for when klogd cannot run, as it
+// competes with klogd for the rings; otherwise use kick().
+void flush();
 
-  arch::write(color_reset());
-  arch::write('\n');
+// Wake the drain thread if records are waiting. From the idle loop and the
+// tick; never call with a run-queue lock held.
+void kick();
+
+// Write `text` to the console in one piece, under the lock klogd prints
+// with, so it never lands in the middle of a log line.
+void write_console(const char* text);
+
+// Console output outside the log, e.g. for the shell: one line per call,
+// formatted like the log and written with write_console().
+template <format::fixed_string Fmt, typename... Args>
+void print(const Args&... args) {
+  char line[LOG_LINE_MAX];
+
+  details::format_line<Fmt>(line, args...);
+  write_console(line);
+}
+
+// Start the drain thread. Needs the scheduler.
+void initialize();
+
+// `Fmt` is checked against the argument types at compile time; a mismatch
+// fails to compile.
+template <format::fixed_string Fmt, typename... Args>
+void write(log_level level, Args&&... args) {
+  Record record;
+  record.stamp = timer::arch::read_counter();
+  record.seq = g_log_seq.fetch_add(1ULL, std::memory_order_relaxed);
+  record.fmt = Fmt.data;
+  record.render = &details::render<Fmt, std::decay_t<Args>...>;
+  record.level = level;
+  record.arg_bytes = 0;
+  record.truncated = false;
+
+  details::ArgWriter writer(record);
+  (writer.put_arg(args), ...);
 
   if (level == PANIC) {
+    submit_panic(record);
     arch::halt(false);
   }
+
+  submit(record);
 }
 }  // namespace log
 
@@ -2,7 +2,7 @@
 #define MEMORY_PAGEMAP_HPP 1
 
 #include "lazy.hpp"
-#include "spinlock.hpp"
+#include "rwlock.hpp"
 
 #include <limine.h>
 #include <stddef.h>
@@ -117,7 +117,8 @@ class PageMap {
 
  private:
   arch::PageTable* root_tbl;
-  mutable libs::SpinLock lock;
+  // Translations vastly outnumber updates; readers take the per-CPU side.
+  mutable libs::BrLock lock{"pagemap"};
 };
 
 void initialize_paging(limine_memmap_response* memmap_response);
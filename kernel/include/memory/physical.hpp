@@ -5,6 +5,8 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "sched/workqueue.hpp"
+#include "seqlock.hpp"
 #include "spinlock.hpp"
 
 // The lowest order block size (2^0 * PageSize4KiB = 4 KiB)
@@ -23,6 +25,12 @@ struct PageMetadata {
   uint8_t order : 7;
 };
 
+struct PhysicalMemoryStats {
+  size_t total_memory;
+  size_t free_memory;
+  size_t free_blocks[MAX_ORDER + 1];
+};
+
 class PhysicalMemoryManager {
  public:
   PhysicalMemoryManager() = default;
@@ -46,12 +54,18 @@ class PhysicalMemoryManager {
     return this->total_memory;
   }
 
+  // Consistent snapshot that does not take the allocator lock.
+  PhysicalMemoryStats get_stats() const;
+
   uintptr_t get_highest_addr() const {
     return this->highest_addr;
   }
 
   void* allocate(size_t bytes, bool clear = false);
   void deallocate(void* ptr);
+  // Same as deallocate() but usable where the allocator lock must not be
+  // taken, e.g. from interrupt handlers. The block is freed by a worker.
+  void deallocate_deferred(void* ptr);
 
   template <typename T = void*>
   T allocate(size_t size, bool clear = false) {
@@ -71,6 +85,8 @@ class PhysicalMemoryManager {
 
   void set_page_metadata(uintptr_t addr, uint8_t order, bool is_free);
 
+  static void free_deferred(void* cookie);
+
  private:
   FreeBlockNode free_lists[MAX_ORDER + 1];
   PageMetadata* page_metadata = nullptr;
@@ -81,7 +97,16 @@ class PhysicalMemoryManager {
 
   uintptr_t highest_addr = 0;
 
-  mutable libs::SpinLock lock;
+  mutable libs::QueuedLock lock{"pmm"};
+
+  size_t free_blocks[MAX_ORDER + 1] = {};
+  // Write side held with `lock` whenever the counters change.
+  libs::SeqCount stats_seq;
+
+  // Blocks waiting for free_deferred(), linked through their first page.
+  FreeBlockNode* deferred = nullptr;
+  sched::Work deferred_work;
+  libs::IrqLock deferred_lock{"pmm-deferred"};
 };
 }  // namespace memory
 
@@ -46,7 +46,7 @@ class VirtualMemoryManager {
   size_t allocations = 0;
 
   // Simple synchronization; allocation is thread-safe via this lock.
-  mutable libs::SpinLock lock;
+  mutable libs::SpinLock lock{"vmm"};
 };
 }  // namespace memory
 
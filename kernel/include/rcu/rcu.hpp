@@ -0,0 +1,91 @@
+#ifndef RCU_RCU_HPP
+#define RCU_RCU_HPP 1
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <type_traits>
+
+// Callbacks invoked per softirq run; the rest waits for the next one.
+#define RCU_BATCH_LIMIT 64
+
+namespace rcu {
+struct RcuHead;
+
+using RcuCallback = void (*)(RcuHead* head);
+
+// Embedded in objects freed through call(). The callback gets the head back
+// and recovers the object from it.
+struct RcuHead {
+  RcuHead* next;
+  RcuCallback func;
+};
+
+struct RcuStats {
+  uint64_t grace_periods;
+  uint64_t queued;
+  uint64_t invoked;
+};
+
+#if NOISE_DEBUG
+void debug_read_lock();
+void debug_read_unlock();
+bool in_read_section();
+#endif
+
+// Read-side critical section. The scheduler is not preemptive, so a reader
+// only has to not block: a CPU that passes through schedule() or the idle
+// loop holds no read-side references. This costs no locks or atomics; debug
+// builds count nesting to catch readers that sleep.
+inline void read_lock() {
+#if NOISE_DEBUG
+  debug_read_lock();
+#endif
+  asm volatile("" ::: "memory");
+}
+
+inline void read_unlock() {
+  asm volatile("" ::: "memory");
+#if NOISE_DEBUG
+  debug_read_unlock();
+#endif
+}
+
+// Load an RCU-protected pointer inside a read-side critical section.
+template <typename T>
+inline T* dereference(T* const& ptr) {
+  return __atomic_load_n(&ptr, __ATOMIC_CONSUME);
+}
+
+// Publish `value`; everything written to it before is visible to readers
+// that load the new pointer.
+template <typename T>
+inline void assign_pointer(T*& ptr, std::type_identity_t<T>* value) {
+  __atomic_store_n(&ptr, value, __ATOMIC_RELEASE);
+}
+
+// Run `func(head)` once every CPU has passed a quiescent state, i.e. once no
+// reader can still see what was unpublished before the call. Safe from any
+// context; callbacks run in softirq context on the calling CPU.
+void call(RcuHead* head, RcuCallback func);
+
+// Wait for a full grace period. Thread context only.
+void synchronize();
+
+// Scheduler and idle loop hook: the calling CPU holds no read-side
+// references.
+void note_quiescent_state();
+
+// Tick hook: kick callback processing on this CPU if it has some.
+void check_callbacks();
+
+// True if this CPU has callbacks in flight and must keep its tick.
+bool needs_cpu();
+
+RcuStats get_stats(uint32_t cpu);
+
+// Bring the calling CPU online for grace-period tracking.
+void initialize();
+}  // namespace rcu
+
+#endif  // RCU_RCU_HPP
@@ -0,0 +1,112 @@
+#ifndef SCHED_THREAD_HPP
+#define SCHED_THREAD_HPP 1
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MAX_THREADS 64
+#define THREAD_STACK_SIZE 0x4000
+#define THREAD_NAME_LENGTH 16
+
+namespace sched {
+class Thread;
+struct Worker;
+
+using ThreadFunc = void (*)(void* arg);
+
+// Create a runnable thread on the calling CPU, nullptr if out of slots.
+Thread* create_thread(const char* name, ThreadFunc func, void* arg);
+
+Thread* current();
+
+// Give up the CPU to the next runnable thread, if any.
+void yield();
+// Sleep until Thread::wake(). Callers must re-check their wait condition.
+void block();
+[[noreturn]] void exit();
+
+// Switch to the next runnable thread. Returns immediately if there is none
+// and the caller can keep running.
+void schedule();
+bool has_runnable();
+
+// Turn the boot context into the idle thread of the calling CPU.
+void initialize();
+
+enum class ThreadState : uint8_t {
+  Free,
+  Runnable,
+  Running,
+  Blocked,
+  Dead,
+};
+
+// Kernel thread. Scheduling is cooperative: a thread runs until it blocks,
+// yields or exits, and always stays on the CPU that created it.
+class Thread {
+ public:
+  constexpr Thread() = default;
+
+  Thread(const Thread&) = delete;
+  Thread(Thread&&) = delete;
+
+  Thread& operator=(const Thread&) = delete;
+  Thread& operator=(Thread&&) = delete;
+
+  // Make a blocked thread runnable. Waking a thread that is not blocked
+  // makes its next block() return immediately, so wakeups are never lost.
+  void wake();
+
+  const char* get_name() const {
+    return this->name;
+  }
+
+  ThreadState get_state() const {
+    return this->state;
+  }
+
+  uint32_t get_cpu() const {
+    return this->cpu;
+  }
+
+  uint64_t get_switches() const {
+    return this->switches;
+  }
+
+  // Workqueue workers get told when they block and wake up, so their pool
+  // can keep exactly enough of them running.
+  void set_worker(Worker* worker) {
+    this->worker = worker;
+  }
+
+ private:
+  friend Thread* create_thread(const char*, ThreadFunc, void*);
+  friend void initialize();
+  friend void schedule();
+  friend void block();
+  friend void exit();
+  friend struct RunQueue;
+
+  // Claim a free slot, marking it Blocked until the caller sets it up.
+  static Thread* allocate(const char* name);
+  static void start(void* self);
+
+  uintptr_t sp = 0;
+  uintptr_t stack = 0;
+
+  ThreadFunc func = nullptr;
+  void* arg = nullptr;
+
+  Thread* next = nullptr;
+  Worker* worker = nullptr;
+
+  ThreadState state = ThreadState::Free;
+  bool wake_pending = false;
+  uint32_t cpu = 0;
+  uint64_t switches = 0;
+
+  char name[THREAD_NAME_LENGTH] = {};
+};
+}  // namespace sched
+
+#endif  // SCHED_THREAD_HPP
@@ -0,0 +1,193 @@
+#ifndef SCHED_WORKQUEUE_HPP
+#define SCHED_WORKQUEUE_HPP 1
+
+#include "sched/thread.hpp"
+#include "spinlock.hpp"
+#include "timer/wheel.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+// Upper bound on workers per pool, blocked ones included.
+#define WORKERS_PER_POOL 8
+// Idle workers beyond the first are retired after this long without work.
+#define WORKER_IDLE_TIMEOUT_NS (5 * NS_PER_SEC)
+
+namespace sched {
+class Work;
+class DelayedWork;
+class WorkerPool;
+
+using WorkFunc = void (*)(void* cookie);
+
+// Unit of deferred work, run in process context by a pool worker. A work
+// item is queued at most once at a time; re-queueing a pending item is a
+// no-op. It may be re-queued from its own callback.
+class Work {
+ public:
+  constexpr Work() = default;
+
+  Work(const Work&) = delete;
+  Work(Work&&) = delete;
+
+  Work& operator=(const Work&) = delete;
+  Work& operator=(Work&&) = delete;
+
+  void set_callback(WorkFunc func, void* cookie = nullptr) {
+    this->func = func;
+    this->cookie = cookie;
+  }
+
+  bool is_pending() const {
+    return this->pending.load(std::memory_order_relaxed);
+  }
+
+ private:
+  friend class WorkerPool;
+  friend class DelayedWork;
+  friend bool queue_delayed_work(DelayedWork*, uint64_t, bool);
+  friend bool cancel_delayed_work(DelayedWork*);
+
+  Work* next = nullptr;
+
+  WorkFunc func = nullptr;
+  void* cookie = nullptr;
+
+  std::atomic<bool> pending = false;
+};
+
+// Work item queued once a timer on the timer wheel expires.
+class DelayedWork {
+ public:
+  constexpr DelayedWork() = default;
+
+  DelayedWork(const DelayedWork&) = delete;
+  DelayedWork(DelayedWork&&) = delete;
+
+  DelayedWork& operator=(const DelayedWork&) = delete;
+  DelayedWork& operator=(DelayedWork&&) = delete;
+
+  void set_callback(WorkFunc func, void* cookie = nullptr) {
+    this->work.set_callback(func, cookie);
+  }
+
+  bool is_pending() const {
+    return this->work.is_pending();
+  }
+
+ private:
+  friend bool queue_delayed_work(DelayedWork*, uint64_t, bool);
+  friend bool cancel_delayed_work(DelayedWork*);
+
+  static void timer_expired(timer::Timer* timer, void* cookie);
+
+  Work work;
+  timer::Timer timer;
+  WorkerPool* pool = nullptr;
+};
+
+struct Worker {
+  Thread* thread;
+  WorkerPool* pool;
+
+  Worker* next_idle;
+  uint64_t idle_since;
+
+  // Executing work, as opposed to waiting for it.
+  bool busy;
+  // Blocked inside a work callback, not counted as running.
+  bool sleeping;
+  bool retire;
+};
+
+struct WorkerPoolStats {
+  uint64_t executed;
+  uint64_t workers_created;
+  uint64_t workers_retired;
+  size_t workers;
+  size_t idle;
+};
+
+// Set of workers draining one work list. The pool tries to keep exactly one
+// worker running: when the running worker blocks inside a work item, an idle
+// one takes over. A worker about to run an item with no spare left starts
+// one first, one at a time.
+class WorkerPool {
+ public:
+  WorkerPool() = default;
+
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool(WorkerPool&&) = delete;
+
+  WorkerPool& operator=(const WorkerPool&) = delete;
+  WorkerPool& operator=(WorkerPool&&) = delete;
+
+  void initialize(const char* name);
+
+  bool enqueue(Work* work);
+
+  void worker_sleeping(Worker* worker);
+  void worker_waking(Worker* worker);
+
+  WorkerPoolStats get_stats() const;
+
+ private:
+  friend class DelayedWork;
+
+  static void worker_main(void* cookie);
+  static void idle_timer_expired(timer::Timer* timer, void* cookie);
+
+  bool create_worker();
+  void retire_idle_workers();
+
+  // Append an item whose pending flag the caller has already set.
+  void insert(Work* work);
+
+  // Hand the head of the list to an idle worker. Lock held.
+  void wake_idle_worker();
+
+ private:
+  Work* head = nullptr;
+  Work** tail = &head;
+
+  Worker workers[WORKERS_PER_POOL] = {};
+  Worker* idle_list = nullptr;
+
+  size_t nr_workers = 0;
+  size_t nr_idle = 0;
+  // Created but not yet scheduled; counts as the spare until it runs.
+  size_t nr_starting = 0;
+  std::atomic<size_t> nr_running = 0;
+
+  WorkerPoolStats stats = {};
+
+  timer::Timer idle_timer;
+  char name[THREAD_NAME_LENGTH] = {};
+
+  mutable libs::IrqLock lock{"workqueue"};
+};
+
+// Queue on the calling CPU's pool, which is usually cache-hot for the data.
+bool queue_work(Work* work);
+bool queue_work_on(uint32_t cpu, Work* work);
+// Queue on the pool shared by all CPUs.
+bool queue_unbound_work(Work* work);
+
+bool queue_delayed_work(DelayedWork* work, uint64_t delay,
+                        bool unbound = false);
+// Stops a delayed work whose timer has not fired yet.
+bool cancel_delayed_work(DelayedWork* work);
+
+WorkerPoolStats get_pool_stats(uint32_t cpu);
+WorkerPoolStats get_unbound_pool_stats();
+
+// Scheduler hooks for threads with a worker attached.
+void worker_sleeping(Worker* worker);
+void worker_waking(Worker* worker);
+
+void initialize_workqueues();
+}  // namespace sched
+
+#endif  // SCHED_WORKQUEUE_HPP
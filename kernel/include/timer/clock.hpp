@@ -0,0 +1,61 @@
+#ifndef TIMER_CLOCK_HPP
+#define TIMER_CLOCK_HPP 1
+
+#include "arch/timer.hpp"
+
+#include <stdint.h>
+
+#define NS_PER_SEC 1000000000ull
+#define NS_PER_MSEC 1000000ull
+#define NS_PER_USEC 1000ull
+
+namespace timer {
+// Fixed-point conversion factors between raw counter ticks and nanoseconds.
+// Both are 32.32, so a conversion is one 64x64->128 multiply and a shift.
+struct ClockSource {
+  uint64_t base_counter;
+  uint64_t ns_mult;
+  uint64_t counter_mult;
+  bool ready;
+};
+
+extern ClockSource clock_source;
+
+void initialize_clock(uint64_t frequency);
+
+inline bool clock_ready() {
+  return clock_source.ready;
+}
+
+// Counter delta -> nanoseconds.
+inline uint64_t counter_delta_to_ns(uint64_t delta) {
+  const unsigned __int128 ns =
+      static_cast<unsigned __int128>(delta) * clock_source.ns_mult;
+  return static_cast<uint64_t>(ns >> 32);
+}
+
+// Absolute counter value -> nanoseconds since boot.
+inline uint64_t counter_to_ns(uint64_t counter) {
+  return (counter > clock_source.base_counter)
+             ? counter_delta_to_ns(counter - clock_source.base_counter)
+             : 0;
+}
+
+// Nanoseconds since boot -> absolute counter value.
+inline uint64_t ns_to_counter(uint64_t ns) {
+  const unsigned __int128 ticks =
+      static_cast<unsigned __int128>(ns) * clock_source.counter_mult;
+  return clock_source.base_counter + static_cast<uint64_t>(ticks >> 32);
+}
+
+// Monotonic nanoseconds since the clock was initialized, 0 before that.
+inline uint64_t now() {
+  if (!clock_source.ready) {
+    return 0;
+  }
+
+  return counter_to_ns(arch::read_counter());
+}
+}  // namespace timer
+
+#endif  // TIMER_CLOCK_HPP
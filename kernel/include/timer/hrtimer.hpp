@@ -0,0 +1,103 @@
+#ifndef TIMER_HRTIMER_HPP
+#define TIMER_HRTIMER_HPP 1
+
+#include "spinlock.hpp"
+
+#include <stdint.h>
+
+namespace timer {
+class HrTimer;
+class HrTimerQueue;
+
+using HrTimerCallback = void (*)(HrTimer* timer, void* cookie);
+
+// One-shot high-resolution timer. Deadlines are absolute nanoseconds on the
+// monotonic clock. Callbacks run in interrupt context on the CPU that armed
+// the timer and may re-arm it.
+class HrTimer {
+ public:
+  constexpr HrTimer() = default;
+
+  HrTimer(const HrTimer&) = delete;
+  HrTimer(HrTimer&&) = delete;
+
+  HrTimer& operator=(const HrTimer&) = delete;
+  HrTimer& operator=(HrTimer&&) = delete;
+
+  void set_callback(HrTimerCallback callback, void* cookie = nullptr) {
+    this->callback = callback;
+    this->cookie = cookie;
+  }
+
+  // (Re-)arm the timer on the calling CPU.
+  void start(uint64_t deadline);
+  void start_after(uint64_t delay);
+
+  // Returns false if the timer was not pending.
+  bool cancel();
+
+  bool is_active() const {
+    return this->queue != nullptr;
+  }
+
+  uint64_t get_deadline() const {
+    return this->deadline;
+  }
+
+ private:
+  friend class HrTimerQueue;
+
+  HrTimer* prev = nullptr;
+  HrTimer* next = nullptr;
+  HrTimerQueue* queue = nullptr;
+
+  uint64_t deadline = 0;
+
+  HrTimerCallback callback = nullptr;
+  void* cookie = nullptr;
+};
+
+// Per-CPU list of pending timers, sorted by deadline. Only the earliest entry
+// is ever programmed into the hardware.
+class HrTimerQueue {
+ public:
+  HrTimerQueue() = default;
+
+  HrTimerQueue(const HrTimerQueue&) = delete;
+  HrTimerQueue(HrTimerQueue&&) = delete;
+
+  HrTimerQueue& operator=(const HrTimerQueue&) = delete;
+  HrTimerQueue& operator=(HrTimerQueue&&) = delete;
+
+  void initialize();
+
+  void enqueue(HrTimer* timer, uint64_t deadline);
+  bool dequeue(HrTimer* timer);
+
+  // Run every timer whose deadline has passed, then program the next one.
+  void run_expired();
+
+  // Earliest pending deadline, UINT64_MAX if the queue is empty.
+  uint64_t next_deadline() const;
+
+ private:
+  void unlink(HrTimer* timer);
+  void reprogram();
+
+ private:
+  HrTimer head;
+
+  // Deadline currently loaded into the hardware (UINT64_MAX if none).
+  uint64_t programmed = UINT64_MAX;
+  bool running = false;
+
+  mutable libs::IrqLock lock{"hrtimer"};
+};
+
+HrTimerQueue& local_queue();
+
+void initialize_hrtimers();
+bool hrtimers_enabled();
+}  // namespace timer
+
+#endif  // TIMER_HRTIMER_HPP
@@ -0,0 +1,33 @@
+#ifndef TIMER_TICK_HPP
+#define TIMER_TICK_HPP 1
+
+#include "timer/clock.hpp"
+
+#include <stdint.h>
+
+// Frequency of the periodic scheduler tick.
+#define TICK_HZ 100
+#define TICK_NS (NS_PER_SEC / TICK_HZ)
+
+namespace timer {
+struct TickStats {
+  uint64_t ticks;
+  uint64_t idle_ns;
+  uint64_t idle_entries;
+  // Idle entries that stopped the tick because nothing was due soon.
+  uint64_t tick_stops;
+};
+
+// Global tick count since boot, kept up to date across stopped-tick periods.
+uint64_t get_jiffies();
+
+void start_tick();
+
+// Bracket the idle loop. Both must be called with interrupts disabled.
+void idle_enter();
+void idle_exit();
+
+TickStats get_tick_stats(uint32_t cpu);
+}  // namespace timer
+
+#endif  // TIMER_TICK_HPP
@@ -0,0 +1,8 @@
+#ifndef TIMER_HPP
+#define TIMER_HPP 1
+
+namespace timer {
+void initialize();
+}  // namespace timer
+
+#endif  // TIMER_HPP
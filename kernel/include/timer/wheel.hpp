@@ -0,0 +1,135 @@
+#ifndef TIMER_WHEEL_HPP
+#define TIMER_WHEEL_HPP 1
+
+#include "spinlock.hpp"
+#include "timer/hrtimer.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Bits of expiry covered by one wheel level (64 slots per level).
+#define WHEEL_SLOT_BITS 6
+#define WHEEL_SLOTS (1u << WHEEL_SLOT_BITS)
+#define WHEEL_LEVELS 4
+// Furthest a timer can be placed, in ticks (2^24 ticks, ~46 hours at 100 Hz).
+// Longer timeouts are parked in the last slot and re-cascaded.
+#define WHEEL_MAX_TICKS ((1ull << (WHEEL_SLOT_BITS * WHEEL_LEVELS)) - 1)
+
+namespace timer {
+class Timer;
+class TimerWheel;
+
+using TimerCallback = void (*)(Timer* timer, void* cookie);
+
+struct TimerLink {
+  TimerLink* prev;
+  TimerLink* next;
+};
+
+// Low-resolution timeout. Anything due further out than a couple of ticks is
+// kept in the per-CPU timer wheel (O(1) start/cancel, tick granularity) and
+// expires from the timer softirq; shorter timeouts go straight to an hrtimer
+// so they are not rounded up to the next tick, and expire in hard-IRQ
+// context. Either way the callback runs on the arming CPU.
+class Timer {
+ public:
+  constexpr Timer() = default;
+
+  Timer(const Timer&) = delete;
+  Timer(Timer&&) = delete;
+
+  Timer& operator=(const Timer&) = delete;
+  Timer& operator=(Timer&&) = delete;
+
+  void set_callback(TimerCallback callback, void* cookie = nullptr) {
+    this->callback = callback;
+    this->cookie = cookie;
+  }
+
+  // Deadline in absolute nanoseconds on the monotonic clock.
+  void start(uint64_t deadline);
+  void start_after(uint64_t delay);
+
+  // Returns false if the timer was not pending.
+  bool cancel();
+
+  bool is_active() const {
+    return (this->wheel != nullptr) || this->hrtimer.is_active();
+  }
+
+ private:
+  friend class TimerWheel;
+
+  static void hrtimer_expired(HrTimer* hrtimer, void* cookie);
+
+  // Must stay first, slot lists are made of these.
+  TimerLink link = {};
+
+  TimerWheel* wheel = nullptr;
+  uint64_t expires = 0;
+  uint8_t level = 0;
+  uint8_t slot = 0;
+
+  HrTimer hrtimer;
+
+  TimerCallback callback = nullptr;
+  void* cookie = nullptr;
+};
+
+class TimerWheel {
+ public:
+  TimerWheel() = default;
+
+  TimerWheel(const TimerWheel&) = delete;
+  TimerWheel(TimerWheel&&) = delete;
+
+  TimerWheel& operator=(const TimerWheel&) = delete;
+  TimerWheel& operator=(TimerWheel&&) = delete;
+
+  void initialize(uint64_t start_tick);
+
+  void enqueue(Timer* timer, uint64_t expires);
+  bool dequeue(Timer* timer);
+
+  // Process every tick up to and including `target`.
+  void advance(uint64_t target);
+
+  // Tick at which the wheel next needs attention, UINT64_MAX if empty.
+  // Cascade points count, so this may be earlier than any real expiry.
+  uint64_t next_expiry() const;
+
+  size_t get_pending() const {
+    return this->pending;
+  }
+
+ private:
+  void insert(Timer* timer);
+  void unlink(Timer* timer);
+  void cascade(uint8_t level, uint8_t slot);
+  void expire(uint8_t slot);
+
+  uint64_t next_expiry_locked() const;
+
+ private:
+  TimerLink slots[WHEEL_LEVELS][WHEEL_SLOTS];
+  uint64_t occupied[WHEEL_LEVELS] = {};
+
+  // Timers pulled out of a level-0 slot whose callbacks have not run yet.
+  TimerLink expired;
+
+  // Next tick to be processed.
+  uint64_t clock = 0;
+  size_t pending = 0;
+
+  mutable libs::IrqLock lock{"timer-wheel"};
+};
+
+TimerWheel& local_wheel();
+
+// Timer softirq: expire everything due on the calling CPU's wheel.
+void run_timer_softirq();
+
+void initialize_wheels(uint64_t start_tick);
+}  // namespace timer
+
+#endif  // TIMER_WHEEL_HPP
@@ -1,12 +1,19 @@
 #include "arch/x86_64/arch.hpp"
+#include "arch/x86_64/cpu/apic.hpp"
 #include "arch/x86_64/cpu/cpu.hpp"
+#include "arch/x86_64/cpu/fpu.hpp"
 #include "arch/x86_64/cpu/gdt.hpp"
 #include "arch/x86_64/cpu/idt.hpp"
+#include "arch/x86_64/cpu/io.hpp"
 #include "arch/x86_64/cpu/pic.hpp"
 #include "arch/x86_64/drivers/uart.hpp"
+#include "arch/x86_64/simd/simd.hpp"
 #include "drivers/manager.hpp"
 #include "arch/x86_64/registers.h"
 
+// QEMU's isa-debug-exit device, as configured by the bench task.
+#define DEBUG_EXIT_PORT 0xf4
+
 namespace arch::x86_64 {
 namespace {
 drivers::UartDriver uart_driver;
@@ -27,6 +34,15 @@ void halt(bool interrupts) {
   }
 }
 
+void exit_emulator(uint8_t code) {
+  cpu::out<uint8_t>(DEBUG_EXIT_PORT, code);
+  halt(false);
+}
+
+bool has_ordered_cycles() {
+  return cpu::test_feature(FEATURE_RDTSCP);
+}
+
 bool int_status() {
   size_t rflags = 0;
 
@@ -38,10 +54,10 @@ bool int_status() {
 }
 
 void int_switch(bool on) {
-  if(on) {
-    cpu::disable_interrupts();
-  } else {
+  if (on) {
     cpu::enable_interrupts();
+  } else {
+    cpu::disable_interrupts();
   }
 }
 
@@ -56,18 +72,47 @@ void initialize() {
   gdt.initialize();
   idt.initialize();
 
+  // GS base is only valid once the GDT reload above has happened.
+  cpu::initialize_percpu(0);
+  cpu::initialize_fpu();
+  simd::initialize();
+
   cpu::Pic::remap();
+  cpu::Apic::initialize();
+  uart_driver.enable_interrupts();
 
   cpu::enable_interrupts();
 }
 
+bool in_kernel_fpu() {
+  return cpu::in_kernel_fpu();
+}
+
+void copy_page(void* dest, const void* src) {
+  simd::copy_page(dest, src);
+}
+
+void clear_page(void* dest) {
+  simd::clear_page(dest);
+}
+
 void write(char ch) {
   uart_driver.putchar(ch);
 }
 
 void write(const char* str) {
-  while (*str) {
-    write(*str++);
-  }
+  uart_driver.transmit(str, __builtin_strlen(str));
+}
+
+void write_flush() {
+  uart_driver.flush();
+}
+
+size_t read(char* out, size_t length) {
+  return uart_driver.receive(out, length);
+}
+
+void set_input_notify(InputNotify notify, void* cookie) {
+  uart_driver.set_rx_notify(notify, cookie);
 }
 }  // namespace arch::x86_64
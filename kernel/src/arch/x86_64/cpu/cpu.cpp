@@ -38,6 +38,37 @@ uint32_t max_ext_cpuid = 0;
 ModelInfo model_info;
 VendorList vendor;
 
+// Tell klibc which rep movsb/stosb variants are fast here.
+void configure_string_ops() {
+  unsigned int features = 0;
+
+  if (test_feature(FEATURE_ERMS)) {
+    features |= STRING_FEATURE_ERMS;
+  }
+
+  if (test_feature(FEATURE_FSRM)) {
+    features |= STRING_FEATURE_FSRM;
+  }
+
+  // Fast short rep stosb lives in subleaf 1, which is not cached.
+  if (max_cpuid >= CpuidExtendedFeatureFlags) {
+    uint32_t a = 0, b = 0, c = 0, d = 0;
+    __cpuid_count(CpuidExtendedFeatureFlags, 1, a, b, c, d);
+
+    if (a & (1u << 11)) {
+      features |= STRING_FEATURE_FSRS;
+    }
+  }
+
+  string_set_features(features);
+
+  log_info(CPU, "[CPU] String ops: erms=%s fsrm=%s fsrs=%s",
+           (features & STRING_FEATURE_ERMS) ? "yes" : "no",
+           (features & STRING_FEATURE_FSRM) ? "yes" : "no",
+           (features & STRING_FEATURE_FSRS) ? "yes" : "no");
+}
+}  // namespace
+
 const CpuidLeaf* get_leaf(CpuidLeafNum leaf) {
   if (leaf < CpuidHypBase) {
     if (unlikely(leaf > max_cpuid)) {
@@ -59,7 +90,6 @@ const CpuidLeaf* get_leaf(CpuidLeafNum leaf) {
 
   return &cpuid_ext[leaf - CpuidExtBase];
 }
-}  // namespace
 
 bool test_feature(CpuidBit bit) {
   if (bit.word > 3 || bit.bit > 31) {
@@ -115,8 +145,9 @@ void initialize() {
   }
 
   // Enumerate base leaves 1..max_cpuid (inclusive)  [BUGFIX: was '< max_cpuid']
+  // Leaves with subleaves (4, 7, 0xb, 0xd, ...) are cached at subleaf 0.
   for (uint32_t i = (CpuidBase + 1); i <= max_cpuid; ++i) {
-    __cpuid(i, cpuid[i].a, cpuid[i].b, cpuid[i].c, cpuid[i].d);
+    __cpuid_count(i, 0, cpuid[i].a, cpuid[i].b, cpuid[i].c, cpuid[i].d);
   }
 
   // Extended CPUID range discovery and enumeration
@@ -176,14 +207,17 @@ void initialize() {
   }
 
   enable_pat();
+  configure_string_ops();
 
   // Log a brief CPU summary
-  info("[CPU] Vendor: %.*s | Max CPUID: base=0x%x ext=0x%x hyp=0x%x",
-       (int)sizeof(vendor_info.vendor_str), vendor_info.vendor_str, max_cpuid,
-       max_ext_cpuid, max_hyp_cpuid);
-  info("[CPU] Family: 0x%x (disp 0x%x) Model: 0x%x (disp 0x%x) Stepping: 0x%x",
-       model_info.family, model_info.display_family, model_info.model,
-       model_info.display_model, model_info.stepping);
+  log_info(CPU, "[CPU] Vendor: %.*s | Max CPUID: base=0x%x ext=0x%x hyp=0x%x",
+           (int)sizeof(vendor_info.vendor_str), vendor_info.vendor_str,
+           max_cpuid, max_ext_cpuid, max_hyp_cpuid);
+  log_info(
+      CPU,
+      "[CPU] Family: 0x%x (disp 0x%x) Model: 0x%x (disp 0x%x) Stepping: 0x%x",
+      model_info.family, model_info.display_family, model_info.model,
+      model_info.display_model, model_info.stepping);
 }
 
 ModelInfo get_model_info() {
@@ -0,0 +1,159 @@
+#include "arch/x86_64/cpu/fpu.hpp"
+#include "arch/x86_64/arch.hpp"
+#include "arch/x86_64/cpu/cpu.hpp"
+#include "arch/x86_64/cpu/percpu.hpp"
+#include "log.hpp"
+
+#include <cpuid.h>
+
+#include "arch/x86_64/registers.h"
+
+namespace arch::x86_64::cpu {
+namespace {
+struct FpuState {
+  // areas[n] holds the registers of the section at depth n + 1 while the one
+  // at depth n + 2 runs. XSAVE wants 64-byte alignment.
+  alignas(64) uint8_t areas[FPU_MAX_DEPTH - 1][FPU_SAVE_AREA];
+  uint32_t depth;
+};
+
+FpuState fpu_states[MAX_CPUS];
+
+bool fpu_ready = false;
+bool use_xsaveopt = false;
+uint64_t enabled_features = 0;
+
+// Save every enabled component; XCR0 masks the all-ones request.
+void save(uint8_t* area) {
+  if (use_xsaveopt) {
+    asm volatile("xsaveopt64 [%0]" ::"r"(area), "a"(~0u), "d"(~0u)
+                 : "memory");
+  } else {
+    asm volatile("xsave64 [%0]" ::"r"(area), "a"(~0u), "d"(~0u) : "memory");
+  }
+}
+
+void restore(const uint8_t* area) {
+  asm volatile("xrstor64 [%0]" ::"r"(area), "a"(~0u), "d"(~0u) : "memory");
+}
+
+uint32_t save_area_size() {
+  uint32_t a = 0, b = 0, c = 0, d = 0;
+  __cpuid_count(CpuidXsave, 0, a, b, c, d);
+  return b;
+}
+}  // namespace
+
+bool kernel_fpu_begin() {
+  if (!fpu_ready) {
+    return false;
+  }
+
+  // An interrupt landing between the depth check and the save would
+  // clobber the registers we are about to preserve.
+  const bool state = int_status();
+  int_switch(false);
+
+  FpuState& fpu = fpu_states[cpu_id()];
+
+  if (fpu.depth >= FPU_MAX_DEPTH) {
+    int_switch(state);
+    return false;
+  }
+
+  if (fpu.depth > 0) {
+    save(fpu.areas[fpu.depth - 1]);
+  }
+
+  fpu.depth++;
+  int_switch(state);
+
+  return true;
+}
+
+void kernel_fpu_end() {
+  const bool state = int_status();
+  int_switch(false);
+
+  FpuState& fpu = fpu_states[cpu_id()];
+
+#if NOISE_DEBUG
+  if (fpu.depth == 0) {
+    panic("[FPU] kernel_fpu_end() without kernel_fpu_begin()");
+  }
+#endif
+
+  fpu.depth--;
+
+  if (fpu.depth > 0) {
+    restore(fpu.areas[fpu.depth - 1]);
+  }
+
+  int_switch(state);
+}
+
+bool in_kernel_fpu() {
+  return fpu_ready && fpu_states[cpu_id()].depth != 0;
+}
+
+uint64_t fpu_features() {
+  return enabled_features;
+}
+
+void initialize_fpu() {
+  if (!test_feature(FEATURE_FXSR) || !test_feature(FEATURE_XSAVE) ||
+      get_leaf(CpuidXsave) == nullptr) {
+    log_warning(CPU, "[FPU] No XSAVE support, vector routines disabled");
+    return;
+  }
+
+  uint64_t cr0 = read_cr0();
+  cr0 &= ~static_cast<uint64_t>(CR0_EM | CR0_TS);
+  cr0 |= CR0_MP | CR0_NE;
+  write_cr0(cr0);
+
+  write_cr4(read_cr4() | CR4_OSFXSR | CR4_OSXMMEXCPT | CR4_OSXSAVE);
+
+  const CpuidLeaf* leaf = get_leaf(CpuidXsave);
+  const uint64_t supported = (static_cast<uint64_t>(leaf->d) << 32) | leaf->a;
+
+  uint64_t xcr0 = XCR0_X87 | XCR0_SSE;
+
+  if (test_feature(FEATURE_AVX) && (supported & XCR0_AVX)) {
+    xcr0 |= XCR0_AVX;
+  }
+
+  if ((xcr0 & XCR0_AVX) && test_feature(FEATURE_AVX512F) &&
+      (supported & XCR0_AVX512) == XCR0_AVX512) {
+    xcr0 |= XCR0_AVX512;
+  }
+
+  write_xcr(0, xcr0);
+
+  // EBX of leaf 0xd tracks the components currently enabled in XCR0.
+  if (save_area_size() > FPU_SAVE_AREA && (xcr0 & XCR0_AVX512)) {
+    xcr0 &= ~static_cast<uint64_t>(XCR0_AVX512);
+    write_xcr(0, xcr0);
+  }
+
+  const uint32_t size = save_area_size();
+
+  if (size > FPU_SAVE_AREA) {
+    log_warning(CPU, "[FPU] XSAVE area of %u bytes does not fit, disabled",
+                size);
+    return;
+  }
+
+  uint32_t a = 0, b = 0, c = 0, d = 0;
+  __cpuid_count(CpuidXsave, 1, a, b, c, d);
+  use_xsaveopt = a & 1;
+
+  asm volatile("fninit");
+
+  enabled_features = xcr0;
+  fpu_ready = true;
+
+  log_info(CPU, "[FPU] xcr0=0x%lx save area=%u bytes xsaveopt=%s", xcr0, size,
+           use_xsaveopt ? "yes" : "no");
+}
+}  // namespace arch::x86_64::cpu
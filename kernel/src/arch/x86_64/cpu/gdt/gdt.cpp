@@ -34,24 +34,27 @@ void GdtTable::print() const {
   // Dump GDT entries and TSS descriptor for debugging.
   for (int i = 0; i < MAX_ENTRIES; ++i) {
     const GdtSegment& seg = this->entries[i];
-    debug("GDT seg %d:\n\tBase: 0x%x\n\tLimit: 0x%x\n\tAccess: 0x%x\n\tGran: 0x%x",
-          i, seg.get_base(), seg.get_limit(), seg.get_access(),
-          seg.get_granularity());
+    log_debug(
+        CPU,
+        "GDT seg %d:\n\tBase: 0x%x\n\tLimit: 0x%x\n\tAccess: 0x%x\n\tGran: 0x%x",
+        i, seg.get_base(), seg.get_limit(), seg.get_access(),
+        seg.get_granularity());
   }
 
-  debug("GDT TSS:\n\tBase: 0x%lx\n\tFlags: 0x%x",
-        this->tss_segment.get_base(), this->tss_segment.get_flags());
+  log_debug(CPU, "GDT TSS:\n\tBase: 0x%lx\n\tFlags: 0x%x",
+            this->tss_segment.get_base(), this->tss_segment.get_flags());
 }
 
 void GdtRegister::load() {
   // Install GDTR and load TR with TSS selector; CS reload via far return in ASM.
-  debug("[GDT] Loading GDTR base=0x%lx limit=0x%x",
-        static_cast<uintptr_t>(this->base), static_cast<uint16_t>(this->limit));
+  log_debug(CPU, "[GDT] Loading GDTR base=0x%lx limit=0x%x",
+            static_cast<uintptr_t>(this->base),
+            static_cast<uint16_t>(this->limit));
 
   load_gdt(this);
   load_tss();
 
-  debug("[GDT] Loaded GDTR and TSS");
+  log_debug(CPU, "[GDT] Loaded GDTR and TSS");
 }
 
 void Gdt::initialize() {
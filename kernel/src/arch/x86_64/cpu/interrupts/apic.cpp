@@ -0,0 +1,76 @@
+#include "arch/x86_64/cpu/apic.hpp"
+#include "arch/x86_64/cpu/cpu.hpp"
+#include "arch/x86_64/cpu/exceptions.hpp"
+#include "arch/x86_64/cpu/percpu.hpp"
+#include "log.hpp"
+
+#include "arch/x86_64/registers.h"
+
+namespace arch::x86_64::cpu {
+namespace {
+enum ApicBaseFlags : uint64_t {
+  ApicBaseX2apic = (1ull << 10),
+  ApicBaseEnable = (1ull << 11),
+};
+
+enum ApicLvtFlags : uint32_t {
+  LvtMasked = (1u << 16),
+  LvtTimerOneShot = (0u << 17),
+  LvtTimerPeriodic = (1u << 17),
+  LvtTimerTscDeadline = (2u << 17),
+};
+
+constexpr uint32_t sivr_enable = (1u << 8);
+
+bool enabled = false;
+}  // namespace
+
+bool Apic::initialize() {
+  if (!test_feature(FEATURE_X2APIC)) {
+    log_warning(PIC, "[APIC] x2APIC not supported, local APIC left disabled");
+    return false;
+  }
+
+  // x2APIC has to be switched on together with (or after) the xAPIC enable.
+  uint64_t base = read_msr(MSR_APIC_BASE);
+  base |= ApicBaseEnable | ApicBaseX2apic;
+  write_msr(MSR_APIC_BASE, base);
+
+  // Software-enable the APIC and set the spurious vector.
+  write_msr(MSR_X2APIC_SIVR, sivr_enable | interruptApicSpurious);
+  write_msr(MSR_X2APIC_TPR, 0);
+
+  Apic::mask_timer();
+
+  current_cpu()->apic_id = Apic::id();
+  enabled = true;
+
+  log_debug(PIC, "[APIC] x2APIC enabled id=%u base=0x%lx", Apic::id(), base);
+  return true;
+}
+
+bool Apic::is_enabled() {
+  return enabled;
+}
+
+void Apic::eoi() {
+  write_msr(MSR_X2APIC_EOI, 0);
+}
+
+uint32_t Apic::id() {
+  return read_msr32(MSR_X2APIC_APICID);
+}
+
+void Apic::enable_tsc_deadline(uint8_t vector) {
+  write_msr(MSR_X2APIC_LVT_TIMER, LvtTimerTscDeadline | vector);
+
+  // SDM 10.5.4.1: the LVT write must be ordered before the first write to
+  // IA32_TSC_DEADLINE, otherwise that write may be dropped.
+  asm volatile("mfence" ::: "memory");
+}
+
+void Apic::mask_timer() {
+  write_msr(MSR_TSC_DEADLINE, 0);
+  write_msr(MSR_X2APIC_LVT_TIMER, LvtMasked);
+}
+}  // namespace arch::x86_64::cpu
@@ -1,16 +1,44 @@
 #include "arch/x86_64/arch.hpp"
 #include "arch/x86_64/cpu/exceptions.hpp"
 #include "arch/x86_64/cpu/idt.hpp"
+#include "irq/softirq.hpp"
 #include "log.hpp"
 
+extern "C" uintptr_t fast_isr_table[MAX_IDT_ENTRIES];
+
 namespace arch::x86_64::cpu {
 namespace {
 // Flat array of platform interrupt handlers [32..255]
 InterruptHandler handlers[platformMax - platformInterruptBase + 1];
+
+// Keeps a fast vector working if it is ever entered through the slow stub.
+void fast_fallback(IFrame* frame, void* cookie) {
+  reinterpret_cast<FastHandlerFunc>(cookie)(frame->vector);
+}
 }  // namespace
 
+// Referenced by the fast stubs in idt.S.
+extern "C" {
+FastHandlerFunc fast_handlers[MAX_IDT_ENTRIES] = {};
+
+#if NOISE_DEBUG
+InterruptStats interrupt_stats[MAX_IDT_ENTRIES] = {};
+#endif
+
+void fast_interrupt_eoi(uint8_t vector) {
+  send_eoi(vector);
+}
+
+// Called by both stubs after the EOI of every platform interrupt, outside
+// the per-vector cycle accounting.
+void interrupt_exit() {
+  irq::exit();
+}
+}
+
 void IFrame::print() const {
-  info(
+  log_info(
+      IDT,
       "\n\tCS : 0x%.16lx RIP: 0x%.16lx EFL: 0x%.16lx\n\t"
       "RAX: 0x%.16lx RBX: 0x%.16lx RCX: 0x%.16lx\n\t"
       "RDX: 0x%.16lx RSI: 0x%.16lx RBP: 0x%.16lx\n\t"
@@ -37,7 +65,8 @@ InterruptHandler& allocate_handler(int hint) {
     }
 
     handlers[i].reserve(i + base);
-    debug("[IDT][ALLOC] Reserved handler vector=%d (index=%d)", i + base, i);
+    log_debug(IDT, "[IDT][ALLOC] Reserved handler vector=%d (index=%d)",
+              i + base, i);
     return handlers[i];
   }
 
@@ -55,9 +84,52 @@ InterruptHandler& get_handler(int vector) {
   return handler;
 }
 
+bool install_fast_handler(InterruptHandler& handler, FastHandlerFunc func) {
+  const uint8_t vector = handler.get_vector();
+
+  if ((func == nullptr) || !handler.is_reserved()) {
+    return false;
+  }
+
+  if (!handler.set(fast_fallback, reinterpret_cast<void*>(func))) {
+    return false;
+  }
+
+  fast_handlers[vector] = func;
+  set_interrupt_gate(vector, fast_isr_table[vector]);
+
+  log_debug(IDT, "[IDT][FAST] Installed fast handler vector=%u", vector);
+  return true;
+}
+
+#if NOISE_DEBUG
+const InterruptStats& get_interrupt_stats(uint8_t vector) {
+  return interrupt_stats[vector];
+}
+
+void print_interrupt_stats() {
+  for (int i = 0; i < MAX_IDT_ENTRIES; ++i) {
+    const InterruptStats& stats = interrupt_stats[i];
+
+    if (stats.count == 0) {
+      continue;
+    }
+
+    log_info(IDT, "[IDT][STATS] vector=%3d path=%s count=%lu avg=%lu cycles", i,
+             (fast_handlers[i] != nullptr) ? "fast" : "slow", stats.count,
+             stats.cycles / stats.count);
+  }
+}
+#endif
+
 extern "C" void exception_handler(IFrame* frame) {
   bool interrupt_handled = false;
 
+  // Spurious APIC interrupts are not in service and must not be EOI'd.
+  if (frame->vector == interruptApicSpurious) {
+    return;
+  }
+
   if (frame->vector < platformInterruptBase) {
     // CPU exception (vectors 0..31)
     frame->print();
@@ -67,10 +139,10 @@ extern "C" void exception_handler(IFrame* frame) {
     InterruptHandler& handler = handlers[frame->vector - platformInterruptBase];
 
     if (handler.is_used()) {
-      debug("[IDT][DISPATCH] vector=%lu", frame->vector);
       interrupt_handled = handler(frame);
     } else {
-      debug("[IDT][DISPATCH] No handler for vector=%lu", frame->vector);
+      log_debug(IDT, "[IDT][DISPATCH] No handler for vector=%lu",
+                frame->vector);
     }
   }
 
@@ -1,3 +1,5 @@
+#include "arch/x86_64/arch.hpp"
+#include "arch/x86_64/cpu/apic.hpp"
 #include "arch/x86_64/cpu/exceptions.hpp"
 #include "arch/x86_64/cpu/idt.hpp"
 #include "log.hpp"
@@ -7,6 +9,10 @@ extern "C" uintptr_t isr_table[MAX_IDT_ENTRIES];
 extern "C" void load_idt(arch::x86_64::cpu::IdtRegister*);
 
 namespace arch::x86_64::cpu {
+namespace {
+IdtTable* active_table = nullptr;
+}  // namespace
+
 void IdtTable::initialize() {
   // Build IDT entries: all present interrupt gates, user-accessible for breakpoint.
   for (int i = 0; i < MAX_IDT_ENTRIES; ++i) {
@@ -14,25 +20,34 @@ void IdtTable::initialize() {
                                ((i == exceptionBreakpoint) ? dplUser : 0);
     this->entries[i] = {isr_table[i], 0, attributes, 0x8 /* kernel CS */};
   }
-  debug("[IDT] Initialized %d entries", MAX_IDT_ENTRIES);
+  log_debug(IDT, "[IDT] Initialized %d entries", MAX_IDT_ENTRIES);
+}
+
+void IdtTable::set_entry(uint8_t vector, uintptr_t base) {
+  const IdtSegment& seg = this->entries[vector];
+  this->entries[vector] = {base, seg.get_ist(), seg.get_attributes(),
+                           seg.get_selector()};
 }
 
 void IdtTable::print() const {
   // Print a subset for brevity; fix bug to index [i], not [0].
   for (int i = 0; i < MAX_IDT_ENTRIES; ++i) {
     const IdtSegment& seg = this->entries[i];
-    debug("IDT seg %d:\n\tBase: 0x%lx\n\tAttr: 0x%x\n\tSelector: 0x%x\n\tIST: 0x%x",
-          i, seg.get_base(), seg.get_attributes(), seg.get_selector(),
-          seg.get_ist());
+    log_debug(
+        IDT,
+        "IDT seg %d:\n\tBase: 0x%lx\n\tAttr: 0x%x\n\tSelector: 0x%x\n\tIST: 0x%x",
+        i, seg.get_base(), seg.get_attributes(), seg.get_selector(),
+        seg.get_ist());
   }
-  debug("ISR table base: %p", isr_table);
+  log_debug(IDT, "ISR table base: %p", isr_table);
 }
 
 void IdtRegister::load() {
-  debug("[IDT] Loading IDTR base=0x%lx limit=0x%x",
-        static_cast<uintptr_t>(this->base), static_cast<uint16_t>(this->limit));
+  log_debug(IDT, "[IDT] Loading IDTR base=0x%lx limit=0x%x",
+            static_cast<uintptr_t>(this->base),
+            static_cast<uint16_t>(this->limit));
   load_idt(this);
-  debug("[IDT] Loaded");
+  log_debug(IDT, "[IDT] Loaded");
 }
 
 void Idt::initialize() {
@@ -40,15 +55,35 @@ void Idt::initialize() {
 
   IdtRegister idtr = {&this->table};
   idtr.load();
+
+  active_table = &this->table;
   // Optionally: this->table.print();
 }
 
 // Provide a definition for the header-declared helper.
-// This routes EOI to the legacy PIC.
+// Local APIC vectors are acknowledged at the APIC, everything below them is
+// still routed through the legacy PIC. This runs on every interrupt, so it
+// does not log.
 void send_eoi(uint8_t vector) {
-#ifdef NOISE_DEBUG
-  debug("[IDT] EOI vector=%u", vector);
-#endif
+  if (vector >= interruptLocalApicBase) {
+    Apic::eoi();
+    return;
+  }
+
   Pic::eoi(vector);
 }
+
+void set_interrupt_gate(uint8_t vector, uintptr_t base) {
+  if (active_table == nullptr) {
+    panic("[IDT] Gate update for vector %u before the IDT is loaded", vector);
+  }
+
+  // The 16-byte descriptor is not written atomically.
+  const bool state = arch::x86_64::int_status();
+  arch::x86_64::int_switch(false);
+
+  active_table->set_entry(vector, base);
+
+  arch::x86_64::int_switch(state);
+}
 }  // namespace arch::x86_64::cpu
@@ -73,7 +73,8 @@ void Pic::remap(uint8_t offset1, uint8_t offset2) {
   io_wait();
 
 #ifdef NOISE_DEBUG
-  debug("[PIC] Remapped: master_offset=0x%x slave_offset=0x%x", offset1, offset2);
+  log_debug(PIC, "[PIC] Remapped: master_offset=0x%x slave_offset=0x%x",
+            offset1, offset2);
 #endif
 
   // Mask all IRQs
@@ -85,18 +86,16 @@ void Pic::remap(uint8_t offset1, uint8_t offset2) {
 
 void Pic::disable() {
 #ifdef NOISE_DEBUG
-  debug("[PIC] Masking all IRQs!");
+  log_debug(PIC, "[PIC] Masking all IRQs!");
 #endif
 
   out<uint8_t>(Pic1Data, 0xff);
   out<uint8_t>(Pic2Data, 0xff);
 }
 
+// Threaded IRQs mask and unmask their line on every interrupt, so these do
+// not log.
 void Pic::set_mask(uint8_t irq) {
-#ifdef NOISE_DEBUG
-  debug("[PIC] Masking Vector 0x%x", irq);
-#endif
-
   uint8_t port = Pic1Data;
   irq -= platformInterruptBase;
 
@@ -110,10 +109,6 @@ void Pic::set_mask(uint8_t irq) {
 }
 
 void Pic::clear_mask(uint8_t irq) {
-#ifdef NOISE_DEBUG
-  debug("[PIC] Unmasking Vector 0x%x", irq);
-#endif
-
   uint8_t port = Pic1Data;
   irq -= platformInterruptBase;
 
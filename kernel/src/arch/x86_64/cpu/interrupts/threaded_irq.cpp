@@ -0,0 +1,116 @@
+#include "arch/x86_64/cpu/exceptions.hpp"
+#include "arch/x86_64/cpu/pic.hpp"
+#include "arch/x86_64/cpu/threaded_irq.hpp"
+#include "log.hpp"
+#include "sched/thread.hpp"
+#include "spinlock.hpp"
+
+#include <printf/printf.h>
+
+namespace arch::x86_64::cpu {
+namespace {
+// A slot is taken while its handler is set.
+ThreadedIrq threaded_irqs[MAX_THREADED_IRQS];
+libs::SpinLock threaded_lock("threaded-irq");
+
+bool is_pic_vector(uint8_t vector) {
+  return (vector >= platformInterruptBase) && (vector <= irqSecondaryAta);
+}
+
+void threaded_primary(IFrame* frame, void* cookie) {
+  ThreadedIrq* irq = static_cast<ThreadedIrq*>(cookie);
+
+  const IrqReturn ret = (irq->primary != nullptr)
+                            ? irq->primary(frame, irq->cookie)
+                            : IrqReturn::WakeThread;
+
+  if (ret != IrqReturn::WakeThread) {
+    return;
+  }
+
+  if (is_pic_vector(irq->vector)) {
+    Pic::set_mask(irq->vector);
+  }
+
+  irq->pending.store(true, std::memory_order_release);
+
+  // Not yet during request_threaded_irq(); the thread starts with the flag.
+  if (irq->thread != nullptr) {
+    irq->thread->wake();
+  }
+}
+
+void irq_thread(void* cookie) {
+  ThreadedIrq* irq = static_cast<ThreadedIrq*>(cookie);
+
+  while (true) {
+    if (!irq->pending.exchange(false, std::memory_order_acquire)) {
+      sched::block();
+      continue;
+    }
+
+    irq->handler(irq->cookie);
+    irq->count++;
+
+    if (is_pic_vector(irq->vector)) {
+      Pic::clear_mask(irq->vector);
+    }
+  }
+}
+}  // namespace
+
+ThreadedIrq* request_threaded_irq(int hint, PrimaryHandler primary,
+                                  ThreadedHandler handler, void* cookie,
+                                  const char* name) {
+  ThreadedIrq* irq = nullptr;
+
+  {
+    libs::LockGuard guard(threaded_lock);
+
+    for (ThreadedIrq& candidate : threaded_irqs) {
+      if (candidate.handler == nullptr) {
+        irq = &candidate;
+        break;
+      }
+    }
+
+    if (irq == nullptr) {
+      log_err(IDT, "[IRQ] Out of threaded IRQ slots for '%s'", name);
+      return nullptr;
+    }
+
+    irq->handler = handler;
+  }
+
+  InterruptHandler& slot = allocate_handler(hint);
+
+  irq->primary = primary;
+  irq->cookie = cookie;
+  irq->thread = nullptr;
+  irq->pending.store(false, std::memory_order_relaxed);
+  irq->count = 0;
+  irq->vector = slot.get_vector();
+
+  if (slot.set(threaded_primary, irq)) {
+    char thread_name[THREAD_NAME_LENGTH];
+    snprintf(thread_name, sizeof(thread_name), "irq/%u-%s", irq->vector,
+             name);
+
+    irq->thread = sched::create_thread(thread_name, irq_thread, irq);
+  }
+
+  if (irq->thread == nullptr) {
+    log_err(IDT, "[IRQ] Failed to set up threaded handler for vector %u",
+            irq->vector);
+
+    slot.release();
+
+    libs::LockGuard guard(threaded_lock);
+    irq->handler = nullptr;
+    return nullptr;
+  }
+
+  log_debug(IDT, "[IRQ] Threaded handler '%s' on vector %u", name, irq->vector);
+  return irq;
+}
+}  // namespace arch::x86_64::cpu
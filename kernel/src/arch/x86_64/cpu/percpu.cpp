@@ -0,0 +1,29 @@
+#include "arch/x86_64/cpu/cpu.hpp"
+#include "arch/x86_64/cpu/percpu.hpp"
+#include "log.hpp"
+
+#include "arch/x86_64/registers.h"
+
+namespace arch::x86_64::cpu {
+namespace {
+PerCpu percpu[MAX_CPUS];
+}  // namespace
+
+void initialize_percpu(uint32_t cpu_id) {
+  if (cpu_id >= MAX_CPUS) {
+    panic("[CPU] cpu_id %u exceeds MAX_CPUS (%u)", cpu_id, MAX_CPUS);
+  }
+
+  PerCpu& self = percpu[cpu_id];
+  self.self = &self;
+  self.cpu_id = cpu_id;
+  self.apic_id = 0;
+
+  // Loading a segment selector resets the hidden GS base, so this has to run
+  // after the GDT has been installed.
+  write_msr(MSR_GS_BASE, reinterpret_cast<uintptr_t>(&self));
+  write_msr(MSR_KERNEL_GS_BASE, 0);
+
+  log_debug(CPU, "[CPU] Per-CPU block for cpu %u at %p", cpu_id, &self);
+}
+}  // namespace arch::x86_64::cpu
@@ -1,12 +1,21 @@
 #include "arch/x86_64/cpu/cpu.hpp"
+#include "arch/x86_64/cpu/exceptions.hpp"
 #include "arch/x86_64/cpu/io.hpp"
+#include "arch/x86_64/cpu/pic.hpp"
 #include "arch/x86_64/drivers/uart.hpp"
+#include "log.hpp"
 #include "uart_internal.hpp"
 
 namespace drivers {
 using namespace arch::x86_64;
 using namespace drivers::uart;
 
+namespace {
+void uart_interrupt(cpu::IFrame*, void* cookie) {
+  static_cast<UartDriver*>(cookie)->handle_interrupt();
+}
+}  // namespace
+
 void UartDriver::write(uint16_t reg, uint8_t val) const {
   cpu::out(this->m_port + reg, val);
 }
@@ -15,13 +24,185 @@ uint8_t UartDriver::read(uint16_t reg) const {
   return cpu::in<uint8_t>(this->m_port + reg);
 }
 
-void UartDriver::putchar(uint8_t ch) const {
-  // Wait until the THR (Transmit Holding Register) is empty, then write byte.
-  while (!(this->read(LINE_STATUS) & LINE_TRANSMITTER_BUF_EMPTY)) {
-    cpu::pause();
+// Writes up to one FIFO's worth if the transmitter is empty. One status
+// read covers the whole burst.
+size_t UartDriver::fill_fifo() {
+  if (!(this->read(LINE_STATUS) & LINE_TRANSMITTER_BUF_EMPTY)) {
+    return 0;
+  }
+
+  size_t sent = 0;
+
+  while ((sent < UART_FIFO_SIZE) && (this->queued() != 0)) {
+    this->write(DATA,
+                this->m_tx_buffer[this->m_tx_tail++ & (UART_TX_BUFFER - 1)]);
+    sent++;
+  }
+
+  return sent;
+}
+
+void UartDriver::drain() {
+  while (this->queued() != 0) {
+    if (this->fill_fifo() == 0) {
+      cpu::pause();
+    }
+  }
+}
+
+void UartDriver::enqueue(uint8_t ch) {
+  // Full queue: push a burst out by hand rather than drop console output.
+  while (this->queued() == UART_TX_BUFFER) {
+    if (this->fill_fifo() == 0) {
+      cpu::pause();
+    }
+  }
+
+  this->m_tx_buffer[this->m_tx_head++ & (UART_TX_BUFFER - 1)] = ch;
+}
+
+void UartDriver::set_ier(uint8_t bits, bool on) {
+  this->m_ier = on ? (this->m_ier | bits) : (this->m_ier & ~bits);
+  this->write(INTERRUPT, this->m_ier);
+}
+
+void UartDriver::kick(bool end_of_line) {
+  if (this->m_irq_mode) {
+    // Enabling THRE while the transmitter is empty raises the interrupt
+    // right away, which starts the first burst.
+    if (!this->m_tx_active && (this->queued() != 0)) {
+      this->m_tx_active = true;
+      this->set_ier(INTERRUPT_WHEN_TRANSMITTER_EMPTY, true);
+    }
+
+    return;
+  }
+
+  if (end_of_line) {
+    this->drain();
+    return;
+  }
+
+  while (this->queued() >= UART_FIFO_SIZE) {
+    if (this->fill_fifo() == 0) {
+      cpu::pause();
+    }
+  }
+}
+
+void UartDriver::putchar(uint8_t ch) {
+  libs::LockGuard guard(this->m_tx_lock);
+
+  this->enqueue(ch);
+  this->kick(ch == '\n');
+}
+
+void UartDriver::transmit(const char* data, size_t length) {
+  libs::LockGuard guard(this->m_tx_lock);
+  bool end_of_line = false;
+
+  for (size_t i = 0; i < length; ++i) {
+    this->enqueue(data[i]);
+    end_of_line |= (data[i] == '\n');
   }
 
-  this->write(DATA, ch);
+  this->kick(end_of_line);
+}
+
+void UartDriver::flush() {
+  // A panic may come from under the transmit lock; send regardless.
+  const bool locked = this->m_tx_lock.try_lock();
+
+  this->drain();
+
+  if (locked) {
+    this->m_tx_lock.unlock();
+  }
+}
+
+size_t UartDriver::receive(char* out, size_t length) {
+  size_t count = 0;
+  uint8_t ch = 0;
+
+  while ((count < length) && this->m_rx_ring.pop(ch)) {
+    out[count++] = static_cast<char>(ch);
+  }
+
+  return count;
+}
+
+bool UartDriver::enable_interrupts() {
+  const uint8_t vector = ((this->m_port == PORT_A) || (this->m_port == PORT_C))
+                             ? cpu::irqSerialPort1
+                             : cpu::irqSerialPort2;
+  cpu::InterruptHandler& irq = cpu::allocate_handler(vector);
+
+  if ((irq.get_vector() != vector) || !irq.set(uart_interrupt, this)) {
+    err("[UART] IRQ vector %u is already taken, output stays polled", vector);
+    return false;
+  }
+
+  {
+    libs::LockGuard guard(this->m_tx_lock);
+    this->m_irq_mode = true;
+    this->set_ier(INTERRUPT_WHEN_DATA_AVAILABLE, true);
+    this->kick(false);
+  }
+
+  cpu::Pic::clear_mask(vector);
+  return true;
+}
+
+// Empties the receive FIFO, which also acknowledges the interrupt.
+void UartDriver::receive_pending() {
+  while (this->read(LINE_STATUS) & LINE_DATA_READY) {
+    // A full queue drops the byte; nobody is reading the console anyway.
+    this->m_rx_ring.push(this->read(DATA));
+  }
+}
+
+void UartDriver::handle_interrupt() {
+  bool received = false;
+
+  {
+    libs::LockGuard guard(this->m_tx_lock);
+
+    while (true) {
+      const uint8_t iir = this->read(INTERRUPT_IDENTIFICATION);
+
+      if (iir & INTERRUPT_NONE_PENDING) {
+        break;
+      }
+
+      switch (iir & INTERRUPT_ID_MASK) {
+        case INTERRUPT_ID_TRANSMITTER_EMPTY:
+          this->fill_fifo();
+
+          // Nothing left: stop the interrupt until the next kick().
+          if (this->queued() == 0) {
+            this->m_tx_active = false;
+            this->set_ier(INTERRUPT_WHEN_TRANSMITTER_EMPTY, false);
+          }
+          break;
+        case INTERRUPT_ID_DATA_AVAILABLE:
+        case INTERRUPT_ID_CHARACTER_TIMEOUT:
+          this->receive_pending();
+          received = true;
+          break;
+        case INTERRUPT_ID_LINE_STATUS:
+          this->read(LINE_STATUS);
+          break;
+        default:
+          this->read(MODEM_STATUS);
+          break;
+      }
+    }
+  }
+
+  // Outside the lock: the callback may wake a thread.
+  if (received && (this->m_rx_notify != nullptr)) {
+    this->m_rx_notify(this->m_rx_cookie);
+  }
 }
 
 bool UartDriver::initialize() {
@@ -31,9 +212,9 @@ bool UartDriver::initialize() {
 
   // 2) Set baud rate via divisor latch (DLAB)
   this->write(LINE_CONTROL, LINE_DLAB_STATUS);  // LCR: set DLAB=1
-  // Baud divisor for 115200 base clock; divisor=3 -> 38400 baud (example)
-  this->write(BAUD_RATE_LOW, 3);
-  this->write(BAUD_RATE_HIGH, 0);
+  // Divisor of the 115200 Hz base clock, see set_baud().
+  this->write(BAUD_RATE_LOW, this->m_divisor & 0xff);
+  this->write(BAUD_RATE_HIGH, this->m_divisor >> 8);
 
   // 3) 8 data bits, no parity, 1 stop bit (8N1), clear DLAB
   this->write(LINE_CONTROL, LINE_DS_8);
@@ -77,8 +258,12 @@ bool UartDriver::initialize() {
 }
 
 void UartDriver::shutdown() {
-  // Optional: lower DTR/RTS and disable interrupts if desired.
-  // this->write(MODEM_CONTROL, 0);
-  // this->write(INTERRUPT, 0);
+  libs::LockGuard guard(this->m_tx_lock);
+
+  this->drain();
+  this->m_irq_mode = false;
+  this->m_tx_active = false;
+  this->m_ier = 0;
+  this->write(INTERRUPT, this->m_ier);
 }
 }  // namespace drivers
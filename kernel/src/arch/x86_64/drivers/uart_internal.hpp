@@ -43,6 +43,15 @@ constexpr uint8_t INTERRUPT_WHEN_TRANSMITTER_EMPTY = (1u << 1);
 constexpr uint8_t INTERRUPT_WHEN_BREAK_EMPTY = (1u << 2);
 constexpr uint8_t INTERRUPT_WHEN_STATUS_UPDATE = (1u << 3);
 
+// IIR fields
+constexpr uint8_t INTERRUPT_NONE_PENDING = (1u << 0);
+constexpr uint8_t INTERRUPT_ID_MASK = (7u << 1);
+constexpr uint8_t INTERRUPT_ID_MODEM_STATUS = (0u << 1);
+constexpr uint8_t INTERRUPT_ID_TRANSMITTER_EMPTY = (1u << 1);
+constexpr uint8_t INTERRUPT_ID_DATA_AVAILABLE = (2u << 1);
+constexpr uint8_t INTERRUPT_ID_LINE_STATUS = (3u << 1);
+constexpr uint8_t INTERRUPT_ID_CHARACTER_TIMEOUT = (6u << 1);
+
 // LSR bits
 constexpr uint8_t LINE_DATA_READY = (1u << 0);
 constexpr uint8_t LINE_OVERRUN_ERROR = (1u << 1);
@@ -0,0 +1,28 @@
+#include "arch/x86_64/memory/page_ops.hpp"
+#include "arch/x86_64/cpu/cpu.hpp"
+
+namespace memory::arch::x86_64 {
+void flush_cache_range(const void* addr, size_t length, bool evict) {
+  using namespace ::arch::x86_64;
+
+  const uintptr_t end = reinterpret_cast<uintptr_t>(addr) + length;
+  uintptr_t line = reinterpret_cast<uintptr_t>(addr) & -CACHE_LINE_SIZE;
+
+  if (!evict && cpu::test_feature(FEATURE_CLWB)) {
+    for (; line < end; line += CACHE_LINE_SIZE) {
+      asm volatile("clwb %0" ::"m"(*reinterpret_cast<const char*>(line)));
+    }
+  } else if (cpu::test_feature(FEATURE_CLFLUSHOPT)) {
+    for (; line < end; line += CACHE_LINE_SIZE) {
+      asm volatile("clflushopt %0" ::"m"(*reinterpret_cast<const char*>(line)));
+    }
+  } else {
+    // Baseline for every x86_64 CPU.
+    for (; line < end; line += CACHE_LINE_SIZE) {
+      asm volatile("clflush %0" ::"m"(*reinterpret_cast<const char*>(line)));
+    }
+  }
+
+  stream_fence();
+}
+}  // namespace memory::arch::x86_64
@@ -5,8 +5,7 @@
 #include "memory/memory.hpp"
 #include "memory/pagemap.hpp"
 
-#include <string.h>
-
+#include <algorithm>
 #include <utility>
 
 namespace memory::arch::x86_64 {
@@ -146,7 +145,8 @@ std::pair<size_t, CachingType> convert_flags(size_t flags,
 PageSizeType fix_page_size(PageSizeType type) noexcept {
   // Downgrade large (1GiB) pages if CPU/firmware did not enable them.
   if ((type == PageLarge) && !pml3_available) {
-    debug(
+    log_debug(
+        PG,
         "[ARCH][PAGING] Downgrading 1GiB page request -> 2MiB (no PML3 huge "
         "pages)");
     return PageMedium;
@@ -228,9 +228,9 @@ PageMap::PageMap() : root_tbl(new_table()) {
 
     arch::x86_64::pml3_available = cpu::test_feature(FEATURE_HUGE_PAGE);
 
-    debug("[ARCH][PAGING] New kernel PageMap: levels=%d 1GiB=%s",
-          arch::x86_64::max_levels,
-          arch::x86_64::pml3_available ? "yes" : "no");
+    log_debug(PG, "[ARCH][PAGING] New kernel PageMap: levels=%d 1GiB=%s",
+              arch::x86_64::max_levels,
+              arch::x86_64::pml3_available ? "yes" : "no");
 
     arch::PageTable* tbl = to_higher_half(this->root_tbl);
 
@@ -241,9 +241,12 @@ PageMap::PageMap() : root_tbl(new_table()) {
   } else {
     // User / secondary map: copy kernel half so higher-half remains shared.
     arch::PageTable* tbl = to_higher_half(this->root_tbl);
-    const auto& kernel_table = to_higher_half(kernel_pagemap->root_tbl);
-    debug("[ARCH][PAGING] Cloning kernel higher-half page table entries");
-    memcpy(tbl->entries + 256, kernel_table + 256, 256 * sizeof(PageEntry));
+    const arch::PageTable* kernel_table =
+        to_higher_half(kernel_pagemap->root_tbl);
+    log_debug(PG,
+              "[ARCH][PAGING] Cloning kernel higher-half page table entries");
+    std::copy_n(kernel_table->entries + MAX_ENTRIES / 2, MAX_ENTRIES / 2,
+                tbl->entries + MAX_ENTRIES / 2);
   }
 }
 }  // namespace memory
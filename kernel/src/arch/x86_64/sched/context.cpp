@@ -0,0 +1,33 @@
+#include "arch/x86_64/sched/context.hpp"
+
+extern "C" void context_bootstrap();
+
+namespace sched::arch::x86_64 {
+namespace {
+// Frame popped by context_switch, lowest address first.
+struct SwitchFrame {
+  uint64_t r15;
+  uint64_t r14;
+  uint64_t r13;
+  uint64_t r12;
+  uint64_t rbx;
+  uint64_t rbp;
+  uint64_t rip;
+};
+}  // namespace
+
+uintptr_t initialize_stack(uintptr_t stack_top, ThreadStart start, void* arg) {
+  // After `ret` pops the frame, the stack must be 16-byte aligned so the
+  // `call` in context_bootstrap enters `start` with the ABI alignment.
+  const uintptr_t aligned_top = stack_top & ~static_cast<uintptr_t>(0xf);
+  SwitchFrame* frame =
+      reinterpret_cast<SwitchFrame*>(aligned_top - 16 - sizeof(SwitchFrame));
+
+  *frame = {};
+  frame->r12 = reinterpret_cast<uint64_t>(start);
+  frame->r13 = reinterpret_cast<uint64_t>(arg);
+  frame->rip = reinterpret_cast<uint64_t>(context_bootstrap);
+
+  return reinterpret_cast<uintptr_t>(frame);
+}
+}  // namespace sched::arch::x86_64
@@ -0,0 +1,93 @@
+#include <immintrin.h>
+
+#include "simd_internal.hpp"
+
+// The kernel is built without SSE; only this file may use AVX2, and only
+// through the Ops table below.
+#pragma GCC target("avx2")
+
+namespace arch::x86_64::simd {
+namespace {
+constexpr size_t block = sizeof(__m256i);
+
+void copy_page(void* dest, const void* src) {
+  auto* out = static_cast<__m256i*>(dest);
+  const auto* in = static_cast<const __m256i*>(src);
+
+  for (size_t i = 0; i < SIMD_PAGE_SIZE / block; i += 4) {
+    const __m256i a = _mm256_load_si256(in + i);
+    const __m256i b = _mm256_load_si256(in + i + 1);
+    const __m256i c = _mm256_load_si256(in + i + 2);
+    const __m256i d = _mm256_load_si256(in + i + 3);
+
+    _mm256_store_si256(out + i, a);
+    _mm256_store_si256(out + i + 1, b);
+    _mm256_store_si256(out + i + 2, c);
+    _mm256_store_si256(out + i + 3, d);
+  }
+}
+
+void clear_page(void* dest) {
+  auto* out = static_cast<__m256i*>(dest);
+  const __m256i zero = _mm256_setzero_si256();
+
+  for (size_t i = 0; i < SIMD_PAGE_SIZE / block; i += 4) {
+    _mm256_store_si256(out + i, zero);
+    _mm256_store_si256(out + i + 1, zero);
+    _mm256_store_si256(out + i + 2, zero);
+    _mm256_store_si256(out + i + 3, zero);
+  }
+}
+
+size_t mismatch(const uint8_t* a, const uint8_t* b, size_t length) {
+  const size_t end = length - length % block;
+
+  for (size_t i = 0; i < end; i += block) {
+    const __m256i va =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+    const __m256i vb =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+    const uint32_t equal = static_cast<uint32_t>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb)));
+
+    if (equal != 0xffffffff) {
+      return i + __builtin_ctz(~equal);
+    }
+  }
+
+  return end;
+}
+
+uint64_t sum32(const uint8_t* data, size_t length) {
+  const size_t end = length - length % block;
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i acc_lo = zero;
+  __m256i acc_hi = zero;
+
+  // Widen each 32-bit word into a 64-bit lane; the carries collect in the
+  // upper halves and get folded at the end.
+  for (size_t i = 0; i < end; i += block) {
+    const __m256i v =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+
+    acc_lo = _mm256_add_epi64(acc_lo, _mm256_unpacklo_epi32(v, zero));
+    acc_hi = _mm256_add_epi64(acc_hi, _mm256_unpackhi_epi32(v, zero));
+  }
+
+  alignas(32) uint64_t lanes[4];
+  _mm256_store_si256(reinterpret_cast<__m256i*>(lanes),
+                     _mm256_add_epi64(acc_lo, acc_hi));
+
+  return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+}  // namespace
+
+const Ops avx2_ops = {
+    .name = "avx2",
+    .block = block,
+    .copy_page = copy_page,
+    .clear_page = clear_page,
+    .mismatch = mismatch,
+    .sum32 = sum32,
+};
+}  // namespace arch::x86_64::simd
@@ -0,0 +1,103 @@
+#include <immintrin.h>
+
+#include "simd_internal.hpp"
+
+// Foundation subset only, so this also runs on parts without AVX512BW.
+#pragma GCC target("avx512f")
+
+namespace arch::x86_64::simd {
+namespace {
+constexpr size_t block = sizeof(__m512i);
+
+void copy_page(void* dest, const void* src) {
+  auto* out = static_cast<__m512i*>(dest);
+  const auto* in = static_cast<const __m512i*>(src);
+
+  for (size_t i = 0; i < SIMD_PAGE_SIZE / block; i += 4) {
+    const __m512i a = _mm512_load_si512(in + i);
+    const __m512i b = _mm512_load_si512(in + i + 1);
+    const __m512i c = _mm512_load_si512(in + i + 2);
+    const __m512i d = _mm512_load_si512(in + i + 3);
+
+    _mm512_store_si512(out + i, a);
+    _mm512_store_si512(out + i + 1, b);
+    _mm512_store_si512(out + i + 2, c);
+    _mm512_store_si512(out + i + 3, d);
+  }
+}
+
+void clear_page(void* dest) {
+  auto* out = static_cast<__m512i*>(dest);
+  const __m512i zero = _mm512_setzero_si512();
+
+  for (size_t i = 0; i < SIMD_PAGE_SIZE / block; i += 4) {
+    _mm512_store_si512(out + i, zero);
+    _mm512_store_si512(out + i + 1, zero);
+    _mm512_store_si512(out + i + 2, zero);
+    _mm512_store_si512(out + i + 3, zero);
+  }
+}
+
+size_t mismatch(const uint8_t* a, const uint8_t* b, size_t length) {
+  const size_t end = length - length % block;
+
+  for (size_t i = 0; i < end; i += block) {
+    const __m512i va = _mm512_loadu_si512(a + i);
+    const __m512i vb = _mm512_loadu_si512(b + i);
+    const __mmask16 differ = _mm512_cmpneq_epi32_mask(va, vb);
+
+    if (differ != 0) {
+      // Narrow the differing dword down to its first differing byte.
+      const size_t offset = i + 4 * __builtin_ctz(differ);
+      uint32_t wa = 0;
+      uint32_t wb = 0;
+      __builtin_memcpy(&wa, a + offset, sizeof(wa));
+      __builtin_memcpy(&wb, b + offset, sizeof(wb));
+
+      return offset + __builtin_ctz(wa ^ wb) / 8;
+    }
+  }
+
+  return end;
+}
+
+uint64_t sum32(const uint8_t* data, size_t length) {
+  const size_t end = length - length % block;
+  const __m512i zero = _mm512_setzero_si512();
+  __m512i acc_lo = zero;
+  __m512i acc_hi = zero;
+
+  for (size_t i = 0; i < end; i += block) {
+    const __m512i v = _mm512_loadu_si512(data + i);
+
+    // The zero-masked forms avoid GCC's spurious uninitialized warnings
+    // about the plain unpacks.
+    const __m512i lo = _mm512_maskz_unpacklo_epi32(~0, v, zero);
+    const __m512i hi = _mm512_maskz_unpackhi_epi32(~0, v, zero);
+
+    acc_lo = _mm512_add_epi64(acc_lo, lo);
+    acc_hi = _mm512_add_epi64(acc_hi, hi);
+  }
+
+  alignas(64) uint64_t lanes[8];
+  _mm512_store_si512(lanes, _mm512_add_epi64(acc_lo, acc_hi));
+
+  uint64_t sum = 0;
+
+  for (uint64_t lane : lanes) {
+    sum += lane;
+  }
+
+  return sum;
+}
+}  // namespace
+
+const Ops avx512_ops = {
+    .name = "avx512",
+    .block = block,
+    .copy_page = copy_page,
+    .clear_page = clear_page,
+    .mismatch = mismatch,
+    .sum32 = sum32,
+};
+}  // namespace arch::x86_64::simd
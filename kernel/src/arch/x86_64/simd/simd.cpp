@@ -0,0 +1,137 @@
+#include "arch/x86_64/simd/simd.hpp"
+#include "arch/x86_64/cpu/cpu.hpp"
+#include "arch/x86_64/cpu/fpu.hpp"
+#include "log.hpp"
+#include "simd_internal.hpp"
+
+#include <string.h>
+
+#include "arch/x86_64/registers.h"
+
+namespace arch::x86_64::simd {
+namespace {
+// nullptr until initialize() finds a usable vector unit.
+const Ops* vector_ops = nullptr;
+
+size_t scalar_mismatch(const uint8_t* a, const uint8_t* b, size_t length) {
+  size_t i = 0;
+
+  for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t)) {
+    uint64_t wa = 0;
+    uint64_t wb = 0;
+    __builtin_memcpy(&wa, a + i, sizeof(wa));
+    __builtin_memcpy(&wb, b + i, sizeof(wb));
+
+    if (wa != wb) {
+      return i + __builtin_ctzll(wa ^ wb) / 8;
+    }
+  }
+
+  for (; i < length; i++) {
+    if (a[i] != b[i]) {
+      return i;
+    }
+  }
+
+  return length;
+}
+
+uint64_t scalar_sum32(const uint8_t* data, size_t length) {
+  uint64_t sum = 0;
+  size_t i = 0;
+
+  for (; i + sizeof(uint32_t) <= length; i += sizeof(uint32_t)) {
+    uint32_t word = 0;
+    __builtin_memcpy(&word, data + i, sizeof(word));
+    sum += word;
+  }
+
+  if (i < length) {
+    uint32_t word = 0;
+    __builtin_memcpy(&word, data + i, length - i);
+    sum += word;
+  }
+
+  return sum;
+}
+
+uint16_t fold(uint64_t sum) {
+  sum = (sum & 0xffffffff) + (sum >> 32);
+  sum = (sum & 0xffffffff) + (sum >> 32);
+  sum = (sum & 0xffff) + (sum >> 16);
+  sum = (sum & 0xffff) + (sum >> 16);
+  return static_cast<uint16_t>(sum);
+}
+}  // namespace
+
+void copy_page(void* dest, const void* src) {
+  if (vector_ops != nullptr && cpu::kernel_fpu_begin()) {
+    vector_ops->copy_page(dest, src);
+    cpu::kernel_fpu_end();
+    return;
+  }
+
+  memcpy(dest, src, SIMD_PAGE_SIZE);
+}
+
+void clear_page(void* dest) {
+  if (vector_ops != nullptr && cpu::kernel_fpu_begin()) {
+    vector_ops->clear_page(dest);
+    cpu::kernel_fpu_end();
+    return;
+  }
+
+  memset(dest, 0, SIMD_PAGE_SIZE);
+}
+
+int compare(const void* a, const void* b, size_t length) {
+  const auto* pa = static_cast<const uint8_t*>(a);
+  const auto* pb = static_cast<const uint8_t*>(b);
+  size_t i = 0;
+
+  if (length >= SIMD_MIN_LENGTH && vector_ops != nullptr &&
+      cpu::kernel_fpu_begin()) {
+    i = vector_ops->mismatch(pa, pb, length);
+    cpu::kernel_fpu_end();
+  }
+
+  i += scalar_mismatch(pa + i, pb + i, length - i);
+
+  return i == length ? 0 : pa[i] - pb[i];
+}
+
+uint16_t checksum(const void* data, size_t length) {
+  const auto* p = static_cast<const uint8_t*>(data);
+  uint64_t sum = 0;
+  size_t i = 0;
+
+  if (length >= SIMD_MIN_LENGTH && vector_ops != nullptr &&
+      cpu::kernel_fpu_begin()) {
+    sum = vector_ops->sum32(p, length);
+    i = length - length % vector_ops->block;
+    cpu::kernel_fpu_end();
+  }
+
+  sum += scalar_sum32(p + i, length - i);
+
+  return fold(sum);
+}
+
+const char* implementation() {
+  return vector_ops != nullptr ? vector_ops->name : "scalar";
+}
+
+void initialize() {
+  const uint64_t xcr0 = cpu::fpu_features();
+
+  if ((xcr0 & XCR0_AVX512) == XCR0_AVX512 &&
+      cpu::test_feature(FEATURE_AVX512F)) {
+    vector_ops = &avx512_ops;
+  } else if ((xcr0 & XCR0_AVX) && cpu::test_feature(FEATURE_AVX2)) {
+    vector_ops = &avx2_ops;
+  }
+
+  log_info(CPU, "[SIMD] Using %s page copy, compare and checksum",
+           implementation());
+}
+}  // namespace arch::x86_64::simd
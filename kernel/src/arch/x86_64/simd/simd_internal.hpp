@@ -0,0 +1,30 @@
+#ifndef ARCH_SIMD_INTERNAL_HPP
+#define ARCH_SIMD_INTERNAL_HPP 1
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SIMD_PAGE_SIZE 4096
+
+namespace arch::x86_64::simd {
+// One implementation. Each lives in its own translation unit built for its
+// instruction set, and is only called inside an FPU section.
+struct Ops {
+  const char* name;
+  // Bytes per vector. mismatch() and sum32() only look at the first
+  // `length - length % block` bytes and leave the rest to the caller.
+  size_t block;
+
+  void (*copy_page)(void* dest, const void* src);
+  void (*clear_page)(void* dest);
+  // Offset of the first differing byte, or the number of bytes looked at.
+  size_t (*mismatch)(const uint8_t* a, const uint8_t* b, size_t length);
+  // Sum of the little-endian 32-bit words, before folding.
+  uint64_t (*sum32)(const uint8_t* data, size_t length);
+};
+
+extern const Ops avx2_ops;
+extern const Ops avx512_ops;
+}  // namespace arch::x86_64::simd
+
+#endif  // ARCH_SIMD_INTERNAL_HPP
@@ -0,0 +1,155 @@
+#include "arch/x86_64/cpu/apic.hpp"
+#include "arch/x86_64/cpu/cpu.hpp"
+#include "arch/x86_64/cpu/exceptions.hpp"
+#include "arch/x86_64/cpu/io.hpp"
+#include "arch/x86_64/timer/tsc.hpp"
+#include "log.hpp"
+
+#include "arch/x86_64/registers.h"
+
+// PIT input clock, used as the calibration reference of last resort.
+#define PIT_FREQUENCY 1193182ull
+// Length of one PIT calibration window (1 / 20 s = 50 ms).
+#define PIT_CALIBRATION_DIVISOR 20
+#define PIT_CALIBRATION_RUNS 3
+
+namespace timer::arch::x86_64 {
+using namespace ::arch::x86_64;
+
+namespace {
+enum PitPorts : uint16_t {
+  PitChannel2 = 0x42,
+  PitCommand = 0x43,
+  PitGate = 0x61,
+};
+
+enum PitGateBits : uint8_t {
+  PitGateEnable = (1u << 0),
+  PitSpeakerEnable = (1u << 1),
+  PitOutputHigh = (1u << 5),
+};
+
+uint64_t frequency = 0;
+EventHandler event_handler = nullptr;
+
+// CPUID 0x15 reports the TSC/crystal ratio and, on most parts, the crystal
+// frequency itself.
+uint64_t frequency_from_cpuid() {
+  const cpu::CpuidLeaf* tsc_leaf = cpu::get_leaf(cpu::CpuidTSC);
+
+  if ((tsc_leaf != nullptr) && (tsc_leaf->a != 0) && (tsc_leaf->b != 0) &&
+      (tsc_leaf->c != 0)) {
+    return (static_cast<uint64_t>(tsc_leaf->c) * tsc_leaf->b) / tsc_leaf->a;
+  }
+
+  // CPUID 0x16 (processor base frequency in MHz) is only a nominal value.
+  const cpu::CpuidLeaf* freq_leaf =
+      cpu::get_leaf(static_cast<cpu::CpuidLeafNum>(0x16));
+
+  if ((freq_leaf != nullptr) && ((freq_leaf->a & 0xffff) != 0)) {
+    return static_cast<uint64_t>(freq_leaf->a & 0xffff) * 1000000ull;
+  }
+
+  return 0;
+}
+
+// Count TSC ticks across a PIT channel 2 one-shot countdown.
+uint64_t frequency_from_pit() {
+  constexpr uint16_t latch = PIT_FREQUENCY / PIT_CALIBRATION_DIVISOR;
+  uint64_t best = UINT64_MAX;
+
+  for (int run = 0; run < PIT_CALIBRATION_RUNS; ++run) {
+    // Gate channel 2 on, keep the speaker disconnected.
+    uint8_t gate = cpu::in<uint8_t>(PitGate);
+    gate = (gate & ~PitSpeakerEnable) | PitGateEnable;
+    cpu::out<uint8_t>(PitGate, gate);
+
+    // Channel 2, lobyte/hibyte access, mode 0 (interrupt on terminal count).
+    cpu::out<uint8_t>(PitCommand, 0xb0);
+    cpu::out<uint8_t>(PitChannel2, latch & 0xff);
+    cpu::out<uint8_t>(PitChannel2, latch >> 8);
+
+    const uint64_t start = cpu::read_tsc();
+
+    while (!(cpu::in<uint8_t>(PitGate) & PitOutputHigh)) {
+      cpu::pause();
+    }
+
+    const uint64_t elapsed = cpu::read_tsc() - start;
+
+    // The shortest window had the fewest SMIs/VM exits folded into it.
+    best = (elapsed < best) ? elapsed : best;
+  }
+
+  return best * PIT_CALIBRATION_DIVISOR;
+}
+
+void deadline_handler(uint8_t) {
+  if (event_handler != nullptr) {
+    event_handler();
+  }
+}
+}  // namespace
+
+uint64_t initialize() {
+  if (!cpu::test_feature(FEATURE_INVAR_TSC)) {
+    warning("[TSC] TSC is not invariant, timestamps may drift");
+  }
+
+  const char* source = "cpuid";
+  frequency = frequency_from_cpuid();
+
+  if (frequency == 0) {
+    source = "pit";
+    frequency = frequency_from_pit();
+  }
+
+  info("[TSC] Frequency: %lu.%06lu MHz (source: %s)", frequency / 1000000,
+       frequency % 1000000, source);
+  return frequency;
+}
+
+bool enable_events(EventHandler handler) {
+  if (!cpu::test_feature(FEATURE_TSC_DEADLINE)) {
+    warning("[TSC] TSC-deadline mode not supported, timer events disabled");
+    return false;
+  }
+
+  if (!cpu::Apic::is_enabled()) {
+    warning("[TSC] Local APIC unavailable, timer events disabled");
+    return false;
+  }
+
+  if (event_handler == nullptr) {
+    cpu::InterruptHandler& irq =
+        cpu::allocate_handler(cpu::interruptApicTimer);
+
+    // Timer expiries are the hottest interrupt in the system, so they take
+    // the fast stub; the EOI is issued from there.
+    if ((irq.get_vector() != cpu::interruptApicTimer) ||
+        !cpu::install_fast_handler(irq, deadline_handler)) {
+      err("[TSC] APIC timer vector %u is already taken",
+          cpu::interruptApicTimer);
+      return false;
+    }
+  }
+
+  event_handler = handler;
+  cpu::Apic::enable_tsc_deadline(cpu::interruptApicTimer);
+
+  return true;
+}
+
+uint64_t counter_frequency() {
+  return frequency;
+}
+
+void set_deadline(uint64_t counter) {
+  // A deadline of zero disarms the timer, so never program it by accident.
+  cpu::write_msr(MSR_TSC_DEADLINE, (counter != 0) ? counter : 1);
+}
+
+void clear_deadline() {
+  cpu::write_msr(MSR_TSC_DEADLINE, 0);
+}
+}  // namespace timer::arch::x86_64
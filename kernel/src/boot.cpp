@@ -1,6 +1,8 @@
 #include "boot.hpp"
 #include "limine.h"
 
+#include <string.h>
+
 namespace boot {
 // clang-format off
 __attribute__((used)) __attribute__((section(".requests")))
@@ -50,4 +52,45 @@ static volatile LIMINE_REQUESTS_START_MARKER;
 __attribute__((used)) __attribute__((section(".requests_end")))
 static volatile LIMINE_REQUESTS_END_MARKER;
 // clang-format on
+
+const char* cmdline_option(const char* name, size_t* length) {
+  if (file_request.response == nullptr) {
+    return nullptr;
+  }
+
+  const char* word = file_request.response->executable_file->cmdline;
+  const size_t name_length = strlen(name);
+
+  while (word != nullptr && *word != '\0') {
+    while (*word == ' ') {
+      word++;
+    }
+
+    const char* end = strchr(word, ' ');
+    const size_t word_length =
+        (end != nullptr) ? static_cast<size_t>(end - word) : strlen(word);
+
+    if (word_length >= name_length && strncmp(word, name, name_length) == 0) {
+      if (word_length == name_length) {
+        if (length != nullptr) {
+          *length = 0;
+        }
+
+        return word + word_length;
+      }
+
+      if (word[name_length] == '=') {
+        if (length != nullptr) {
+          *length = word_length - name_length - 1;
+        }
+
+        return word + name_length + 1;
+      }
+    }
+
+    word = end;
+  }
+
+  return nullptr;
+}
 }  // namespace boot
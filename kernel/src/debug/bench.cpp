@@ -0,0 +1,174 @@
+#include "debug/bench.hpp"
+#include "arch/arch.hpp"
+#include "arch/timer.hpp"
+#include "boot.hpp"
+#include "log.hpp"
+#include "timer/clock.hpp"
+
+#include <string.h>
+
+#include <algorithm>
+
+// Placed by the linker script around the .bench section.
+extern "C" const debug::Benchmark __bench_start[];
+extern "C" const debug::Benchmark __bench_end[];
+
+namespace debug {
+namespace {
+// Cost of the timestamp pair itself, taken off every batch.
+uint64_t timing_overhead = 0;
+
+void empty_benchmark(BenchState&) {
+}
+
+// One batch with interrupts off, so no tick lands in the timed region.
+// Returns the cycles spent, less paused time and the timing overhead.
+uint64_t run_batch(const Benchmark& bench, size_t iterations,
+                   size_t* bytes = nullptr) {
+  BenchState state(iterations);
+  const bool interrupts = arch::int_status();
+
+  arch::int_switch(false);
+
+  const uint64_t start = arch::cycles_begin();
+  bench.func(state);
+  const uint64_t end = arch::cycles_end();
+
+  arch::int_switch(interrupts);
+
+  if (bytes != nullptr) {
+    *bytes = state.get_bytes();
+  }
+
+  const uint64_t spent = end - start - state.excluded_cycles();
+  return (spent > timing_overhead) ? spent - timing_overhead : 0;
+}
+
+void measure_overhead() {
+  const Benchmark empty = {"empty", empty_benchmark};
+
+  timing_overhead = 0;
+  uint64_t best = run_batch(empty, 1);
+
+  for (int i = 1; i < BENCH_REPEATS * 4; ++i) {
+    best = std::min(best, run_batch(empty, 1));
+  }
+
+  timing_overhead = best;
+}
+
+// Cycles per batch of about BENCH_BATCH_NS. The benchmark timestamps and
+// the clock read the same counter; without a calibrated clock assume 1 GHz.
+uint64_t batch_cycles() {
+  const uint64_t frequency = timer::arch::counter_frequency();
+
+  if (frequency == 0) {
+    return BENCH_BATCH_NS;
+  }
+
+  return frequency * BENCH_BATCH_NS / NS_PER_SEC;
+}
+
+// Double the iteration count until a batch takes a sixteenth of the target,
+// then scale it up to the whole target.
+size_t calibrate(const Benchmark& bench, uint64_t target) {
+  size_t iterations = 1;
+  uint64_t spent = run_batch(bench, iterations);
+
+  while (spent < target / 16 && iterations < (SIZE_MAX >> 1)) {
+    iterations *= 2;
+    spent = run_batch(bench, iterations);
+  }
+
+  return std::max<size_t>(
+      1, static_cast<unsigned __int128>(iterations) * target / (spent + 1));
+}
+
+// Per-iteration value of `total` in hundredths, for two-decimal output
+// without touching the FPU.
+uint64_t hundredths(uint64_t total, size_t iterations) {
+  return static_cast<uint64_t>(static_cast<unsigned __int128>(total) * 100 /
+                               iterations);
+}
+
+void run_one(const Benchmark& bench, uint64_t target) {
+  const size_t iterations = calibrate(bench, target);
+  uint64_t samples[BENCH_REPEATS];
+  size_t bytes = 0;
+
+  for (uint64_t& sample : samples) {
+    sample = run_batch(bench, iterations, &bytes);
+  }
+
+  std::sort(samples, samples + BENCH_REPEATS);
+
+  const uint64_t best = hundredths(samples[0], iterations);
+  const uint64_t median = hundredths(samples[BENCH_REPEATS / 2], iterations);
+  const uint64_t ns = hundredths(timer::counter_delta_to_ns(samples[0]),
+                                 iterations);
+
+  char line[LOG_LINE_MAX];
+  format::buffer_sink sink(line, sizeof(line));
+
+  format::format_printf<"bench: name=%s iterations=%lu cycles=%lu.%02lu "
+                        "cycles_median=%lu.%02lu ns=%lu.%02lu">(
+      sink, bench.name, iterations, best / 100, best % 100, median / 100,
+      median % 100, ns / 100, ns % 100);
+
+  if (bytes != 0 && ns != 0) {
+    // Bytes per nanosecond is GB/s; ns is in hundredths.
+    const uint64_t mb_per_sec = bytes * 100 * 1000 / ns;
+    format::format_printf<" bytes=%lu mb_s=%lu">(sink, bytes, mb_per_sec);
+  }
+
+  sink.append('\n');
+  sink.finish();
+
+  // One write, so the line never interleaves with log output.
+  log::write_console(line);
+  arch::write_flush();
+}
+}  // namespace
+
+size_t run_benchmarks(const char* prefix, size_t prefix_length) {
+  if (!arch::has_ordered_cycles()) {
+    log::print<"bench: error=no-rdtscp\n">();
+    return 0;
+  }
+
+  const uint64_t target = batch_cycles();
+  size_t count = 0;
+
+  measure_overhead();
+  log::print<"bench: begin counter_hz=%lu overhead_cycles=%lu\n">(
+      timer::arch::counter_frequency(), timing_overhead);
+
+  for (const Benchmark* bench = __bench_start; bench != __bench_end;
+       ++bench) {
+    if (strncmp(bench->name, prefix, prefix_length) != 0) {
+      continue;
+    }
+
+    run_one(*bench, target);
+    count++;
+  }
+
+  log::print<"bench: end count=%lu\n">(count);
+  arch::write_flush();
+  return count;
+}
+
+void run_boot_benchmarks() {
+  size_t length = 0;
+  const char* prefix = boot::cmdline_option("bench", &length);
+  size_t count = 0;
+
+  if (prefix != nullptr) {
+    count = run_benchmarks(prefix, length);
+  }
+
+  if (boot::cmdline_option("bench_exit") != nullptr) {
+    arch::exit_emulator((count != 0) ? 0 : 1);
+  }
+}
+}  // namespace debug
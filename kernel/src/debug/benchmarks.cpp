@@ -0,0 +1,137 @@
+// Boot-time benchmarks of the hot kernel paths; see debug/bench.hpp.
+
+#include "arch/arch.hpp"
+#include "debug/bench.hpp"
+#include "memory/memory.hpp"
+#include "memory/pagemap.hpp"
+#include "memory/physical.hpp"
+#include "spinlock.hpp"
+
+#include <string.h>
+
+// An unused address in the lower half, for the private page map.
+#define BENCH_MAP_ADDR 0x0000400000000000ull
+
+namespace debug {
+namespace {
+alignas(memory::PageSize4KiB) uint8_t src_page[memory::PageSize4KiB];
+alignas(memory::PageSize4KiB) uint8_t dest_page[memory::PageSize4KiB];
+uint8_t* const src = src_page;
+uint8_t* const dest = dest_page;
+
+// Keep the compiler from dropping a result or hoisting work out of a loop.
+template <typename T>
+inline void keep(const T& value) {
+  asm volatile("" ::"r,m"(value) : "memory");
+}
+
+template <size_t Bytes>
+void pmm_alloc_free(BenchState& state) {
+  memory::PhysicalMemoryManager& pmm =
+      memory::PhysicalMemoryManager::instance();
+
+  for (size_t i = 0; i < state.iterations(); ++i) {
+    pmm.deallocate(pmm.allocate(Bytes));
+  }
+}
+
+BENCHMARK("pmm/alloc-free/4k", pmm_alloc_free<memory::PageSize4KiB>);
+BENCHMARK("pmm/alloc-free/64k", pmm_alloc_free<16 * memory::PageSize4KiB>);
+
+// Map and unmap one page of a page map nobody loads. The intermediate tables
+// stay after the first map, so this is the leaf update and its invalidation.
+void pagemap_map_unmap(BenchState& state) {
+  static libs::Lazy<memory::PageMap> pagemap;
+  static uintptr_t phys = 0;
+
+  if (!pagemap.valid()) {
+    pagemap.initialize();
+    phys = memory::PhysicalMemoryManager::instance().allocate<uintptr_t>(
+        memory::PageSize4KiB);
+  }
+
+  for (size_t i = 0; i < state.iterations(); ++i) {
+    keep(pagemap->map(BENCH_MAP_ADDR, phys, memory::PageSize4KiB,
+                      memory::FlagRw));
+    keep(pagemap->unmap(BENCH_MAP_ADDR, memory::PageSize4KiB));
+  }
+}
+
+BENCHMARK("pagemap/map-unmap", pagemap_map_unmap);
+
+// Uncontended acquire and release.
+template <typename Lock>
+void lock_unlock(BenchState& state) {
+  static Lock lock{"bench"};
+
+  for (size_t i = 0; i < state.iterations(); ++i) {
+    lock.lock();
+    lock.unlock();
+  }
+}
+
+BENCHMARK("lock/spin", lock_unlock<libs::SpinLock>);
+BENCHMARK("lock/irq", lock_unlock<libs::IrqLock>);
+BENCHMARK("lock/queued", lock_unlock<libs::QueuedLock>);
+BENCHMARK("lock/queued-irq", lock_unlock<libs::QueuedIrqLock>);
+
+template <size_t Bytes>
+void bench_memcpy(BenchState& state) {
+  state.set_bytes(Bytes);
+
+  for (size_t i = 0; i < state.iterations(); ++i) {
+    keep(dest);
+    memcpy(dest, src, Bytes);
+  }
+}
+
+template <size_t Bytes>
+void bench_memset(BenchState& state) {
+  state.set_bytes(Bytes);
+
+  for (size_t i = 0; i < state.iterations(); ++i) {
+    keep(dest);
+    memset(dest, 0, Bytes);
+  }
+}
+
+template <size_t Bytes>
+void bench_memcmp(BenchState& state) {
+  state.set_bytes(Bytes);
+  memcpy(dest, src, Bytes);
+
+  for (size_t i = 0; i < state.iterations(); ++i) {
+    keep(dest);
+    keep(memcmp(dest, src, Bytes));
+  }
+}
+
+BENCHMARK("mem/memcpy/64", bench_memcpy<64>);
+BENCHMARK("mem/memcpy/4096", bench_memcpy<4096>);
+BENCHMARK("mem/memset/64", bench_memset<64>);
+BENCHMARK("mem/memset/4096", bench_memset<4096>);
+BENCHMARK("mem/memcmp/64", bench_memcmp<64>);
+BENCHMARK("mem/memcmp/4096", bench_memcmp<4096>);
+
+void bench_copy_page(BenchState& state) {
+  state.set_bytes(memory::PageSize4KiB);
+
+  for (size_t i = 0; i < state.iterations(); ++i) {
+    keep(dest);
+    arch::copy_page(dest, src);
+  }
+}
+
+void bench_clear_page(BenchState& state) {
+  state.set_bytes(memory::PageSize4KiB);
+
+  for (size_t i = 0; i < state.iterations(); ++i) {
+    keep(dest);
+    arch::clear_page(dest);
+  }
+}
+
+BENCHMARK("mem/copy_page", bench_copy_page);
+BENCHMARK("mem/clear_page", bench_clear_page);
+}  // namespace
+}  // namespace debug
@@ -0,0 +1,32 @@
+#include "debug/lockstat.hpp"
+#include "lockstat.hpp"
+#include "log.hpp"
+
+namespace debug {
+#if NOISE_DEBUG
+void print_lock_stats(size_t top) {
+  libs::LockClassStats stats[LOCKSTAT_MAX_CLASSES];
+
+  if (top > LOCKSTAT_MAX_CLASSES) {
+    top = LOCKSTAT_MAX_CLASSES;
+  }
+
+  const size_t count = libs::get_lock_stats(stats, top);
+
+  info("[LOCKSTAT] %-14s %10s %10s %12s %12s %12s %12s", "class", "acquired",
+       "contended", "avg wait", "max wait", "avg hold", "max hold");
+
+  for (size_t i = 0; i < count; ++i) {
+    const libs::LockClassStats& curr = stats[i];
+    const uint64_t acquisitions = (curr.acquisitions != 0) ? curr.acquisitions
+                                                           : 1;
+    const uint64_t contended = (curr.contended != 0) ? curr.contended : 1;
+
+    info("[LOCKSTAT] %-14s %10lu %10lu %12lu %12lu %12lu %12lu", curr.name,
+         curr.acquisitions, curr.contended, curr.wait_cycles / contended,
+         curr.max_wait_cycles, curr.hold_cycles / acquisitions,
+         curr.max_hold_cycles);
+  }
+}
+#endif
+}  // namespace debug
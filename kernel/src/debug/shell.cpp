@@ -0,0 +1,292 @@
+#include "debug/shell.hpp"
+#include "arch/arch.hpp"
+#include "debug/bench.hpp"
+#include "debug/lockstat.hpp"
+#include "irq/softirq.hpp"
+#include "log.hpp"
+#include "memory/memory.hpp"
+#include "memory/physical.hpp"
+#include "rcu/rcu.hpp"
+#include "sched/thread.hpp"
+#include "sched/workqueue.hpp"
+#include "timer/clock.hpp"
+#include "timer/hrtimer.hpp"
+#include "timer/tick.hpp"
+
+namespace debug {
+namespace {
+sched::Thread* shell_thread = nullptr;
+
+struct Command {
+  const char* name;
+  const char* help;
+  void (*func)(const char* args);
+};
+
+void input_ready(void*) {
+  shell_thread->wake();
+}
+
+// CPUs that never ticked were never brought up.
+bool cpu_online(uint32_t cpu) {
+  return (cpu == 0) || (timer::get_tick_stats(cpu).ticks != 0);
+}
+
+const char* skip_spaces(const char* str) {
+  while (*str == ' ') {
+    str++;
+  }
+
+  return str;
+}
+
+// Length of the first word of `str`.
+size_t word_length(const char* str) {
+  size_t length = 0;
+
+  while ((str[length] != '\0') && (str[length] != ' ')) {
+    length++;
+  }
+
+  return length;
+}
+
+bool word_equals(const char* word, size_t length, const char* name) {
+  for (size_t i = 0; i < length; ++i) {
+    if (name[i] != word[i]) {
+      return false;
+    }
+  }
+
+  return name[length] == '\0';
+}
+
+void cmd_help(const char* args);
+
+void cmd_pmm(const char*) {
+  const memory::PhysicalMemoryStats stats =
+      memory::PhysicalMemoryManager::instance().get_stats();
+
+  log::print<"total %lu KiB, free %lu KiB\n">(stats.total_memory / 1024,
+                                              stats.free_memory / 1024);
+
+  for (int order = MIN_ORDER; order <= MAX_ORDER; ++order) {
+    if (stats.free_blocks[order] != 0) {
+      log::print<"  order %2d: %6lu free blocks of %lu KiB\n">(
+          order, stats.free_blocks[order],
+          (memory::PageSize4KiB << order) / 1024);
+    }
+  }
+}
+
+void cmd_freelist(const char*) {
+  memory::PhysicalMemoryManager::instance().print();
+}
+
+void cmd_locks(const char* args) {
+#if NOISE_DEBUG
+  size_t top = 0;
+
+  for (; (*args >= '0') && (*args <= '9'); ++args) {
+    top = (top * 10) + (*args - '0');
+  }
+
+  print_lock_stats((top != 0) ? top : 10);
+#else
+  (void)args;
+  log::print<"lock statistics need a NOISE_DEBUG build\n">();
+#endif
+}
+
+void cmd_cpus(const char*) {
+  log::print<"cpu %10s %10s %10s %10s %10s %10s\n">(
+      "softirq", "rcu-gp", "rcu-queued", "rcu-done", "wq-exec", "workers");
+
+  for (uint32_t cpu = 0; cpu < MAX_CPUS; ++cpu) {
+    if (!cpu_online(cpu)) {
+      continue;
+    }
+
+    uint64_t softirqs = 0;
+
+    for (int vector = 0; vector < irq::softirqMax; ++vector) {
+      softirqs +=
+          irq::get_softirq_stats(cpu, static_cast<irq::SoftirqVector>(vector))
+              .count;
+    }
+
+    const rcu::RcuStats rcu = rcu::get_stats(cpu);
+    const sched::WorkerPoolStats pool = sched::get_pool_stats(cpu);
+
+    log::print<"%3u %10lu %10lu %10lu %10lu %10lu %10lu\n">(
+        cpu, softirqs, rcu.grace_periods, rcu.queued, rcu.invoked,
+        pool.executed, pool.workers);
+  }
+
+  const sched::WorkerPoolStats unbound = sched::get_unbound_pool_stats();
+  log::print<"unbound workqueue: executed %lu workers %lu\n">(
+      unbound.executed, unbound.workers);
+}
+
+void cmd_timer(const char*) {
+  const uint64_t now = timer::now();
+
+  log::print<"uptime %llu.%09llu s, jiffies %lu, hrtimers %s\n">(
+      now / NS_PER_SEC, now % NS_PER_SEC, timer::get_jiffies(),
+      timer::hrtimers_enabled() ? "on" : "off");
+  log::print<"cpu %10s %14s %10s %10s\n">("ticks", "idle ms", "idle", "stops");
+
+  for (uint32_t cpu = 0; cpu < MAX_CPUS; ++cpu) {
+    if (!cpu_online(cpu)) {
+      continue;
+    }
+
+    const timer::TickStats stats = timer::get_tick_stats(cpu);
+
+    log::print<"%3u %10lu %14llu %10lu %10lu\n">(
+        cpu, stats.ticks, stats.idle_ns / NS_PER_MSEC, stats.idle_entries,
+        stats.tick_stops);
+  }
+}
+
+// log <category> on|off, or no arguments to list the categories.
+void cmd_log(const char* args) {
+  const char* name = args;
+  const size_t name_length = word_length(name);
+  const char* state = skip_spaces(name + name_length);
+  const size_t state_length = word_length(state);
+
+  const uint32_t mask = log::category_mask.load(std::memory_order_relaxed);
+
+  for (uint8_t i = 0; i < log::CATEGORY_MAX; ++i) {
+    const log::category cat = static_cast<log::category>(i);
+
+    if (name_length == 0) {
+      log::print<"%-8s %s\n">(log::category_name(cat),
+                               (mask & (1U << i)) ? "on" : "off");
+      continue;
+    }
+
+    if (!word_equals(name, name_length, log::category_name(cat))) {
+      continue;
+    }
+
+    if (word_equals(state, state_length, "on")) {
+      log::set_category_enabled(cat, true);
+    } else if (word_equals(state, state_length, "off")) {
+      log::set_category_enabled(cat, false);
+    } else {
+      log::print<"usage: log <category> on|off\n">();
+    }
+
+    return;
+  }
+
+  if (name_length != 0) {
+    log::print<"unknown log category '%.*s'\n">(
+        static_cast<int>(name_length), name);
+  }
+}
+
+void cmd_bench(const char* args) {
+  if (run_benchmarks(args, word_length(args)) == 0) {
+    log::print<"no benchmark matches '%s'\n">(args);
+  }
+}
+
+constexpr Command commands[] = {
+    {"help", "list commands", cmd_help},
+    {"pmm", "free memory per buddy order", cmd_pmm},
+    {"freelist", "dump the PMM free lists", cmd_freelist},
+    {"locks", "[n] lock classes by wait time", cmd_locks},
+    {"cpus", "per-CPU softirq, RCU and workqueue counters", cmd_cpus},
+    {"timer", "clock, jiffies and tick state", cmd_timer},
+    {"log", "[category on|off] runtime log mask", cmd_log},
+    {"bench", "[prefix] run the boot benchmarks", cmd_bench},
+};
+
+void cmd_help(const char*) {
+  for (const Command& command : commands) {
+    log::print<"%-9s %s\n">(command.name, command.help);
+  }
+}
+
+void execute(const char* line) {
+  line = skip_spaces(line);
+
+  const size_t length = word_length(line);
+
+  if (length == 0) {
+    return;
+  }
+
+  for (const Command& command : commands) {
+    if (word_equals(line, length, command.name)) {
+      command.func(skip_spaces(line + length));
+      return;
+    }
+  }
+
+  log::print<"unknown command '%.*s', try 'help'\n">(
+      static_cast<int>(length), line);
+}
+
+void shell_main(void*) {
+  char line[SHELL_LINE_MAX + 1];
+  size_t length = 0;
+  char last = 0;
+
+  log::write_console("> ");
+
+  while (true) {
+    char ch = 0;
+
+    if (arch::read(&ch, 1) == 0) {
+      sched::block();
+      continue;
+    }
+
+    // Terminals end lines with "\r\n", "\r" or "\n"; run once per line.
+    const bool crlf = (last == '\r') && (ch == '\n');
+    last = ch;
+
+    if (crlf) {
+      continue;
+    }
+
+    if ((ch == '\r') || (ch == '\n')) {
+      log::write_console("\n");
+
+      line[length] = '\0';
+      execute(line);
+      length = 0;
+
+      // Commands that log go through klogd; let it print them.
+      log::kick();
+      log::write_console("> ");
+    } else if ((ch == '\b') || (ch == 0x7f)) {
+      if (length != 0) {
+        length--;
+        log::write_console("\b \b");
+      }
+    } else if ((ch >= ' ') && (ch <= '~') && (length < SHELL_LINE_MAX)) {
+      const char echo[] = {ch, '\0'};
+
+      line[length++] = ch;
+      log::write_console(echo);
+    }
+  }
+}
+}  // namespace
+
+void initialize_shell() {
+  shell_thread = sched::create_thread("kshell", shell_main, nullptr);
+
+  if (shell_thread == nullptr) {
+    warning("[SHELL] Failed to start the debug shell");
+    return;
+  }
+
+  arch::set_input_notify(input_ready, nullptr);
+}
+}  // namespace debug
@@ -1,4 +1,5 @@
 #include "drivers/manager.hpp"
+#include "rcu/rcu.hpp"
 
 // static for now
 #define MAX_DRIVERS 10
@@ -17,14 +18,31 @@ inline size_t allocate_driver_id() {
 size_t install(IDriver *driver) {
   const size_t device_id = allocate_driver_id();
   driver->set_driver_id(device_id);
-  drivers[device_id] = driver;
+  rcu::assign_pointer(drivers[device_id], driver);
 
   return device_id;
 }
 
 void uninstall(IDriver *driver) {
-  // TODO: Match the driver signature and remove from the hashmap.
-  // TODO: Implement after virtual allocation is supported.
+  for (size_t i = 0; i < total_drivers; i++) {
+    if (drivers[i] != driver) {
+      continue;
+    }
+
+    // Readers inside find() may still hold the pointer; wait them out
+    // before the caller gets to tear the driver down.
+    rcu::assign_pointer(drivers[i], nullptr);
+    rcu::synchronize();
+    return;
+  }
+}
+
+IDriver *find(size_t driver_id) {
+  if (driver_id >= MAX_DRIVERS) {
+    return nullptr;
+  }
+
+  return rcu::dereference(drivers[driver_id]);
 }
 
 void initialize() {
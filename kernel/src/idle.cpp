@@ -0,0 +1,35 @@
+#include "arch/arch.hpp"
+#include "idle.hpp"
+#include "log.hpp"
+#include "sched/thread.hpp"
+#include "timer/tick.hpp"
+
+namespace idle {
+void run() {
+  while (true) {
+    // Run threads until every one of them is blocked again.
+    sched::schedule();
+
+    // Print buffered log records while there is nothing else to do.
+    log::kick();
+
+    // The tick decision and the halt must see the same timer state, so
+    // interrupts stay off until `arch::idle()` atomically re-enables them.
+    arch::int_switch(false);
+
+    // A wakeup may have come in since schedule() returned.
+    if (sched::has_runnable()) {
+      arch::int_switch(true);
+      continue;
+    }
+
+    timer::idle_enter();
+
+    arch::idle();
+
+    arch::int_switch(false);
+    timer::idle_exit();
+    arch::int_switch(true);
+  }
+}
+}  // namespace idle
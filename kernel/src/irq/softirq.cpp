@@ -0,0 +1,154 @@
+#include "arch/arch.hpp"
+#include "irq/softirq.hpp"
+#include "irq/tasklet.hpp"
+#include "log.hpp"
+#include "sched/thread.hpp"
+#include "timer/clock.hpp"
+
+#include <printf/printf.h>
+
+namespace irq {
+namespace {
+struct SoftirqState {
+  uint32_t pending;
+  bool active;
+
+  sched::Thread* ksoftirqd;
+  // Times interrupt exit ran out of budget and deferred to ksoftirqd.
+  uint64_t deferred;
+
+  SoftirqStats stats[softirqMax];
+};
+
+SoftirqHandler handlers[softirqMax];
+SoftirqState states[MAX_CPUS];
+
+SoftirqState& local_state() {
+  return states[::arch::cpu_id()];
+}
+
+// Runs with interrupts disabled on entry and exit; individual handlers run
+// with them enabled. Returns true if work was left for later.
+bool process(SoftirqState& state) {
+  const uint64_t start = timer::now();
+  int restarts = SOFTIRQ_MAX_RESTART;
+
+  state.active = true;
+
+  uint32_t pending = state.pending;
+  while (pending != 0) {
+    state.pending = 0;
+    ::arch::int_switch(true);
+
+    while (pending != 0) {
+      const int vector = __builtin_ctz(pending);
+      pending &= pending - 1;
+
+      const uint64_t begin = timer::now();
+      handlers[vector]();
+      const uint64_t elapsed = timer::now() - begin;
+
+      SoftirqStats& stats = state.stats[vector];
+      stats.count++;
+      stats.total_ns += elapsed;
+      stats.max_ns = (elapsed > stats.max_ns) ? elapsed : stats.max_ns;
+    }
+
+    ::arch::int_switch(false);
+    pending = state.pending;
+
+    if ((--restarts == 0) || ((timer::now() - start) >= SOFTIRQ_MAX_NS)) {
+      break;
+    }
+  }
+
+  state.active = false;
+  return state.pending != 0;
+}
+
+void ksoftirqd(void*) {
+  SoftirqState& state = local_state();
+
+  while (true) {
+    ::arch::int_switch(false);
+
+    if ((state.pending == 0) || state.active) {
+      ::arch::int_switch(true);
+      sched::block();
+      continue;
+    }
+
+    process(state);
+    ::arch::int_switch(true);
+
+    // Let everything else run between batches.
+    sched::yield();
+  }
+}
+}  // namespace
+
+void register_softirq(SoftirqVector vector, SoftirqHandler handler) {
+  if (handlers[vector] != nullptr) {
+    panic("[SOFTIRQ] Vector %u registered twice", vector);
+  }
+
+  handlers[vector] = handler;
+}
+
+void raise_softirq(SoftirqVector vector) {
+  const bool state = ::arch::int_status();
+  ::arch::int_switch(false);
+
+  SoftirqState& softirq = local_state();
+  softirq.pending |= (1u << vector);
+
+  // With interrupts on we are not in a handler, so no interrupt exit is
+  // coming to pick this up.
+  if (state && !softirq.active && (softirq.ksoftirqd != nullptr)) {
+    softirq.ksoftirqd->wake();
+  }
+
+  ::arch::int_switch(state);
+}
+
+void exit() {
+  SoftirqState& state = local_state();
+
+  if ((state.pending == 0) || state.active) {
+    return;
+  }
+
+  if (process(state) && (state.ksoftirqd != nullptr)) {
+    state.deferred++;
+    state.ksoftirqd->wake();
+  }
+}
+
+bool in_softirq() {
+  return local_state().active;
+}
+
+SoftirqStats get_softirq_stats(uint32_t cpu, SoftirqVector vector) {
+  if ((cpu >= MAX_CPUS) || (vector >= softirqMax)) {
+    return {};
+  }
+
+  return states[cpu].stats[vector];
+}
+
+void initialize() {
+  const uint32_t cpu = ::arch::cpu_id();
+  char name[THREAD_NAME_LENGTH];
+
+  initialize_tasklets();
+
+  snprintf(name, sizeof(name), "ksoftirqd/%u", cpu);
+  states[cpu].ksoftirqd = sched::create_thread(name, ksoftirqd, nullptr);
+
+  if (states[cpu].ksoftirqd == nullptr) {
+    panic("[SOFTIRQ] Failed to start %s", name);
+  }
+
+  info("[SOFTIRQ] Initialized, %d vectors", softirqMax);
+}
+}  // namespace irq
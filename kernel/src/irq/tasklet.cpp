@@ -0,0 +1,68 @@
+#include "arch/arch.hpp"
+#include "irq/softirq.hpp"
+#include "irq/tasklet.hpp"
+
+namespace irq {
+namespace {
+struct TaskletList {
+  Tasklet* head;
+  Tasklet** tail;
+};
+
+TaskletList lists[MAX_CPUS];
+
+TaskletList& local_list() {
+  return lists[::arch::cpu_id()];
+}
+}  // namespace
+
+void Tasklet::schedule() {
+  if (this->scheduled.exchange(true, std::memory_order_acq_rel)) {
+    return;
+  }
+
+  const bool state = ::arch::int_status();
+  ::arch::int_switch(false);
+
+  TaskletList& list = local_list();
+
+  this->next = nullptr;
+  *list.tail = this;
+  list.tail = &this->next;
+
+  ::arch::int_switch(state);
+
+  raise_softirq(softirqTasklet);
+}
+
+void run_tasklets() {
+  ::arch::int_switch(false);
+
+  TaskletList& list = local_list();
+  Tasklet* tasklet = list.head;
+
+  list.head = nullptr;
+  list.tail = &list.head;
+
+  ::arch::int_switch(true);
+
+  while (tasklet != nullptr) {
+    Tasklet* next = tasklet->next;
+
+    // Cleared first, so the callback may schedule itself again.
+    tasklet->scheduled.store(false, std::memory_order_release);
+    tasklet->func(tasklet->cookie);
+
+    tasklet = next;
+  }
+}
+
+void initialize_tasklets() {
+  for (TaskletList& list : lists) {
+    list.head = nullptr;
+    list.tail = &list.head;
+  }
+
+  register_softirq(softirqTasklet, run_tasklets);
+}
+}  // namespace irq
@@ -0,0 +1,155 @@
+#include "log.hpp"
+#include "ring.hpp"
+#include "sched/thread.hpp"
+#include "spinlock.hpp"
+
+#include <atomic>
+
+namespace log {
+namespace {
+// Producers are the owning CPU and whatever interrupts it, the consumer is
+// the drain thread.
+struct LogBuffer {
+  libs::MpscRing<Record, LOG_RING_RECORDS> ring;
+  std::atomic<uint64_t> dropped;
+};
+
+LogBuffer buffers[MAX_CPUS];
+
+sched::Thread* klogd = nullptr;
+std::atomic<bool> async = false;
+
+// Serializes console output between the drain thread, early boot and panic.
+libs::IrqLock console_lock("console");
+
+void format_line(const Record& record, char (&line)[LOG_LINE_MAX]) {
+  char text[256];
+  format_record(record, text, sizeof(text));
+
+  // Zero while the clock is not calibrated yet.
+  const unsigned long long stamp = timer::counter_to_ns(record.stamp);
+
+  details::format_line<"%s[%5llu.%09llu][%06llu]%s%s%s %s%s\n">(
+      line, level_color(record.level), stamp / NS_PER_SEC, stamp % NS_PER_SEC,
+      record.seq, color_reset(), level_color(record.level),
+      level_label(record.level), text, color_reset());
+}
+
+bool pending() {
+  for (const LogBuffer& buffer : buffers) {
+    if (!buffer.ring.empty()) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// Pop and format every queued record, handing each line to `write_line`.
+// Only one consumer may run at a time: klogd, or a panicking CPU.
+template <typename Write>
+void drain(Write write_line) {
+  char line[LOG_LINE_MAX];
+  Record record;
+
+  for (LogBuffer& buffer : buffers) {
+    while (buffer.ring.pop(record)) {
+      format_line(record, line);
+      write_line(line);
+    }
+
+    const uint64_t dropped =
+        buffer.dropped.exchange(0, std::memory_order_relaxed);
+
+    if (dropped != 0) {
+      details::format_line<"%s[LOG] %lu records dropped%s\n">(
+          line, level_color(WARNING), dropped, color_reset());
+      write_line(line);
+    }
+  }
+}
+
+void klogd_main(void*) {
+  while (true) {
+    drain(write_console);
+    sched::block();
+  }
+}
+
+void write_unlocked(const char* line) {
+  ::arch::write(line);
+}
+
+// Print to the console even if the lock is held, e.g. by the CPU that
+// panicked while printing.
+template <typename Func>
+void with_console_forced(Func func) {
+  const bool locked = console_lock.try_lock();
+
+  func();
+  ::arch::write_flush();
+
+  if (locked) {
+    console_lock.unlock();
+  }
+}
+}  // namespace
+
+void submit(const Record& record) {
+  if (!async.load(std::memory_order_acquire)) {
+    char line[LOG_LINE_MAX];
+    format_line(record, line);
+    write_console(line);
+    return;
+  }
+
+  LogBuffer& buffer = buffers[::arch::cpu_id()];
+
+  if (!buffer.ring.push(record)) {
+    buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void submit_panic(const Record& record) {
+  with_console_forced([&] {
+    char line[LOG_LINE_MAX];
+
+    // Earlier records first, then the panic, which never touches the ring.
+    drain(write_unlocked);
+    format_line(record, line);
+    ::arch::write(line);
+  });
+}
+
+// Takes the console lock for one line only, so interrupts come back on
+// between lines while a slow console drains.
+void write_console(const char* text) {
+  libs::LockGuard guard(console_lock);
+  ::arch::write(text);
+}
+
+size_t format_record(const Record& record, char* out, size_t size) {
+  return record.render(record, out, size);
+}
+
+void flush() {
+  with_console_forced([] { drain(write_unlocked); });
+}
+
+void kick() {
+  if ((klogd != nullptr) && pending()) {
+    klogd->wake();
+  }
+}
+
+void initialize() {
+  klogd = sched::create_thread("klogd", klogd_main, nullptr);
+
+  if (klogd == nullptr) {
+    warning("[LOG] Failed to start klogd, logging stays synchronous");
+    return;
+  }
+
+  async.store(true, std::memory_order_release);
+}
+}  // namespace log
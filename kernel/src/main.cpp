@@ -1,8 +1,16 @@
 #include "arch/arch.hpp"
+#include "debug/bench.hpp"
+#include "debug/shell.hpp"
 #include "drivers/manager.hpp"
+#include "idle.hpp"
+#include "irq/softirq.hpp"
 #include "log.hpp"
 #include "version.hpp"
 #include "memory/memory.hpp"
+#include "rcu/rcu.hpp"
+#include "sched/thread.hpp"
+#include "sched/workqueue.hpp"
+#include "timer/timer.hpp"
 
 #include <printf_config.h>
 
@@ -16,10 +24,18 @@ extern "C" void kmain() {
   arch::initialize();
   drivers::initialize();
   memory::initialize();
+  sched::initialize();
+  log::initialize();
+  irq::initialize();
+  rcu::initialize();
+  timer::initialize();
+  sched::initialize_workqueues();
+  debug::initialize_shell();
 
   KernelInfo info;
   info.print();
 
   info("Hello, World!");
-  arch::halt();
+  debug::run_boot_benchmarks();
+  idle::run();
 }
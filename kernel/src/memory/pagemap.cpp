@@ -9,9 +9,10 @@ libs::Lazy<PageMap> kernel_pagemap;
 // Allocate a fresh (zeroed) page table structure.
 arch::PageTable* new_table() {
   PhysicalMemoryManager& instance = PhysicalMemoryManager::instance();
-  auto* tbl = instance.allocate<arch::PageTable*>(sizeof(arch::PageTable));
-  // debug("[PG][ALLOC] New page table @ 0x%lx",
-  // reinterpret_cast<uintptr_t>(tbl));
+  auto* tbl =
+      instance.allocate<arch::PageTable*>(sizeof(arch::PageTable), true);
+  log_debug(PG, "[PG][ALLOC] New page table @ 0x%lx",
+            reinterpret_cast<uintptr_t>(tbl));
   return tbl;
 }
 
@@ -29,7 +30,7 @@ arch::PageTable* get_next_lvl(PageEntry& entry, bool allocate) {
     // Allocate and install a new intermediate table.
     entry.clear();
     entry.set(reinterpret_cast<uintptr_t>(tbl = new_table()));
-    entry.set(arch::new_table_flags);
+    entry.set(arch::new_table_flags, true);
   } else {
     // Reuse existing table.
     tbl = reinterpret_cast<arch::PageTable*>(entry.get());
@@ -45,8 +46,8 @@ bool PageMap::map(uintptr_t virt_addr, uintptr_t phys_addr, size_t length,
   const PageSize page_size = arch::from_type(type);
 
   if ((virt_addr % page_size) || (phys_addr % page_size)) {
-    err("[PG][MAP] Alignment error virt=0x%lx phys=0x%lx size=0x%lx", virt_addr,
-        phys_addr, page_size);
+    log_err(PG, "[PG][MAP] Alignment error virt=0x%lx phys=0x%lx size=0x%lx",
+            virt_addr, phys_addr, page_size);
     return false;
   }
 
@@ -79,7 +80,8 @@ bool PageMap::map(uintptr_t virt_addr, uintptr_t phys_addr, size_t length,
     entry.set(flags, true);
   }
 
-  debug(
+  log_debug(
+      PG,
       "[PG][MAP] virt=0x%lx -> phys=0x%lx len=0x%lx pages=%zu ps=%zu "
       "flags=0x%lx",
       virt_addr, phys_addr, length, length / page_size,
@@ -95,8 +97,8 @@ bool PageMap::map(uintptr_t virt_addr, size_t length, size_t flags,
   const PageSize page_size = arch::from_type(type);
 
   if (virt_addr % page_size) {
-    err("[PG][MAP-AUTO] Alignment error virt=0x%lx size=0x%lx", virt_addr,
-        page_size);
+    log_err(PG, "[PG][MAP-AUTO] Alignment error virt=0x%lx size=0x%lx",
+            virt_addr, page_size);
     return false;
   }
 
@@ -109,9 +111,10 @@ bool PageMap::map(uintptr_t virt_addr, size_t length, size_t flags,
     }
   }
 
-  debug("[PG][MAP-AUTO] virt=0x%lx len=0x%lx pages=%zu ps=%zu flags=0x%lx",
-        virt_addr, length, length / page_size, static_cast<size_t>(page_size),
-        flags);
+  log_debug(PG,
+            "[PG][MAP-AUTO] virt=0x%lx len=0x%lx pages=%zu ps=%zu flags=0x%lx",
+            virt_addr, length, length / page_size,
+            static_cast<size_t>(page_size), flags);
   return true;
 }
 
@@ -122,8 +125,8 @@ bool PageMap::unmap(uintptr_t virt_addr, size_t length,
   const PageSize page_size = arch::from_type(type);
 
   if (virt_addr % page_size) {
-    err("[PG][UNMAP] Alignment error virt=0x%lx size=0x%lx", virt_addr,
-        page_size);
+    log_err(PG, "[PG][UNMAP] Alignment error virt=0x%lx size=0x%lx", virt_addr,
+            page_size);
     return false;
   }
 
@@ -141,8 +144,8 @@ bool PageMap::unmap(uintptr_t virt_addr, size_t length,
     this->invalidate_page(virt_addr + i);
   }
 
-  debug("[PG][UNMAP] virt=0x%lx len=0x%lx pages=%zu", virt_addr, length,
-        length / page_size);
+  log_debug(PG, "[PG][UNMAP] virt=0x%lx len=0x%lx pages=%zu", virt_addr, length,
+            length / page_size);
   return true;
 }
 
@@ -155,8 +158,8 @@ bool PageMap::unmap_dealloc(uintptr_t virt_addr, size_t length,
   const PageSize page_size = arch::from_type(type);
 
   if (virt_addr % page_size) {
-    err("[PG][UNMAP-DEL] Alignment error virt=0x%lx size=0x%lx", virt_addr,
-        page_size);
+    log_err(PG, "[PG][UNMAP-DEL] Alignment error virt=0x%lx size=0x%lx",
+            virt_addr, page_size);
     return false;
   }
 
@@ -173,8 +176,8 @@ bool PageMap::unmap_dealloc(uintptr_t virt_addr, size_t length,
     instance.deallocate(phys_addr.value());
   }
 
-  debug("[PG][UNMAP-DEL] virt=0x%lx len=0x%lx pages=%zu", virt_addr, length,
-        length / page_size);
+  log_debug(PG, "[PG][UNMAP-DEL] virt=0x%lx len=0x%lx pages=%zu", virt_addr,
+            length, length / page_size);
   return true;
 }
 
@@ -185,11 +188,12 @@ std::optional<uintptr_t> PageMap::translate(uintptr_t virt_addr,
   const PageSize page_size = arch::from_type(type);
 
   if (virt_addr % page_size) {
-    err("[PG][XLATE] Alignment error virt=0x%lx size=0x%lx", virt_addr,
-        page_size);
+    log_err(PG, "[PG][XLATE] Alignment error virt=0x%lx size=0x%lx", virt_addr,
+            page_size);
     return std::nullopt;
   }
 
+  const libs::LockGuard guard(this->lock.reader());
   const auto ret = get_page_entry(virt_addr, type, false);
 
   if (!ret.has_value()) {
@@ -206,8 +210,8 @@ bool PageMap::protect(uintptr_t virt_addr, size_t length, size_t flags,
   const PageSize page_size = arch::from_type(type);
 
   if (virt_addr % page_size) {
-    err("[PG][PROTECT] Alignment error virt=0x%lx size=0x%lx", virt_addr,
-        page_size);
+    log_err(PG, "[PG][PROTECT] Alignment error virt=0x%lx size=0x%lx",
+            virt_addr, page_size);
     return false;
   }
 
@@ -228,14 +232,14 @@ bool PageMap::protect(uintptr_t virt_addr, size_t length, size_t flags,
     this->invalidate_page(virt_addr + i);
   }
 
-  debug("[PG][PROTECT] virt=0x%lx len=0x%lx pages=%zu new_flags=0x%lx",
-        virt_addr, length, length / page_size, flags);
+  log_debug(PG, "[PG][PROTECT] virt=0x%lx len=0x%lx pages=%zu new_flags=0x%lx",
+            virt_addr, length, length / page_size, flags);
   return true;
 }
 
 // Build initial kernel mappings from Limine memory map.
 void initialize_paging(limine_memmap_response* memmap_response) {
-  debug("[INFO][PG-INIT] Paging initialization start");
+  log_debug(PG, "[INFO][PG-INIT] Paging initialization start");
 
   kernel_pagemap.initialize();
 
@@ -248,8 +252,8 @@ void initialize_paging(limine_memmap_response* memmap_response) {
     const limine_memmap_entry* memmap = memmap_response->entries[i];
     const size_t type = memmap->type;
 
-    debug("[PG-INIT][RAW] idx=%zu type=%lu base=0x%lx len=0x%lx", i, type,
-          memmap->base, memmap->length);
+    log_debug(PG, "[PG-INIT][RAW] idx=%zu type=%lu base=0x%lx len=0x%lx", i,
+              type, memmap->base, memmap->length);
 
     if (type != LIMINE_MEMMAP_USABLE &&
         type != LIMINE_MEMMAP_BOOTLOADER_RECLAIMABLE &&
@@ -277,13 +281,14 @@ void initialize_paging(limine_memmap_response* memmap_response) {
     }
 
     if (length == 0) {
-      debug("[PG-INIT][SKIP] idx=%zu zero-length after align", i);
+      log_debug(PG, "[PG-INIT][SKIP] idx=%zu zero-length after align", i);
       continue;
     }
 
     const uintptr_t virt_addr = to_higher_half(base);
 
-    debug(
+    log_debug(
+        PG,
         "[PG-INIT][ALIGN] idx=%zu base=0x%lx top=0x%lx len=0x%lx ps=0x%lx "
         "ps_type=%d cache=%d virt=0x%lx",
         i, base, top, length, page_size, static_cast<int>(ps_type),
@@ -311,12 +316,14 @@ void initialize_paging(limine_memmap_response* memmap_response) {
     ++kernel_pages;
   }
 
-  debug(
+  log_debug(
+      PG,
       "[PG-INIT][KERNEL] phys_base=0x%lx virt_base=0x%lx size=0x%lx pages=%zu",
       phys_base, virt_base, kernel_size, kernel_pages);
 
   kernel_pagemap->load();
-  debug(
+  log_debug(
+      PG,
       "[INFO][PG-INIT] Completed: regions_considered=%zu regions_mapped=%zu "
       "bytes_mapped=0x%lx kernel_pages=%zu",
       regions_considered, regions_mapped, bytes_mapped, kernel_pages);
@@ -1,3 +1,4 @@
+#include "arch/page_ops.hpp"
 #include "log.hpp"
 #include "memory/memory.hpp"
 #include "memory/physical.hpp"
@@ -40,6 +41,7 @@ void PhysicalMemoryManager::insert_block(uintptr_t addr, uint8_t order) {
   // Set node to be the head
   this->free_lists[order].next->prev = node;
   this->free_lists[order].next = node;
+  this->free_blocks[order]++;
 
   this->set_page_metadata(addr, order, true);
 }
@@ -50,6 +52,7 @@ void PhysicalMemoryManager::remove_block(uintptr_t addr, uint8_t order) {
 
   node->prev->next = node->next;
   node->next->prev = node->prev;
+  this->free_blocks[order]--;
 }
 
 uintptr_t PhysicalMemoryManager::get_buddy_address(uintptr_t addr,
@@ -87,7 +90,8 @@ void* PhysicalMemoryManager::allocate(size_t bytes, bool clear) {
 
   uint8_t order = this->size_to_order(bytes);
   if (order > MAX_ORDER) {
-    err("[PMM][ALLOC] Request too large: bytes=0x%lx order=%u", bytes, order);
+    log_err(PMM, "[PMM][ALLOC] Request too large: bytes=0x%lx order=%u", bytes,
+            order);
     return nullptr;
   }
 
@@ -107,31 +111,41 @@ void* PhysicalMemoryManager::allocate(size_t bytes, bool clear) {
     return nullptr;
   }
 
-  // const size_t before_free = this->usable_memory;
+  const size_t before_free = this->usable_memory;
   FreeBlockNode* block_node = this->free_lists[curr_order].next;
   uintptr_t block_addr =
       reinterpret_cast<uintptr_t>(from_higher_half(block_node));
-  this->remove_block(block_addr, curr_order);
 
-  // Split down to requested order; buddies go back to their free lists.
-  while (curr_order > order) {
-    curr_order--;
-    uintptr_t buddy_addr = get_buddy_address(block_addr, curr_order);
-    this->insert_block(buddy_addr, curr_order);
-  }
+  {
+    // Only the list and counter updates; get_stats() readers retry on it.
+    libs::LockGuard stats_guard(this->stats_seq);
+
+    this->remove_block(block_addr, curr_order);
+
+    // Split down to requested order; buddies go back to their free lists.
+    while (curr_order > order) {
+      curr_order--;
+      uintptr_t buddy_addr = get_buddy_address(block_addr, curr_order);
+      this->insert_block(buddy_addr, curr_order);
+    }
 
-  this->set_page_metadata(block_addr, order, false);
-  this->usable_memory -= (PageSize4KiB << order);
+    this->set_page_metadata(block_addr, order, false);
+    this->usable_memory -= (PageSize4KiB << order);
+  }
 
   void* ret = reinterpret_cast<void*>(block_addr);
   if (clear) {
-    memset(ret, 0, bytes);
+    // `ret` is physical; clear through the HHDM, and around the cache since
+    // the caller has not touched these pages yet.
+    arch::stream_clear_pages(
+        to_higher_half(ret),
+        div_roundup(bytes, std::to_underlying(PageSize4KiB)));
   }
 
-  // debug(
-  // "[PMM][ALLOC] bytes=0x%lx order=%u addr=0x%lx free_before=0x%lx "
-  // "free_after=0x%lx",
-  // bytes, order, block_addr, before_free, this->usable_memory);
+  log_debug(PMM,
+            "[PMM][ALLOC] bytes=0x%lx order=%u addr=0x%lx free_before=0x%lx "
+            "free_after=0x%lx",
+            bytes, order, block_addr, before_free, this->usable_memory);
   return ret;
 }
 
@@ -147,7 +161,7 @@ void PhysicalMemoryManager::deallocate(void* ptr) {
   const size_t page_bytes = std::to_underlying(PageSize4KiB);
 
   if (!is_aligned(addr, page_bytes)) {
-    err("[PMM][FREE] Address %p is not page-aligned", ptr);
+    log_err(PMM, "[PMM][FREE] Address %p is not page-aligned", ptr);
     return;
   }
 
@@ -156,46 +170,85 @@ void PhysicalMemoryManager::deallocate(void* ptr) {
   // The order of the block being freed is stored in its first page's metadata.
   uint8_t order = this->page_metadata[page_idx].order;
   const uint8_t orig_order = order;
-  // const size_t before_free = this->usable_memory;
-
-  // Coalesce (merge) with buddies while possible.
-  while (order < MAX_ORDER) {
-    const uintptr_t buddy_addr = this->get_buddy_address(addr, order);
-    const size_t buddy_page_idx = buddy_addr / page_bytes;
-
-    // Check if buddy is within bounds, is free, and has the same order.
-    if ((buddy_page_idx >= this->total_pages) ||
-        !this->page_metadata[buddy_page_idx].is_free ||
-        (this->page_metadata[buddy_page_idx].order != order)) {
-      break;  // Buddy not mergeable
+  const size_t before_free = this->usable_memory;
+
+  {
+    libs::LockGuard stats_guard(this->stats_seq);
+
+    // Coalesce (merge) with buddies while possible.
+    while (order < MAX_ORDER) {
+      const uintptr_t buddy_addr = this->get_buddy_address(addr, order);
+      const size_t buddy_page_idx = buddy_addr / page_bytes;
+
+      // Check if buddy is within bounds, is free, and has the same order.
+      if ((buddy_page_idx >= this->total_pages) ||
+          !this->page_metadata[buddy_page_idx].is_free ||
+          (this->page_metadata[buddy_page_idx].order != order)) {
+        break;  // Buddy not mergeable
+      }
+
+      // Buddy is available: remove it from free list and merge.
+      this->remove_block(buddy_addr, order);
+
+      // Merged block starts at the lower address.
+      addr = (addr <= buddy_addr) ? addr : buddy_addr;
+      order++;
     }
 
-    // Buddy is available: remove it from free list and merge.
-    this->remove_block(buddy_addr, order);
+    // Insert (possibly merged) block back into free lists.
+    this->insert_block(addr, order);
 
-    // Merged block starts at the lower address.
-    addr = (addr <= buddy_addr) ? addr : buddy_addr;
-    order++;
+    // Important: Increase free memory only by the size of the originally freed
+    // block. The buddies we removed were already counted in usable_memory.
+    this->usable_memory += (PageSize4KiB << orig_order);
   }
 
-  // Insert (possibly merged) block back into free lists.
-  this->insert_block(addr, order);
+  log_debug(
+      PMM,
+      "[PMM][FREE] addr=0x%lx orig_order=%u final_order=%u free_before=0x%lx "
+      "free_after=0x%lx",
+      reinterpret_cast<uintptr_t>(ptr), orig_order, order, before_free,
+      this->usable_memory);
+}
+
+void PhysicalMemoryManager::deallocate_deferred(void* ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
 
-  // Important: Increase free memory only by the size of the originally freed
-  // block. The buddies we removed were already counted in usable_memory.
-  this->usable_memory += (PageSize4KiB << orig_order);
+  FreeBlockNode* node = reinterpret_cast<FreeBlockNode*>(to_higher_half(ptr));
 
-  // debug(
-  // "[PMM][FREE] addr=0x%lx orig_order=%u final_order=%u free_before=0x%lx "
-  // "free_after=0x%lx",
-  // reinterpret_cast<uintptr_t>(ptr), orig_order, order, before_free,
-  // this->usable_memory);
+  {
+    libs::LockGuard guard(this->deferred_lock);
+    node->next = this->deferred;
+    this->deferred = node;
+  }
+
+  sched::queue_unbound_work(&this->deferred_work);
+}
+
+void PhysicalMemoryManager::free_deferred(void* cookie) {
+  PhysicalMemoryManager* self = static_cast<PhysicalMemoryManager*>(cookie);
+  FreeBlockNode* node = nullptr;
+
+  {
+    libs::LockGuard guard(self->deferred_lock);
+    node = std::exchange(self->deferred, nullptr);
+  }
+
+  while (node != nullptr) {
+    FreeBlockNode* next = node->next;
+    self->deallocate(from_higher_half(node));
+    node = next;
+  }
 }
 
 void PhysicalMemoryManager::initialize(
     limine_memmap_response* memmap_response) {
   const size_t memmap_count = memmap_response->entry_count;
 
+  this->deferred_work.set_callback(free_deferred, this);
+
   // Initialize all free lists (sentinel nodes point to themselves).
   for (int i = MIN_ORDER; i <= MAX_ORDER; ++i) {
     FreeBlockNode* node = &this->free_lists[i];
@@ -287,8 +340,9 @@ void PhysicalMemoryManager::initialize(
     }
   }
 
-  debug("Page Metadata address = %p", this->page_metadata);
-  info(
+  log_debug(PMM, "Page Metadata address = %p", this->page_metadata);
+  log_info(
+      PMM,
       "[PMM][INIT]\n\tHighest Address: 0x%lx\n\t"
       "Total Pages: %lu\n\t"
       "Total Memory: %lu MiB\n\t"
@@ -300,14 +354,29 @@ void PhysicalMemoryManager::initialize(
       this->usable_memory / 1024 / 1024);
 }
 
+PhysicalMemoryStats PhysicalMemoryManager::get_stats() const {
+  return this->stats_seq.read([this] {
+    PhysicalMemoryStats ret = {};
+
+    ret.total_memory = this->total_memory;
+    ret.free_memory = this->usable_memory;
+
+    for (int order = MIN_ORDER; order <= MAX_ORDER; ++order) {
+      ret.free_blocks[order] = this->free_blocks[order];
+    }
+
+    return ret;
+  });
+}
+
 void PhysicalMemoryManager::print() const {
   libs::LockGuard guard(this->lock);
 
-  printf("---------- Physical Memory Free Block ----------\n");
-  printf("Total Memory: %lu MiB | Free Memory: %lu MiB\n",
-         this->get_total_memory() / 1024 / 1024,
-         this->get_free_memory() / 1024 / 1024);
-  printf("================================================\n");
+  log::print<"---------- Physical Memory Free Block ----------\n">();
+  log::print<"Total Memory: %lu MiB | Free Memory: %lu MiB\n">(
+      this->get_total_memory() / 1024 / 1024,
+      this->get_free_memory() / 1024 / 1024);
+  log::print<"================================================\n">();
 
   for (int order = MIN_ORDER; order <= MAX_ORDER; ++order) {
     const FreeBlockNode* head = &this->free_lists[order];
@@ -330,21 +399,21 @@ void PhysicalMemoryManager::print() const {
       unit = "KiB";
     }
 
-    printf("Order %2d (%4lu %s blocks):\n", order, size_in_unit, unit);
+    log::print<"Order %2d (%4lu %s blocks):\n">(order, size_in_unit, unit);
 
     int count = 0;
 
     while ((curr != head) && curr != nullptr) {
       uintptr_t phys_addr = reinterpret_cast<uintptr_t>(from_higher_half(curr));
-      printf("  -> Block at 0x%016lx\n", phys_addr);
+      log::print<"  -> Block at 0x%016lx\n">(phys_addr);
 
       curr = curr->next;
       count++;
     }
 
-    printf("   (Total: %d blocks)\n", count);
+    log::print<"   (Total: %d blocks)\n">(count);
   }
 
-  printf("================================================\n");
+  log::print<"================================================\n">();
 }
 }  // namespace memory
@@ -27,9 +27,9 @@ void VirtualMemoryManager::initialize(limine_memmap_response* memmap_response,
   this->base_end = end;
   this->next = base;
 
-  info("[VMM][INIT] VA pool: [0x%lx, 0x%lx) size=0x%lx (%lu MiB)",
-       this->base_start, this->base_end, this->base_end - this->base_start,
-       (this->base_end - this->base_start) / 1024 / 1024);
+  log_info(VMM, "[VMM][INIT] VA pool: [0x%lx, 0x%lx) size=0x%lx (%lu MiB)",
+           this->base_start, this->base_end, this->base_end - this->base_start,
+           (this->base_end - this->base_start) / 1024 / 1024);
 }
 
 void* VirtualMemoryManager::allocate(size_t bytes) {
@@ -44,8 +44,10 @@ void* VirtualMemoryManager::allocate(size_t bytes) {
       align_up(alloc_start + alloc_length, std::to_underlying(PageSize4KiB));
   this->allocations++;
 
-  debug("[VMM][ALLOC] req=0x%lx aligned=0x%lx base=0x%lx next=0x%lx total=%lu",
-        bytes, alloc_length, alloc_start, this->next, this->allocations);
+  log_debug(
+      VMM,
+      "[VMM][ALLOC] req=0x%lx aligned=0x%lx base=0x%lx next=0x%lx total=%lu",
+      bytes, alloc_length, alloc_start, this->next, this->allocations);
 
   return reinterpret_cast<void*>(alloc_start);
 }
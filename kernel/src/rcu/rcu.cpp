@@ -0,0 +1,302 @@
+#include "arch/arch.hpp"
+#include "irq/softirq.hpp"
+#include "log.hpp"
+#include "rcu/rcu.hpp"
+#include "sched/thread.hpp"
+#include "spinlock.hpp"
+
+#include <atomic>
+
+namespace rcu {
+namespace {
+// Callback list with a tail pointer, so batches splice in O(1).
+struct CallbackList {
+  RcuHead* head;
+  RcuHead** tail;
+
+  bool empty() const {
+    return this->head == nullptr;
+  }
+
+  void reset() {
+    this->head = nullptr;
+    this->tail = &this->head;
+  }
+
+  void push(RcuHead* node) {
+    node->next = nullptr;
+    *this->tail = node;
+    this->tail = &node->next;
+  }
+
+  void splice(CallbackList& other) {
+    if (other.empty()) {
+      return;
+    }
+
+    *this->tail = other.head;
+    this->tail = other.tail;
+    other.reset();
+  }
+};
+
+// Callbacks move next -> wait -> done. `wait` is one batch waiting for grace
+// period `wait_gp`; everything queued meanwhile piles up in `next` and gets
+// the following grace period as a whole.
+struct CpuState {
+  CallbackList next;
+  CallbackList wait;
+  CallbackList done;
+  uint64_t wait_gp;
+
+  RcuStats stats;
+
+#if NOISE_DEBUG
+  uint32_t read_depth;
+#endif
+};
+
+struct GracePeriodState {
+  libs::IrqLock lock{"rcu"};
+
+  // Last started and last completed grace period. Equal when idle.
+  uint64_t started;
+  std::atomic<uint64_t> completed;
+  // Callbacks arrived during the current grace period and need another.
+  bool requested;
+
+  // CPUs yet to pass a quiescent state in the current grace period.
+  std::atomic<uint32_t> pending;
+  uint32_t online;
+};
+
+CpuState cpu_states[MAX_CPUS];
+GracePeriodState gp;
+
+CpuState& local_state() {
+  return cpu_states[::arch::cpu_id()];
+}
+
+// Returns the grace period a batch queued now has to wait for. gp.lock held.
+uint64_t request_grace_period() {
+  if (gp.started != gp.completed.load(std::memory_order_relaxed)) {
+    gp.requested = true;
+    return gp.started + 1;
+  }
+
+  gp.started++;
+  gp.pending.store(gp.online, std::memory_order_seq_cst);
+
+  return gp.started;
+}
+
+bool callbacks_ready(const CpuState& state) {
+  if (!state.done.empty()) {
+    return true;
+  }
+
+  if (!state.wait.empty()) {
+    return gp.completed.load(std::memory_order_acquire) >= state.wait_gp;
+  }
+
+  return !state.next.empty();
+}
+
+void process_callbacks() {
+  CpuState& state = local_state();
+  CallbackList batch;
+  batch.reset();
+
+  ::arch::int_switch(false);
+
+  if (!state.wait.empty() &&
+      (gp.completed.load(std::memory_order_acquire) >= state.wait_gp)) {
+    state.done.splice(state.wait);
+  }
+
+  if (state.wait.empty() && !state.next.empty()) {
+    state.wait.splice(state.next);
+
+    libs::LockGuard guard(gp.lock);
+    state.wait_gp = request_grace_period();
+  }
+
+  for (size_t i = 0; (i < RCU_BATCH_LIMIT) && !state.done.empty(); ++i) {
+    RcuHead* node = state.done.head;
+
+    state.done.head = node->next;
+    if (state.done.head == nullptr) {
+      state.done.tail = &state.done.head;
+    }
+
+    batch.push(node);
+  }
+
+  const bool more = !state.done.empty();
+  ::arch::int_switch(true);
+
+  size_t invoked = 0;
+
+  while (batch.head != nullptr) {
+    RcuHead* node = batch.head;
+    batch.head = node->next;
+
+    node->func(node);
+    invoked++;
+  }
+
+  state.stats.invoked += invoked;
+
+  if (more) {
+    irq::raise_softirq(irq::softirqRcu);
+  }
+}
+
+struct SyncWait {
+  RcuHead head;
+  sched::Thread* waiter;
+  std::atomic<bool> done;
+};
+
+void wake_synchronize(RcuHead* head) {
+  SyncWait* wait = reinterpret_cast<SyncWait*>(head);
+
+  wait->done.store(true, std::memory_order_release);
+  wait->waiter->wake();
+}
+}  // namespace
+
+#if NOISE_DEBUG
+void debug_read_lock() {
+  local_state().read_depth++;
+}
+
+void debug_read_unlock() {
+  CpuState& state = local_state();
+
+  if (state.read_depth == 0) {
+    panic("[RCU] read_unlock() without read_lock()");
+  }
+
+  state.read_depth--;
+}
+
+bool in_read_section() {
+  return local_state().read_depth != 0;
+}
+#endif
+
+void call(RcuHead* head, RcuCallback func) {
+  head->func = func;
+
+  const bool state = ::arch::int_status();
+  ::arch::int_switch(false);
+
+  CpuState& local = local_state();
+  local.next.push(head);
+  local.stats.queued++;
+
+  ::arch::int_switch(state);
+
+  irq::raise_softirq(irq::softirqRcu);
+}
+
+void synchronize() {
+#if NOISE_DEBUG
+  if (in_read_section()) {
+    panic("[RCU] synchronize() inside a read-side critical section");
+  }
+#endif
+
+  // With a single CPU, the caller being here in thread context is itself
+  // the grace period: no other thread can be inside a read section, since
+  // readers do not block and threads only switch in schedule().
+  if (__builtin_popcount(gp.online) <= 1) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return;
+  }
+
+  SyncWait wait = {};
+  wait.waiter = sched::current();
+
+  call(&wait.head, wake_synchronize);
+
+  while (!wait.done.load(std::memory_order_acquire)) {
+    sched::block();
+  }
+}
+
+void note_quiescent_state() {
+  const uint32_t bit = 1u << ::arch::cpu_id();
+
+  // Fast path: no grace period is waiting on us.
+  if ((gp.pending.load(std::memory_order_relaxed) & bit) == 0) {
+    return;
+  }
+
+  libs::LockGuard guard(gp.lock);
+
+  const uint32_t pending =
+      gp.pending.fetch_and(~bit, std::memory_order_acq_rel) & ~bit;
+
+  if (pending != 0) {
+    return;
+  }
+
+  gp.completed.store(gp.started, std::memory_order_release);
+  local_state().stats.grace_periods++;
+
+  if (gp.requested) {
+    gp.requested = false;
+    request_grace_period();
+  }
+
+  guard.unlock();
+
+  // Callbacks on this CPU may have just become ready. Other CPUs notice on
+  // their next tick.
+  if (callbacks_ready(local_state())) {
+    irq::raise_softirq(irq::softirqRcu);
+  }
+}
+
+void check_callbacks() {
+  if (callbacks_ready(local_state())) {
+    irq::raise_softirq(irq::softirqRcu);
+  }
+}
+
+bool needs_cpu() {
+  const CpuState& state = local_state();
+
+  return !state.next.empty() || !state.wait.empty() || !state.done.empty();
+}
+
+RcuStats get_stats(uint32_t cpu) {
+  if (cpu >= MAX_CPUS) {
+    return {};
+  }
+
+  return cpu_states[cpu].stats;
+}
+
+void initialize() {
+  const uint32_t cpu = ::arch::cpu_id();
+  CpuState& state = cpu_states[cpu];
+
+  state.next.reset();
+  state.wait.reset();
+  state.done.reset();
+
+  {
+    libs::LockGuard guard(gp.lock);
+    gp.online |= 1u << cpu;
+  }
+
+  if (cpu == 0) {
+    irq::register_softirq(irq::softirqRcu, process_callbacks);
+  }
+
+  info("[RCU] CPU %u online", cpu);
+}
+}  // namespace rcu
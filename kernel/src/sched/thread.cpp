@@ -0,0 +1,294 @@
+#include "arch/arch.hpp"
+#include "arch/context.hpp"
+#include "log.hpp"
+#include "memory/memory.hpp"
+#include "memory/physical.hpp"
+#include "rcu/rcu.hpp"
+#include "sched/thread.hpp"
+#include "sched/workqueue.hpp"
+#include "spinlock.hpp"
+
+namespace sched {
+// Per-CPU FIFO of runnable threads. The idle thread is never queued; it runs
+// whenever the queue is empty and the current thread cannot continue.
+struct RunQueue {
+  Thread* head;
+  Thread* tail;
+
+  Thread* current;
+  Thread* idle;
+
+  // Exited thread whose stack can only be freed once we are off it.
+  Thread* dead;
+
+  libs::IrqLock lock{"runqueue"};
+
+  void push(Thread* thread) {
+    thread->next = nullptr;
+
+    if (this->tail != nullptr) {
+      this->tail->next = thread;
+    } else {
+      this->head = thread;
+    }
+
+    this->tail = thread;
+  }
+
+  Thread* pop() {
+    Thread* thread = this->head;
+
+    if (thread != nullptr) {
+      this->head = thread->next;
+      this->tail = (this->head != nullptr) ? this->tail : nullptr;
+      thread->next = nullptr;
+    }
+
+    return thread;
+  }
+
+  void reap() {
+    Thread* thread = this->dead;
+
+    if (thread == nullptr) {
+      return;
+    }
+
+    this->dead = nullptr;
+
+    memory::PhysicalMemoryManager::instance().deallocate(
+        memory::from_higher_half(thread->stack));
+
+    thread->stack = 0;
+    thread->state = ThreadState::Free;
+  }
+};
+
+namespace {
+Thread threads[MAX_THREADS];
+RunQueue run_queues[MAX_CPUS];
+libs::SpinLock threads_lock("threads");
+
+RunQueue& local_queue() {
+  return run_queues[::arch::cpu_id()];
+}
+}  // namespace
+
+Thread* Thread::allocate(const char* name) {
+  libs::LockGuard guard(threads_lock);
+
+  for (Thread& thread : threads) {
+    if (thread.state != ThreadState::Free) {
+      continue;
+    }
+
+    size_t i = 0;
+    for (; (i < (THREAD_NAME_LENGTH - 1)) && (name[i] != '\0'); ++i) {
+      thread.name[i] = name[i];
+    }
+    thread.name[i] = '\0';
+
+    thread.state = ThreadState::Blocked;
+    return &thread;
+  }
+
+  return nullptr;
+}
+
+void Thread::start(void* self) {
+  Thread* thread = static_cast<Thread*>(self);
+
+  // We got here from schedule() with interrupts off, finish its work.
+  local_queue().reap();
+  ::arch::int_switch(true);
+
+  thread->func(thread->arg);
+  sched::exit();
+}
+
+void Thread::wake() {
+  RunQueue& queue = run_queues[this->cpu];
+  bool woken = false;
+
+  {
+    libs::LockGuard guard(queue.lock);
+
+    if (this->state == ThreadState::Blocked) {
+      this->state = ThreadState::Runnable;
+      queue.push(this);
+      woken = true;
+    } else if (this->state != ThreadState::Dead) {
+      this->wake_pending = true;
+    }
+  }
+
+  if (woken && (this->worker != nullptr)) {
+    worker_waking(this->worker);
+  }
+}
+
+Thread* create_thread(const char* name, ThreadFunc func, void* arg) {
+  Thread* thread = Thread::allocate(name);
+
+  if (thread == nullptr) {
+    err("[SCHED] Out of thread slots creating '%s'", name);
+    return nullptr;
+  }
+
+  void* stack = memory::PhysicalMemoryManager::instance().allocate(
+      THREAD_STACK_SIZE);
+
+  thread->stack = memory::to_higher_half(reinterpret_cast<uintptr_t>(stack));
+  thread->sp = arch::initialize_stack(thread->stack + THREAD_STACK_SIZE,
+                                      Thread::start, thread);
+  thread->func = func;
+  thread->arg = arg;
+  thread->cpu = ::arch::cpu_id();
+  thread->wake_pending = false;
+  thread->worker = nullptr;
+  thread->switches = 0;
+
+  RunQueue& queue = run_queues[thread->cpu];
+  libs::LockGuard guard(queue.lock);
+
+  thread->state = ThreadState::Runnable;
+  queue.push(thread);
+
+  debug("[SCHED] Created thread '%s' on CPU %u", thread->name, thread->cpu);
+  return thread;
+}
+
+Thread* current() {
+  return local_queue().current;
+}
+
+void schedule() {
+  RunQueue& queue = local_queue();
+
+#if NOISE_DEBUG
+  if (rcu::in_read_section()) {
+    panic("[SCHED] Scheduling inside an RCU read-side critical section");
+  }
+
+  if (::arch::in_kernel_fpu()) {
+    panic("[SCHED] Scheduling inside a kernel FPU section");
+  }
+#endif
+
+  // Every pass through here is a quiescent state: readers never block.
+  rcu::note_quiescent_state();
+
+  const bool state = ::arch::int_status();
+  ::arch::int_switch(false);
+
+  queue.lock.lock();
+
+  Thread* prev = queue.current;
+  Thread* next = queue.pop();
+
+  if (next == nullptr) {
+    if (prev->state == ThreadState::Running) {
+      queue.lock.unlock();
+      ::arch::int_switch(state);
+      return;
+    }
+
+    next = queue.idle;
+  } else if ((prev->state == ThreadState::Running) && (prev != queue.idle)) {
+    prev->state = ThreadState::Runnable;
+    queue.push(prev);
+  }
+
+  next->state = ThreadState::Running;
+  queue.current = next;
+
+  if (prev->state == ThreadState::Dead) {
+    queue.dead = prev;
+  }
+
+  // Interrupts stay off across the switch, the lock does not.
+  queue.lock.unlock();
+
+  if (next != prev) {
+    next->switches++;
+    arch::switch_to(&prev->sp, next->sp);
+
+    // Back on `prev`, possibly after a long time.
+    local_queue().reap();
+  }
+
+  ::arch::int_switch(state);
+}
+
+void yield() {
+  schedule();
+}
+
+void block() {
+  RunQueue& queue = local_queue();
+  Thread* self = queue.current;
+
+  // Before the state change, so a wakeup racing with us always sees the
+  // worker as sleeping and undoes it.
+  if (self->worker != nullptr) {
+    worker_sleeping(self->worker);
+  }
+
+  {
+    libs::LockGuard guard(queue.lock);
+
+    if (self->wake_pending) {
+      self->wake_pending = false;
+      guard.unlock();
+
+      if (self->worker != nullptr) {
+        worker_waking(self->worker);
+      }
+
+      return;
+    }
+
+    self->state = ThreadState::Blocked;
+  }
+
+  schedule();
+}
+
+void exit() {
+  RunQueue& queue = local_queue();
+
+  {
+    libs::LockGuard guard(queue.lock);
+    queue.current->state = ThreadState::Dead;
+  }
+
+  schedule();
+
+  panic("[SCHED] Dead thread was scheduled again");
+  while (true);
+}
+
+bool has_runnable() {
+  RunQueue& queue = local_queue();
+  libs::LockGuard guard(queue.lock);
+
+  return queue.head != nullptr;
+}
+
+void initialize() {
+  RunQueue& queue = local_queue();
+  Thread* idle = Thread::allocate("idle");
+
+  if (idle == nullptr) {
+    panic("[SCHED] No slot for the idle thread");
+  }
+
+  idle->cpu = ::arch::cpu_id();
+  idle->state = ThreadState::Running;
+
+  queue.idle = idle;
+  queue.current = idle;
+
+  info("[SCHED] Initialized, %d thread slots", MAX_THREADS);
+}
+}  // namespace sched
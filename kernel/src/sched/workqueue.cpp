@@ -0,0 +1,354 @@
+#include "arch/arch.hpp"
+#include "log.hpp"
+#include "sched/thread.hpp"
+#include "sched/workqueue.hpp"
+#include "timer/clock.hpp"
+
+#include <printf/printf.h>
+
+namespace sched {
+namespace {
+WorkerPool pools[MAX_CPUS];
+WorkerPool unbound_pool;
+}  // namespace
+
+void DelayedWork::timer_expired(timer::Timer*, void* cookie) {
+  DelayedWork* delayed = static_cast<DelayedWork*>(cookie);
+
+  // Still pending from queue_delayed_work(); clearing it here would let a
+  // racing re-queue arm the timer again and push the work back a full delay.
+  delayed->pool->insert(&delayed->work);
+}
+
+void WorkerPool::initialize(const char* name) {
+  snprintf(this->name, sizeof(this->name), "%s", name);
+
+  this->head = nullptr;
+  this->tail = &this->head;
+
+  this->idle_timer.set_callback(idle_timer_expired, this);
+
+  // The first worker is the spare every pool keeps around.
+  if (!this->create_worker()) {
+    panic("[WQ] Failed to start the first worker of %s", this->name);
+  }
+}
+
+bool WorkerPool::create_worker() {
+  Worker* worker = nullptr;
+  size_t index = 0;
+
+  {
+    libs::LockGuard guard(this->lock);
+
+    for (; index < WORKERS_PER_POOL; ++index) {
+      if (this->workers[index].pool == nullptr) {
+        worker = &this->workers[index];
+        break;
+      }
+    }
+
+    if (worker == nullptr) {
+      return false;
+    }
+
+    // Starts out busy; it goes idle on its own if there is nothing to do.
+    *worker = {};
+    worker->pool = this;
+    worker->busy = true;
+
+    this->nr_workers++;
+    this->nr_starting++;
+    this->nr_running.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  char thread_name[THREAD_NAME_LENGTH];
+  snprintf(thread_name, sizeof(thread_name), "%s:%lu", this->name, index);
+
+  Thread* thread = create_thread(thread_name, worker_main, worker);
+
+  libs::LockGuard guard(this->lock);
+
+  if (thread == nullptr) {
+    worker->pool = nullptr;
+    this->nr_workers--;
+    this->nr_starting--;
+    this->nr_running.fetch_sub(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  // Safe after the fact: the new thread cannot run before we block.
+  worker->thread = thread;
+  thread->set_worker(worker);
+
+  this->stats.workers_created++;
+  return true;
+}
+
+void WorkerPool::wake_idle_worker() {
+  Worker* worker = this->idle_list;
+
+  if (worker == nullptr) {
+    return;
+  }
+
+  this->idle_list = worker->next_idle;
+  this->nr_idle--;
+
+  worker->next_idle = nullptr;
+  worker->busy = true;
+  this->nr_running.fetch_add(1, std::memory_order_relaxed);
+
+  worker->thread->wake();
+}
+
+bool WorkerPool::enqueue(Work* work) {
+  if (work->pending.exchange(true, std::memory_order_acq_rel)) {
+    return false;
+  }
+
+  this->insert(work);
+  return true;
+}
+
+void WorkerPool::insert(Work* work) {
+  libs::LockGuard guard(this->lock);
+
+  work->next = nullptr;
+  *this->tail = work;
+  this->tail = &work->next;
+
+  if (this->nr_running.load(std::memory_order_relaxed) == 0) {
+    this->wake_idle_worker();
+  }
+}
+
+void WorkerPool::worker_sleeping(Worker* worker) {
+  if (!worker->busy || worker->retire) {
+    return;
+  }
+
+  worker->sleeping = true;
+
+  // The last running worker just blocked inside a work item; let an idle
+  // one carry on with the rest of the list.
+  if (this->nr_running.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    libs::LockGuard guard(this->lock);
+
+    if (this->head != nullptr) {
+      this->wake_idle_worker();
+    }
+  }
+}
+
+void WorkerPool::worker_waking(Worker* worker) {
+  if (worker->sleeping) {
+    worker->sleeping = false;
+    this->nr_running.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void WorkerPool::retire_idle_workers() {
+  libs::LockGuard guard(this->lock);
+
+  const uint64_t current = timer::now();
+  Worker** link = &this->idle_list;
+
+  // Newly idle workers are pushed at the head, so the oldest are at the
+  // tail; always keep one.
+  while ((*link != nullptr) && (this->nr_idle > 1)) {
+    Worker* worker = *link;
+
+    if ((current - worker->idle_since) < WORKER_IDLE_TIMEOUT_NS) {
+      link = &worker->next_idle;
+      continue;
+    }
+
+    *link = worker->next_idle;
+    this->nr_idle--;
+
+    worker->next_idle = nullptr;
+    worker->retire = true;
+    worker->thread->wake();
+  }
+
+  if (this->nr_idle > 1) {
+    guard.unlock();
+    this->idle_timer.start_after(WORKER_IDLE_TIMEOUT_NS);
+  }
+}
+
+void WorkerPool::idle_timer_expired(timer::Timer*, void* cookie) {
+  static_cast<WorkerPool*>(cookie)->retire_idle_workers();
+}
+
+void WorkerPool::worker_main(void* cookie) {
+  Worker* worker = static_cast<Worker*>(cookie);
+  WorkerPool* pool = worker->pool;
+
+  {
+    libs::LockGuard guard(pool->lock);
+    pool->nr_starting--;
+  }
+
+  while (true) {
+    libs::LockGuard guard(pool->lock);
+
+    if (worker->retire) {
+      Thread* thread = worker->thread;
+
+      worker->pool = nullptr;
+      worker->thread = nullptr;
+      pool->nr_workers--;
+      pool->stats.workers_retired++;
+
+      guard.unlock();
+
+      thread->set_worker(nullptr);
+      sched::exit();
+    }
+
+    // Woken without being handed work (e.g. a stale wakeup): leave the idle
+    // list on our own.
+    if (!worker->busy) {
+      Worker** link = &pool->idle_list;
+
+      while ((*link != nullptr) && (*link != worker)) {
+        link = &(*link)->next_idle;
+      }
+
+      if (*link == worker) {
+        *link = worker->next_idle;
+        pool->nr_idle--;
+      }
+
+      worker->next_idle = nullptr;
+      worker->busy = true;
+      pool->nr_running.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Work* work = pool->head;
+
+    if (work == nullptr) {
+      worker->busy = false;
+      worker->idle_since = timer::now();
+      worker->next_idle = pool->idle_list;
+
+      pool->idle_list = worker;
+      pool->nr_idle++;
+      pool->nr_running.fetch_sub(1, std::memory_order_relaxed);
+
+      const bool arm = (pool->nr_idle > 1) && !pool->idle_timer.is_active();
+      guard.unlock();
+
+      if (arm) {
+        pool->idle_timer.start_after(WORKER_IDLE_TIMEOUT_NS);
+      }
+
+      sched::block();
+      continue;
+    }
+
+    // About to run an item that may block: make sure a spare is idle or on
+    // its way. Only one is started at a time, as it goes idle only once it
+    // gets to run.
+    if ((pool->nr_idle == 0) && (pool->nr_starting == 0) &&
+        (pool->nr_workers < WORKERS_PER_POOL)) {
+      guard.unlock();
+      pool->create_worker();
+      continue;
+    }
+
+    pool->head = work->next;
+    if (pool->head == nullptr) {
+      pool->tail = &pool->head;
+    }
+
+    pool->stats.executed++;
+    guard.unlock();
+
+    // Cleared first, so the callback may queue the item again.
+    work->pending.store(false, std::memory_order_release);
+    work->func(work->cookie);
+  }
+}
+
+WorkerPoolStats WorkerPool::get_stats() const {
+  libs::LockGuard guard(this->lock);
+
+  WorkerPoolStats ret = this->stats;
+  ret.workers = this->nr_workers;
+  ret.idle = this->nr_idle;
+
+  return ret;
+}
+
+bool queue_work(Work* work) {
+  return pools[::arch::cpu_id()].enqueue(work);
+}
+
+bool queue_work_on(uint32_t cpu, Work* work) {
+  if (cpu >= MAX_CPUS) {
+    return false;
+  }
+
+  return pools[cpu].enqueue(work);
+}
+
+bool queue_unbound_work(Work* work) {
+  return unbound_pool.enqueue(work);
+}
+
+bool queue_delayed_work(DelayedWork* work, uint64_t delay, bool unbound) {
+  if (work->work.pending.exchange(true, std::memory_order_acq_rel)) {
+    return false;
+  }
+
+  work->pool = unbound ? &unbound_pool : &pools[::arch::cpu_id()];
+  work->timer.set_callback(DelayedWork::timer_expired, work);
+  work->timer.start_after(delay);
+
+  return true;
+}
+
+bool cancel_delayed_work(DelayedWork* work) {
+  if (!work->timer.cancel()) {
+    return false;
+  }
+
+  work->work.pending.store(false, std::memory_order_release);
+  return true;
+}
+
+WorkerPoolStats get_pool_stats(uint32_t cpu) {
+  if (cpu >= MAX_CPUS) {
+    return {};
+  }
+
+  return pools[cpu].get_stats();
+}
+
+WorkerPoolStats get_unbound_pool_stats() {
+  return unbound_pool.get_stats();
+}
+
+void worker_sleeping(Worker* worker) {
+  worker->pool->worker_sleeping(worker);
+}
+
+void worker_waking(Worker* worker) {
+  worker->pool->worker_waking(worker);
+}
+
+void initialize_workqueues() {
+  const uint32_t cpu = ::arch::cpu_id();
+  char name[THREAD_NAME_LENGTH];
+
+  snprintf(name, sizeof(name), "kworker/%u", cpu);
+  pools[cpu].initialize(name);
+
+  unbound_pool.initialize("kworker/u");
+
+  info("[WQ] Initialized, up to %d workers per pool", WORKERS_PER_POOL);
+}
+}  // namespace sched
@@ -0,0 +1,18 @@
+#include "timer/clock.hpp"
+
+namespace timer {
+ClockSource clock_source = {};
+
+void initialize_clock(uint64_t frequency) {
+  if (frequency == 0) {
+    return;
+  }
+
+  clock_source.ns_mult = static_cast<uint64_t>(
+      (static_cast<unsigned __int128>(NS_PER_SEC) << 32) / frequency);
+  clock_source.counter_mult = static_cast<uint64_t>(
+      (static_cast<unsigned __int128>(frequency) << 32) / NS_PER_SEC);
+  clock_source.base_counter = arch::read_counter();
+  clock_source.ready = true;
+}
+}  // namespace timer
@@ -0,0 +1,165 @@
+#include "arch/arch.hpp"
+#include "arch/timer.hpp"
+#include "log.hpp"
+#include "timer/clock.hpp"
+#include "timer/hrtimer.hpp"
+
+namespace timer {
+namespace {
+HrTimerQueue queues[MAX_CPUS];
+bool events_enabled = false;
+
+void handle_event() {
+  local_queue().run_expired();
+}
+}  // namespace
+
+void HrTimer::start(uint64_t deadline) {
+  this->cancel();
+  local_queue().enqueue(this, deadline);
+}
+
+void HrTimer::start_after(uint64_t delay) {
+  this->start(now() + delay);
+}
+
+bool HrTimer::cancel() {
+  HrTimerQueue* owner = this->queue;
+
+  if (owner == nullptr) {
+    return false;
+  }
+
+  return owner->dequeue(this);
+}
+
+void HrTimerQueue::initialize() {
+  this->head.prev = &this->head;
+  this->head.next = &this->head;
+  this->programmed = UINT64_MAX;
+  this->running = false;
+}
+
+void HrTimerQueue::unlink(HrTimer* timer) {
+  timer->prev->next = timer->next;
+  timer->next->prev = timer->prev;
+
+  timer->prev = nullptr;
+  timer->next = nullptr;
+  timer->queue = nullptr;
+}
+
+void HrTimerQueue::enqueue(HrTimer* timer, uint64_t deadline) {
+  libs::LockGuard guard(this->lock);
+
+  // Walk from the tail: periodic users re-arm with the latest deadline, so
+  // the insertion point is usually found in one step.
+  HrTimer* pos = this->head.prev;
+  while ((pos != &this->head) && (pos->deadline > deadline)) {
+    pos = pos->prev;
+  }
+
+  timer->deadline = deadline;
+  timer->queue = this;
+  timer->prev = pos;
+  timer->next = pos->next;
+
+  pos->next->prev = timer;
+  pos->next = timer;
+
+  if (!this->running && (deadline < this->programmed)) {
+    this->reprogram();
+  }
+}
+
+bool HrTimerQueue::dequeue(HrTimer* timer) {
+  libs::LockGuard guard(this->lock);
+
+  if (timer->queue != this) {
+    return false;
+  }
+
+  const bool was_first = (this->head.next == timer);
+  this->unlink(timer);
+
+  // Removing the programmed timer leaves a harmless early interrupt behind
+  // unless the hardware is moved to the new head.
+  if (!this->running && was_first) {
+    this->reprogram();
+  }
+
+  return true;
+}
+
+void HrTimerQueue::run_expired() {
+  libs::LockGuard guard(this->lock);
+
+  this->running = true;
+  this->programmed = UINT64_MAX;
+
+  uint64_t current = now();
+
+  while ((this->head.next != &this->head) &&
+         (this->head.next->deadline <= current)) {
+    HrTimer* timer = this->head.next;
+    this->unlink(timer);
+
+    HrTimerCallback callback = timer->callback;
+    void* cookie = timer->cookie;
+
+    // The callback may re-arm or cancel timers on this queue.
+    guard.unlock();
+    if (callback != nullptr) {
+      callback(timer, cookie);
+    }
+    guard.lock();
+
+    current = now();
+  }
+
+  this->running = false;
+  this->reprogram();
+}
+
+uint64_t HrTimerQueue::next_deadline() const {
+  libs::LockGuard guard(this->lock);
+
+  return (this->head.next != &this->head) ? this->head.next->deadline
+                                          : UINT64_MAX;
+}
+
+void HrTimerQueue::reprogram() {
+  if (!events_enabled) {
+    return;
+  }
+
+  if (this->head.next == &this->head) {
+    arch::clear_deadline();
+    this->programmed = UINT64_MAX;
+    return;
+  }
+
+  const uint64_t deadline = this->head.next->deadline;
+
+  if (deadline != this->programmed) {
+    arch::set_deadline(ns_to_counter(deadline));
+    this->programmed = deadline;
+  }
+}
+
+HrTimerQueue& local_queue() {
+  return queues[::arch::cpu_id()];
+}
+
+void initialize_hrtimers() {
+  for (HrTimerQueue& queue : queues) {
+    queue.initialize();
+  }
+
+  events_enabled = arch::enable_events(handle_event);
+}
+
+bool hrtimers_enabled() {
+  return events_enabled;
+}
+}  // namespace timer
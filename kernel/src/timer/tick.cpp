@@ -0,0 +1,146 @@
+#include "arch/arch.hpp"
+#include "irq/softirq.hpp"
+#include "log.hpp"
+#include "rcu/rcu.hpp"
+#include "timer/hrtimer.hpp"
+#include "timer/tick.hpp"
+#include "timer/wheel.hpp"
+
+#include <atomic>
+
+namespace timer {
+namespace {
+struct TickState {
+  HrTimer timer;
+  TickStats stats;
+
+  uint64_t idle_start;
+  bool stopped;
+  bool running;
+};
+
+TickState tick_states[MAX_CPUS];
+std::atomic<uint64_t> jiffies{0};
+
+TickState& local_tick() {
+  return tick_states[::arch::cpu_id()];
+}
+
+// Advance jiffies to cover `current`, whichever CPU gets there first.
+void update_jiffies(uint64_t current) {
+  const uint64_t target = current / TICK_NS;
+  uint64_t prev = jiffies.load(std::memory_order_relaxed);
+
+  while ((prev < target) &&
+         !jiffies.compare_exchange_weak(prev, target,
+                                        std::memory_order_relaxed)) {
+  }
+}
+
+// First tick boundary strictly after `current`.
+uint64_t next_tick_after(uint64_t current) {
+  return ((current / TICK_NS) + 1) * TICK_NS;
+}
+
+void tick_handler(HrTimer* timer, void*) {
+  TickState& state = local_tick();
+  const uint64_t current = now();
+
+  update_jiffies(current);
+  state.stats.ticks++;
+
+  // Wheel expiry is batched out of hard-IRQ context.
+  if (local_wheel().next_expiry() <= get_jiffies()) {
+    irq::raise_softirq(irq::softirqTimer);
+  }
+
+  rcu::check_callbacks();
+  log::kick();
+
+  uint64_t next = timer->get_deadline() + TICK_NS;
+
+  // Skip the ticks we slept through instead of replaying them back to back.
+  if (next <= current) {
+    next = next_tick_after(current);
+  }
+
+  timer->start(next);
+}
+}  // namespace
+
+uint64_t get_jiffies() {
+  return jiffies.load(std::memory_order_relaxed);
+}
+
+void start_tick() {
+  if (!hrtimers_enabled()) {
+    return;
+  }
+
+  TickState& state = local_tick();
+
+  state.timer.set_callback(tick_handler);
+  state.timer.start(next_tick_after(now()));
+  state.running = true;
+}
+
+void idle_enter() {
+  TickState& state = local_tick();
+
+  state.idle_start = now();
+  state.stats.idle_entries++;
+
+  if (!state.running) {
+    return;
+  }
+
+  // Take the tick out and see what else is pending. If nothing is due within
+  // the next tick period, leave it off and sleep until the next real event.
+  const uint64_t tick_deadline = state.timer.get_deadline();
+  state.timer.cancel();
+
+  const uint64_t wheel_tick = local_wheel().next_expiry();
+  const uint64_t wheel_next =
+      (wheel_tick != UINT64_MAX) ? (wheel_tick * TICK_NS) : UINT64_MAX;
+  const uint64_t next_event = local_queue().next_deadline();
+
+  // RCU callbacks in flight need the tick to make progress.
+  if ((next_event <= (state.idle_start + TICK_NS)) ||
+      (wheel_next <= (state.idle_start + TICK_NS)) || rcu::needs_cpu()) {
+    state.timer.start(tick_deadline);
+    return;
+  }
+
+  state.stopped = true;
+  state.stats.tick_stops++;
+
+  // The wheel only runs from the tick, so wake up for its next slot.
+  if (wheel_next != UINT64_MAX) {
+    state.timer.start(wheel_next);
+  }
+}
+
+void idle_exit() {
+  TickState& state = local_tick();
+  const uint64_t current = now();
+
+  state.stats.idle_ns += current - state.idle_start;
+
+  if (!state.stopped) {
+    return;
+  }
+
+  state.stopped = false;
+
+  update_jiffies(current);
+  state.timer.start(next_tick_after(current));
+}
+
+TickStats get_tick_stats(uint32_t cpu) {
+  if (cpu >= MAX_CPUS) {
+    return {};
+  }
+
+  return tick_states[cpu].stats;
+}
+}  // namespace timer
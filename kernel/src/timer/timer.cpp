@@ -0,0 +1,32 @@
+#include "arch/timer.hpp"
+#include "irq/softirq.hpp"
+#include "log.hpp"
+#include "timer/clock.hpp"
+#include "timer/hrtimer.hpp"
+#include "timer/tick.hpp"
+#include "timer/timer.hpp"
+#include "timer/wheel.hpp"
+
+namespace timer {
+void initialize() {
+  const uint64_t frequency = arch::initialize();
+
+  if (frequency == 0) {
+    err("[TIMER] Failed to calibrate the clock source");
+    return;
+  }
+
+  initialize_clock(frequency);
+  initialize_hrtimers();
+  initialize_wheels(get_jiffies());
+  irq::register_softirq(irq::softirqTimer, run_timer_softirq);
+
+  if (!hrtimers_enabled()) {
+    warning("[TIMER] No timer events, running without a tick");
+    return;
+  }
+
+  start_tick();
+  info("[TIMER] Tick: %u Hz, tickless idle enabled", TICK_HZ);
+}
+}  // namespace timer
@@ -0,0 +1,304 @@
+#include "arch/arch.hpp"
+#include "log.hpp"
+#include "timer/clock.hpp"
+#include "timer/tick.hpp"
+#include "timer/wheel.hpp"
+
+// Timeouts closer than this bypass the wheel and use an hrtimer directly.
+#define WHEEL_PRECISE_NS (2 * TICK_NS)
+// Marks a timer that sits on the expired list instead of a wheel slot.
+#define WHEEL_LEVEL_EXPIRED 0xff
+
+namespace timer {
+namespace {
+TimerWheel wheels[MAX_CPUS];
+
+inline void link_init(TimerLink* head) {
+  head->prev = head;
+  head->next = head;
+}
+
+inline bool link_empty(const TimerLink* head) {
+  return head->next == head;
+}
+
+inline void link_add_tail(TimerLink* head, TimerLink* node) {
+  node->next = head;
+  node->prev = head->prev;
+
+  head->prev->next = node;
+  head->prev = node;
+}
+
+inline void link_remove(TimerLink* node) {
+  node->prev->next = node->next;
+  node->next->prev = node->prev;
+
+  node->prev = nullptr;
+  node->next = nullptr;
+}
+
+// Move every node from `from` onto the (empty) list `to`.
+inline void link_splice(TimerLink* from, TimerLink* to) {
+  if (link_empty(from)) {
+    link_init(to);
+    return;
+  }
+
+  to->next = from->next;
+  to->prev = from->prev;
+
+  to->next->prev = to;
+  to->prev->next = to;
+
+  link_init(from);
+}
+
+inline Timer* to_timer(TimerLink* link) {
+  return reinterpret_cast<Timer*>(link);
+}
+
+inline uint64_t rotate_right(uint64_t bits, unsigned shift) {
+  return (shift == 0) ? bits : ((bits >> shift) | (bits << (64 - shift)));
+}
+}  // namespace
+
+void Timer::start(uint64_t deadline) {
+  this->cancel();
+
+  if (deadline < (now() + WHEEL_PRECISE_NS)) {
+    this->hrtimer.set_callback(hrtimer_expired, this);
+    this->hrtimer.start(deadline);
+    return;
+  }
+
+  // Round up so the timer never fires early.
+  local_wheel().enqueue(this, (deadline + TICK_NS - 1) / TICK_NS);
+}
+
+void Timer::start_after(uint64_t delay) {
+  this->start(now() + delay);
+}
+
+bool Timer::cancel() {
+  bool was_active = this->hrtimer.cancel();
+  TimerWheel* owner = this->wheel;
+
+  if (owner != nullptr) {
+    was_active |= owner->dequeue(this);
+  }
+
+  return was_active;
+}
+
+void Timer::hrtimer_expired(HrTimer*, void* cookie) {
+  Timer* timer = static_cast<Timer*>(cookie);
+
+  if (timer->callback != nullptr) {
+    timer->callback(timer, timer->cookie);
+  }
+}
+
+void TimerWheel::initialize(uint64_t start_tick) {
+  for (auto& level : this->slots) {
+    for (TimerLink& slot : level) {
+      link_init(&slot);
+    }
+  }
+
+  for (uint64_t& bits : this->occupied) {
+    bits = 0;
+  }
+
+  link_init(&this->expired);
+
+  this->clock = start_tick;
+  this->pending = 0;
+}
+
+void TimerWheel::insert(Timer* timer) {
+  uint64_t expires = (timer->expires > this->clock) ? timer->expires
+                                                    : this->clock;
+  uint64_t delta = expires - this->clock;
+
+  // Park far-off timers at the edge of the wheel; they are re-filed each
+  // time their slot cascades until they come within range.
+  if (delta > WHEEL_MAX_TICKS) {
+    delta = WHEEL_MAX_TICKS;
+    expires = this->clock + delta;
+  }
+
+  uint8_t level = 0;
+  while ((level < (WHEEL_LEVELS - 1)) &&
+         (delta >= (1ull << (WHEEL_SLOT_BITS * (level + 1))))) {
+    level++;
+  }
+
+  const uint8_t slot =
+      (expires >> (WHEEL_SLOT_BITS * level)) & (WHEEL_SLOTS - 1);
+
+  timer->level = level;
+  timer->slot = slot;
+
+  link_add_tail(&this->slots[level][slot], &timer->link);
+  this->occupied[level] |= (1ull << slot);
+}
+
+void TimerWheel::unlink(Timer* timer) {
+  link_remove(&timer->link);
+  timer->wheel = nullptr;
+  this->pending--;
+
+  if (timer->level == WHEEL_LEVEL_EXPIRED) {
+    return;
+  }
+
+  if (link_empty(&this->slots[timer->level][timer->slot])) {
+    this->occupied[timer->level] &= ~(1ull << timer->slot);
+  }
+}
+
+void TimerWheel::enqueue(Timer* timer, uint64_t expires) {
+  libs::LockGuard guard(this->lock);
+
+  timer->wheel = this;
+  timer->expires = expires;
+
+  this->insert(timer);
+  this->pending++;
+}
+
+bool TimerWheel::dequeue(Timer* timer) {
+  libs::LockGuard guard(this->lock);
+
+  if (timer->wheel != this) {
+    return false;
+  }
+
+  this->unlink(timer);
+  return true;
+}
+
+void TimerWheel::cascade(uint8_t level, uint8_t slot) {
+  TimerLink list;
+  link_splice(&this->slots[level][slot], &list);
+  this->occupied[level] &= ~(1ull << slot);
+
+  while (!link_empty(&list)) {
+    Timer* timer = to_timer(list.next);
+
+    link_remove(&timer->link);
+    this->insert(timer);
+  }
+}
+
+void TimerWheel::expire(uint8_t slot) {
+  TimerLink* head = &this->slots[0][slot];
+
+  while (!link_empty(head)) {
+    Timer* timer = to_timer(head->next);
+
+    link_remove(&timer->link);
+    timer->level = WHEEL_LEVEL_EXPIRED;
+    link_add_tail(&this->expired, &timer->link);
+  }
+
+  this->occupied[0] &= ~(1ull << slot);
+}
+
+void TimerWheel::advance(uint64_t target) {
+  libs::LockGuard guard(this->lock);
+
+  while (this->clock <= target) {
+    // Jump straight to the next tick with work instead of walking every
+    // empty slot; after a long tickless idle that is most of them.
+    const uint64_t next = this->next_expiry_locked();
+
+    if (next > target) {
+      this->clock = target + 1;
+      break;
+    }
+
+    this->clock = next;
+
+    for (uint8_t level = 1; level < WHEEL_LEVELS; ++level) {
+      const uint8_t shift = WHEEL_SLOT_BITS * level;
+
+      if ((this->clock & ((1ull << shift) - 1)) != 0) {
+        break;
+      }
+
+      this->cascade(level, (this->clock >> shift) & (WHEEL_SLOTS - 1));
+    }
+
+    this->expire(this->clock & (WHEEL_SLOTS - 1));
+    this->clock++;
+
+    // Run the batch with the lock dropped around each callback, so they can
+    // re-arm or cancel timers (including ones later in this batch).
+    while (!link_empty(&this->expired)) {
+      Timer* timer = to_timer(this->expired.next);
+      this->unlink(timer);
+
+      TimerCallback callback = timer->callback;
+      void* cookie = timer->cookie;
+
+      guard.unlock();
+      if (callback != nullptr) {
+        callback(timer, cookie);
+      }
+      guard.lock();
+    }
+  }
+}
+
+uint64_t TimerWheel::next_expiry_locked() const {
+  uint64_t best = UINT64_MAX;
+
+  for (uint8_t level = 0; level < WHEEL_LEVELS; ++level) {
+    if (this->occupied[level] == 0) {
+      continue;
+    }
+
+    const uint8_t shift = WHEEL_SLOT_BITS * level;
+    const uint64_t base = this->clock >> shift;
+    const uint64_t bits =
+        rotate_right(this->occupied[level], base & (WHEEL_SLOTS - 1));
+
+    uint64_t distance = __builtin_ctzll(bits);
+
+    // Level 0 slots hold exact expiries. Higher level slots need attention
+    // when they cascade, which for the current slot is one full revolution
+    // away unless the clock sits exactly on its boundary.
+    if ((distance == 0) && (level != 0) &&
+        ((this->clock & ((1ull << shift) - 1)) != 0)) {
+      const uint64_t later = bits & ~1ull;
+      distance = (later != 0) ? __builtin_ctzll(later) : WHEEL_SLOTS;
+    }
+
+    const uint64_t expiry = (base + distance) << shift;
+    best = (expiry < best) ? expiry : best;
+  }
+
+  return best;
+}
+
+uint64_t TimerWheel::next_expiry() const {
+  libs::LockGuard guard(this->lock);
+  return this->next_expiry_locked();
+}
+
+TimerWheel& local_wheel() {
+  return wheels[::arch::cpu_id()];
+}
+
+void run_timer_softirq() {
+  local_wheel().advance(get_jiffies());
+}
+
+void initialize_wheels(uint64_t start_tick) {
+  for (TimerWheel& wheel : wheels) {
+    wheel.initialize(start_tick);
+  }
+}
+}  // namespace timer
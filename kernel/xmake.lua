@@ -67,3 +67,27 @@ target("noise.elf")
 
     on_run(function (target)
     end)
+
+-- Host build of the physical allocator and page-table code, replaying
+-- allocation and mapping traces against a synthetic memory map:
+--   xmake build memory-sim && xmake run memory-sim [options] [trace...]
+target("memory-sim")
+    set_default(false)
+    set_kind("binary")
+    set_plat(os.host())
+    set_arch(os.arch())
+    set_toolchains("gcc")
+    set_optimize("fastest")
+
+    add_files("bench/memory.cpp")
+    add_files("src/memory/physical.cpp", "src/memory/pagemap.cpp")
+    add_files("src/arch/x86_64/memory/paging.cpp")
+    -- The hosted stand-ins come first so they shadow the kernel's log,
+    -- workqueue, CPU and arch headers.
+    add_includedirs("bench/include", "../libs/bench/include")
+    add_includedirs("include", "../libs/include")
+    add_deps("limine-headers")
+    add_defines("LIMINE_API_REVISION=2")
+    add_cxflags("-masm=intel", "-fno-strict-aliasing")
+    -- The kernel's log namespace would otherwise clash with libm's log().
+    add_cxflags("-fno-builtin-log")
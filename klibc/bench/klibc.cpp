@@ -0,0 +1,261 @@
+// Host checks and benchmarks for klibc, linked against klibc-host (klibc
+// built for Linux with klibc_-prefixed symbols). Every mem*/str* routine is
+// compared against the host libc over edge-case sizes and alignments, with
+// each string-op feature combination, then timed next to the host libc.
+//
+// Usage: klibc-bench [--check-only]
+
+#include "klibc.hpp"
+#include "microbench.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <initializer_list>
+
+// The host strncat/strncpy reference calls truncate on purpose.
+#pragma GCC diagnostic ignored "-Wstringop-truncation"
+
+#define BUFFER_SIZE 8192
+// Bytes around every destination that must come out untouched.
+#define GUARD 32
+
+namespace {
+using namespace microbench;
+
+alignas(64) uint8_t src_buf[BUFFER_SIZE + 2 * GUARD];
+alignas(64) uint8_t dest_buf[BUFFER_SIZE + 2 * GUARD];
+alignas(64) uint8_t want_buf[BUFFER_SIZE + 2 * GUARD];
+
+constexpr unsigned int feature_sets[] = {
+    0,
+    KLIBC_STRING_FEATURE_ERMS,
+    KLIBC_STRING_FEATURE_ERMS | KLIBC_STRING_FEATURE_FSRM |
+        KLIBC_STRING_FEATURE_FSRS,
+};
+
+// Every size up to 300, which covers all the small-size classes and the
+// rep threshold, and a few larger ones with odd tails.
+constexpr bool interesting(size_t len) {
+  return len <= 300 || len == 1024 || len == 4095 || len == 4096 ||
+         len == 4097 || len == BUFFER_SIZE - 16 - 1;
+}
+
+int sign(int value) {
+  return (value > 0) - (value < 0);
+}
+
+void fill(uint8_t* buf, size_t len, uint8_t seed) {
+  for (size_t i = 0; i < len; ++i) {
+    buf[i] = static_cast<uint8_t>(seed + i * 131 + (i >> 8));
+  }
+}
+
+void check_mem() {
+  for (size_t len = 0; len < BUFFER_SIZE - 16; ++len) {
+    if (!interesting(len)) {
+      continue;
+    }
+
+    for (size_t src_off = 0; src_off < 16; src_off += 3) {
+      for (size_t dest_off = 0; dest_off < 16; dest_off += 5) {
+        uint8_t* src = src_buf + GUARD + src_off;
+        uint8_t* dest = dest_buf + GUARD + dest_off;
+        uint8_t* want = want_buf + GUARD + dest_off;
+
+        fill(src_buf, sizeof(src_buf), 1);
+        fill(dest_buf, sizeof(dest_buf), 2);
+        fill(want_buf, sizeof(want_buf), 2);
+
+        BENCH_CHECK(klibc_memcpy(dest, src, len) == dest);
+        memcpy(want, src, len);
+        BENCH_CHECK(memcmp(dest_buf, want_buf, sizeof(dest_buf)) == 0);
+
+        BENCH_CHECK(klibc_memset(dest, 0xa5, len) == dest);
+        memset(want, 0xa5, len);
+        BENCH_CHECK(memcmp(dest_buf, want_buf, sizeof(dest_buf)) == 0);
+
+        // Overlapping moves in both directions within one buffer.
+        fill(dest_buf, sizeof(dest_buf), 3);
+        fill(want_buf, sizeof(want_buf), 3);
+        BENCH_CHECK(klibc_memmove(dest, dest + src_off, len) == dest);
+        memmove(want, want + src_off, len);
+        BENCH_CHECK(memcmp(dest_buf, want_buf, sizeof(dest_buf)) == 0);
+
+        BENCH_CHECK(klibc_memmove(dest + src_off, dest, len) ==
+                    dest + src_off);
+        memmove(want + src_off, want, len);
+        BENCH_CHECK(memcmp(dest_buf, want_buf, sizeof(dest_buf)) == 0);
+
+        // memcmp: equal, then a difference at the start, middle and end.
+        memcpy(dest, src, len);
+        BENCH_CHECK(klibc_memcmp(dest, src, len) == 0);
+
+        for (size_t at : {size_t{0}, len / 2, len - 1}) {
+          if (len == 0) {
+            break;
+          }
+
+          dest[at] ^= 0x80;
+          BENCH_CHECK(sign(klibc_memcmp(dest, src, len)) ==
+                      sign(memcmp(dest, src, len)));
+          dest[at] ^= 0x80;
+        }
+      }
+    }
+  }
+}
+
+void check_str() {
+  char a[512];
+  char b[512];
+  char out[1024];
+  char want[1024];
+
+  for (size_t len = 0; len < 300; ++len) {
+    for (size_t off = 0; off < 8; ++off) {
+      char* s = a + off;
+
+      for (size_t i = 0; i < len; ++i) {
+        s[i] = static_cast<char>('a' + i % 26);
+      }
+
+      s[len] = '\0';
+
+      BENCH_CHECK(klibc_strlen(s) == len);
+
+      for (size_t max : {size_t{0}, len / 2, len, len + 1, len + 9}) {
+        BENCH_CHECK(klibc_strnlen(s, max) == strnlen(s, max));
+      }
+
+      for (int ch : {0, int{'a'}, int{'z'}, int{'#'}}) {
+        BENCH_CHECK(klibc_strchr(s, ch) == strchr(s, ch));
+      }
+
+      // Compare against a copy at another alignment, equal and with one
+      // byte changed.
+      char* t = b + (off * 3) % 8;
+      memcpy(t, s, len + 1);
+      BENCH_CHECK(klibc_strcmp(s, t) == 0);
+      BENCH_CHECK(klibc_strncmp(s, t, len + 4) == 0);
+
+      if (len != 0) {
+        t[len / 2] = '~';
+        BENCH_CHECK(sign(klibc_strcmp(s, t)) == sign(strcmp(s, t)));
+        BENCH_CHECK(sign(klibc_strncmp(s, t, len)) ==
+                    sign(strncmp(s, t, len)));
+        BENCH_CHECK(klibc_strncmp(s, t, len / 2) == 0);
+        t[len / 2] = s[len / 2];
+      }
+
+      memset(out, 0x55, sizeof(out));
+      memset(want, 0x55, sizeof(want));
+      BENCH_CHECK(klibc_strcpy(out, s) == out);
+      strcpy(want, s);
+      BENCH_CHECK(memcmp(out, want, sizeof(out)) == 0);
+
+      BENCH_CHECK(klibc_strcat(out, s) == out);
+      strcat(want, s);
+      BENCH_CHECK(memcmp(out, want, sizeof(out)) == 0);
+
+      BENCH_CHECK(klibc_strncat(out, s, len / 3) == out);
+      strncat(want, s, len / 3);
+      BENCH_CHECK(memcmp(out, want, sizeof(out)) == 0);
+
+      memset(out, 0x55, sizeof(out));
+      memset(want, 0x55, sizeof(want));
+      BENCH_CHECK(klibc_strncpy(out, s, len + 7) == out);
+      strncpy(want, s, len + 7);
+      BENCH_CHECK(memcmp(out, want, sizeof(out)) == 0);
+    }
+  }
+}
+
+void bench_mem(size_t len) {
+  char name[64];
+  uint8_t* src = src_buf + GUARD;
+  uint8_t* dest = dest_buf + GUARD;
+
+  snprintf(name, sizeof(name), "memcpy  %5zu klibc", len);
+  measure(name, len, [&] {
+    keep(dest);
+    klibc_memcpy(dest, src, len);
+  });
+  snprintf(name, sizeof(name), "memcpy  %5zu host", len);
+  measure(name, len, [&] {
+    keep(dest);
+    memcpy(dest, src, len);
+  });
+
+  snprintf(name, sizeof(name), "memset  %5zu klibc", len);
+  measure(name, len, [&] {
+    keep(dest);
+    klibc_memset(dest, 0, len);
+  });
+  snprintf(name, sizeof(name), "memset  %5zu host", len);
+  measure(name, len, [&] {
+    keep(dest);
+    memset(dest, 0, len);
+  });
+
+  memcpy(dest, src, len);
+
+  snprintf(name, sizeof(name), "memcmp  %5zu klibc", len);
+  measure(name, len, [&] {
+    keep(dest);
+    keep(klibc_memcmp(dest, src, len));
+  });
+  snprintf(name, sizeof(name), "memcmp  %5zu host", len);
+  measure(name, len, [&] {
+    keep(dest);
+    keep(memcmp(dest, src, len));
+  });
+}
+
+void bench_str(size_t len) {
+  static char s[4096];
+  char name[64];
+
+  memset(s, 'x', len);
+  s[len] = '\0';
+
+  snprintf(name, sizeof(name), "strlen  %5zu klibc", len);
+  measure(name, len, [&] {
+    keep(s);
+    keep(klibc_strlen(s));
+  });
+  snprintf(name, sizeof(name), "strlen  %5zu host", len);
+  measure(name, len, [&] {
+    keep(s);
+    keep(strlen(s));
+  });
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  for (unsigned int features : feature_sets) {
+    klibc_string_set_features(features);
+    check_mem();
+  }
+
+  klibc_string_set_features(0);
+  check_str();
+
+  if (argc > 1 && strcmp(argv[1], "--check-only") == 0) {
+    return finish();
+  }
+
+  // The kernel enables whatever the CPU reports; assume a recent one here.
+  klibc_string_set_features(KLIBC_STRING_FEATURE_ERMS |
+                            KLIBC_STRING_FEATURE_FSRM);
+
+  for (size_t len : {16, 64, 256, 4096}) {
+    bench_mem(len);
+  }
+
+  for (size_t len : {8, 64, 1024}) {
+    bench_str(len);
+  }
+
+  return finish();
+}
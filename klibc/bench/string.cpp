@@ -0,0 +1,221 @@
+// klibc string routine check and benchmark. The word-at-a-time scanners
+// are run against the byte loops they replaced, first for correctness
+// (every alignment and length, with strings ending right before an
+// unmapped page) and then for speed on short and long strings.
+//
+// Usage: string-bench [iterations]
+
+#include "../src/utils/string.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <chrono>
+
+#define MAX_LEN 256
+
+namespace {
+// The previous byte-at-a-time implementations, as the baseline.
+size_t byte_strlen(const char* str) {
+  const char* s = str;
+
+  while (*s) {
+    s++;
+  }
+
+  return s - str;
+}
+
+size_t byte_strnlen(const char* str, size_t max_len) {
+  size_t i = 0;
+
+  while ((i < max_len) && str[i]) {
+    i++;
+  }
+
+  return i;
+}
+
+char* byte_strchr(const char* str, int ch) {
+  do {
+    if (*str == static_cast<char>(ch)) {
+      return const_cast<char*>(str);
+    }
+  } while (*str++);
+
+  return nullptr;
+}
+
+int byte_strcmp(const char* str1, const char* str2) {
+  const uint8_t* s1 = reinterpret_cast<const uint8_t*>(str1);
+  const uint8_t* s2 = reinterpret_cast<const uint8_t*>(str2);
+
+  while (*s1 && (*s1 == *s2)) {
+    s1++;
+    s2++;
+  }
+
+  return *s1 - *s2;
+}
+
+int byte_memcmp(const void* src1, const void* src2, size_t len) {
+  const uint8_t* a = static_cast<const uint8_t*>(src1);
+  const uint8_t* b = static_cast<const uint8_t*>(src2);
+
+  while ((len > 0) && (*a == *b)) {
+    a++;
+    b++;
+    len--;
+  }
+
+  return (len == 0) ? 0 : *a - *b;
+}
+
+int sign(int value) {
+  return (value > 0) - (value < 0);
+}
+
+// Two buffers, each directly followed by an inaccessible page.
+struct Guarded {
+  char* first;
+  char* second;
+  size_t page;
+
+  Guarded() : page(sysconf(_SC_PAGESIZE)) {
+    auto* map = static_cast<char*>(mmap(nullptr, 4 * page,
+                                        PROT_READ | PROT_WRITE,
+                                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    mprotect(map + page, page, PROT_NONE);
+    mprotect(map + 3 * page, page, PROT_NONE);
+    this->first = map;
+    this->second = map + 2 * page;
+  }
+
+  // A string of `len` bytes plus terminator ending at the guard page.
+  static char* place(char* buffer, size_t page, size_t len, char fill) {
+    char* str = buffer + page - len - 1;
+
+    for (size_t i = 0; i < len; ++i) {
+      str[i] = static_cast<char>(fill + i % 23);
+    }
+
+    str[len] = '\0';
+    return str;
+  }
+};
+
+bool check() {
+  Guarded guarded;
+  bool ok = true;
+
+  for (size_t len = 0; len < MAX_LEN; ++len) {
+    char* a = Guarded::place(guarded.first, guarded.page, len, 'a');
+
+    ok &= internal::word_strlen(a) == len;
+
+    for (size_t max = 0; max < len + 16; ++max) {
+      ok &= internal::word_strnlen(a, max) == byte_strnlen(a, max);
+    }
+
+    for (int ch : {0, int{'a'}, 'a' + 22, int{'z'}, 0xff}) {
+      ok &= internal::word_strchr(a, ch) == byte_strchr(a, ch);
+    }
+
+    // Same contents at a different alignment, with one byte changed at
+    // every position in turn.
+    for (size_t shift = 0; shift < 8; ++shift) {
+      char* b = Guarded::place(guarded.second, guarded.page, len + shift,
+                               'a' - static_cast<char>(shift));
+      b += shift;
+      ok &= sign(internal::word_strcmp(a, b)) == sign(byte_strcmp(a, b));
+      ok &= internal::word_memcmp(a, b, len) == byte_memcmp(a, b, len);
+
+      for (size_t i = 0; i < len; ++i) {
+        const char saved = b[i];
+        b[i] = static_cast<char>(saved + 1 + i % 3);
+        ok &= sign(internal::word_strcmp(a, b)) == sign(byte_strcmp(a, b));
+        ok &= sign(internal::word_memcmp(a, b, len)) ==
+              sign(byte_memcmp(a, b, len));
+        b[i] = saved;
+      }
+    }
+  }
+
+  return ok;
+}
+
+template <typename Fn>
+void run(const char* name, size_t len, size_t iterations, Fn fn) {
+  static char a[4096];
+  static char b[4096];
+
+  for (size_t i = 0; i < len; ++i) {
+    a[i] = b[i] = static_cast<char>('a' + i % 23);
+  }
+
+  a[len] = b[len] = '\0';
+
+  size_t sink = 0;
+  const auto start = std::chrono::steady_clock::now();
+
+  for (size_t i = 0; i < iterations; ++i) {
+    asm volatile("" ::"r"(a), "r"(b) : "memory");
+    sink += fn(a, b, len);
+  }
+
+  const double ns = std::chrono::duration<double, std::nano>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+
+  asm volatile("" ::"r"(sink));
+  printf("%-8s %5zu bytes %8.2f ns\n", name, len, ns / iterations);
+}
+
+void bench(size_t len, size_t iterations) {
+  using namespace internal;
+
+  run("strlen", len, iterations, [](auto a, auto, size_t) {
+    return byte_strlen(a);
+  });
+  run("  word", len, iterations, [](auto a, auto, size_t) {
+    return word_strlen(a);
+  });
+  run("strchr", len, iterations, [](auto a, auto, size_t) {
+    return reinterpret_cast<uintptr_t>(byte_strchr(a, '!'));
+  });
+  run("  word", len, iterations, [](auto a, auto, size_t) {
+    return reinterpret_cast<uintptr_t>(word_strchr(a, '!'));
+  });
+  run("strcmp", len, iterations, [](auto a, auto b, size_t) {
+    return static_cast<size_t>(byte_strcmp(a, b));
+  });
+  run("  word", len, iterations, [](auto a, auto b, size_t) {
+    return static_cast<size_t>(word_strcmp(a, b));
+  });
+  run("memcmp", len, iterations, [](auto a, auto b, size_t n) {
+    return static_cast<size_t>(byte_memcmp(a, b, n));
+  });
+  run("  word", len, iterations, [](auto a, auto b, size_t n) {
+    return static_cast<size_t>(word_memcmp(a, b, n));
+  });
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t iterations = 1000000;
+
+  if (argc > 1) {
+    iterations = strtoull(argv[1], nullptr, 10);
+  }
+
+  const bool ok = check();
+  printf("check %s\n", ok ? "ok" : "FAILED");
+
+  for (size_t len : {7, 32, 200, 4000}) {
+    bench(len, len > 1000 ? iterations / 20 : iterations);
+  }
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,33 @@
+#ifndef KLIBC_HOST_KLIBC_HPP
+#define KLIBC_HOST_KLIBC_HPP 1
+
+// Host-side view of klibc-host. Include this instead of klibc's own headers,
+// which would shadow the host libc ones.
+
+#include <stddef.h>
+
+extern "C" {
+void* klibc_memcpy(void* dest, const void* src, size_t len);
+void* klibc_memmove(void* dest, const void* src, size_t len);
+void* klibc_memset(void* dest, int ch, size_t len);
+int klibc_memcmp(const void* src1, const void* src2, size_t len);
+
+char* klibc_strcpy(char* dest, const char* src);
+char* klibc_strncpy(char* dest, const char* src, size_t max_size);
+char* klibc_strcat(char* dest, const char* src);
+char* klibc_strncat(char* dest, const char* src, size_t max_size);
+int klibc_strcmp(const char* str1, const char* str2);
+int klibc_strncmp(const char* str1, const char* str2, size_t max_size);
+size_t klibc_strlen(const char* str);
+size_t klibc_strnlen(const char* str, size_t max_len);
+char* klibc_strchr(const char* str, int ch);
+
+// STRING_FEATURE_* values from klibc's string.h.
+#define KLIBC_STRING_FEATURE_ERMS (1u << 0)
+#define KLIBC_STRING_FEATURE_FSRM (1u << 1)
+#define KLIBC_STRING_FEATURE_FSRS (1u << 2)
+
+void klibc_string_set_features(unsigned int features);
+}
+
+#endif  // KLIBC_HOST_KLIBC_HPP
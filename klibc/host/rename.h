@@ -0,0 +1,40 @@
+#ifndef KLIBC_HOST_RENAME_H
+#define KLIBC_HOST_RENAME_H 1
+
+// Force-included into the host build of klibc. Every exported symbol gets a
+// klibc_ prefix so the library can be linked next to the host libc and
+// compared against it.
+
+#define memcpy klibc_memcpy
+#define memmove klibc_memmove
+#define memset klibc_memset
+#define memcmp klibc_memcmp
+#define strcpy klibc_strcpy
+#define strncpy klibc_strncpy
+#define strcat klibc_strcat
+#define strncat klibc_strncat
+#define strcmp klibc_strcmp
+#define strncmp klibc_strncmp
+#define strlen klibc_strlen
+#define strnlen klibc_strnlen
+#define strchr klibc_strchr
+#define string_set_features klibc_string_set_features
+
+#define isalnum klibc_isalnum
+#define isascii klibc_isascii
+#define isalpha klibc_isalpha
+#define isblank klibc_isblank
+#define iscntrl klibc_iscntrl
+#define isdigit klibc_isdigit
+#define isgraph klibc_isgraph
+#define islower klibc_islower
+#define isprint klibc_isprint
+#define ispunct klibc_ispunct
+#define isspace klibc_isspace
+#define isupper klibc_isupper
+#define isxdigit klibc_isxdigit
+#define tolower klibc_tolower
+#define toupper klibc_toupper
+#define toascii klibc_toascii
+
+#endif  // KLIBC_HOST_RENAME_H
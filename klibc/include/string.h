@@ -40,6 +40,15 @@ __attribute__((nonnull(1)));
 char* strchr(const char* str, int ch) __attribute__((pure))
 __attribute__((nonnull(1)));
 
+// Non-standard. String instructions the CPU runs fast, as reported by
+// CPUID; mem*() pick their large-size path from these. Set once at boot,
+// before other CPUs start.
+#define STRING_FEATURE_ERMS (1u << 0)  // Enhanced rep movsb/stosb
+#define STRING_FEATURE_FSRM (1u << 1)  // Fast short rep movsb
+#define STRING_FEATURE_FSRS (1u << 2)  // Fast short rep stosb
+
+void string_set_features(unsigned int features);
+
 #ifdef __cplusplus
 }
 #endif
@@ -9,9 +9,21 @@ void* memcpy(void* restrict dest, const void* restrict src, size_t len) {
   uintptr_t destp = reinterpret_cast<uintptr_t>(dest);
   uintptr_t srcp = reinterpret_cast<uintptr_t>(src);
 
+  if (len <= small_max) {
+    copy_small(destp, srcp, len);
+    return dest;
+  }
+
+#ifdef __x86_64__
+  if (use_rep_movsb(len)) {
+    rep_movsb(destp, srcp, len);
+    return dest;
+  }
+#endif
+
   if (len >= threshold) {
     len -= (-destp) % sizeof(qword_t);
-    BYTE_COPY_FORWARD(destp, srcp, len);
+    BYTE_COPY_FORWARD(destp, srcp, (-destp) % sizeof(qword_t));
     COPY_FORWARD(destp, srcp, len, len);
   }
 
@@ -7,16 +7,21 @@ void* memset(void* dest, int ch, size_t len) {
   using namespace internal;
 
   uintptr_t destp = reinterpret_cast<uintptr_t>(dest);
+  const qword_t word = broadcast(static_cast<uint8_t>(ch));
 
-  if (len >= 8) {
-    size_t word = static_cast<uint8_t>(ch);
-    word |= word << 8;
-    word |= word << 16;
+  if (len <= small_max) {
+    set_small(destp, word, len);
+    return dest;
+  }
 
-    if (sizeof(qword_t) > sizeof(uint32_t)) {
-      word |= (word << 16) << 16;
-    }
+#ifdef __x86_64__
+  if (use_rep_stosb(len)) {
+    rep_stosb(destp, static_cast<uint8_t>(ch), len);
+    return dest;
+  }
+#endif
 
+  if (len >= 8) {
     while (reinterpret_cast<uintptr_t>(destp) % sizeof(size_t) != 0) {
       *reinterpret_cast<uint8_t*>(destp) = ch;
       destp++;
@@ -6,9 +6,10 @@ char* strcat(char* restrict dest, const char* restrict src) {
 }
 
 char* strncat(char* restrict dest, const char* restrict src, size_t max_size) {
+  char* end = dest + strlen(dest);
   size_t size = strnlen(src, max_size);
-  memcpy(dest + strlen(dest), src, size);
-  dest[size] = '\0';
+  memcpy(end, src, size);
+  end[size] = '\0';
 
   return dest;
 }
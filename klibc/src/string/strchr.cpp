@@ -1,11 +1,7 @@
+#include "../utils/string.hpp"
+
 #include <string.h>
 
 char* strchr(const char* str, int ch) {
-  do {
-    if (*str == ch) {
-      return const_cast<char*>(str);
-    }
-  } while (*str++);
-
-  return nullptr;
+  return internal::word_strchr(str, ch);
 }
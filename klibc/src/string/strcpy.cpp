@@ -1,15 +1,7 @@
 #include <string.h>
 
 char* strcpy(char* str1, const char* str2) {
-  char* ret = str1;
-
-  while (*str1 != '\0') {
-    *str1 = *str2;
-    str1++;
-    str2++;
-  }
-
-  return ret;
+  return reinterpret_cast<char*>(memcpy(str1, str2, strlen(str2) + 1));
 }
 
 char* strncpy(char* str1, const char* str2, size_t max_size) {
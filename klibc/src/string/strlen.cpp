@@ -1,21 +1,11 @@
+#include "../utils/string.hpp"
+
 #include <string.h>
 
 size_t strlen(const char* str) {
-  const char* s = str;
-
-  while (*s) {
-    s++;
-  }
-
-  return s - str;
+  return internal::word_strlen(str);
 }
 
 size_t strnlen(const char* str, size_t max_len) {
-  size_t i = 0;
-
-  while ((i < max_len) && *str) {
-    i++;
-  }
-
-  return i;
+  return internal::word_strnlen(str, max_len);
 }
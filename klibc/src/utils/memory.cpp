@@ -1,6 +1,8 @@
 #include "memory.hpp"
 
 namespace internal {
+unsigned int string_features = 0;
+
 void copy_forward_aligned(uintptr_t dest, uintptr_t src, size_t len) {
   qword_t a, b;
 
@@ -352,3 +354,7 @@ exit:
   reinterpret_cast<qword_t *>(dest)[3] = merge(a, shift_1, b, shift_2);
 }
 }  // namespace internal
+
+void string_set_features(unsigned int features) {
+  internal::string_features = features;
+}
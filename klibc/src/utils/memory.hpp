@@ -1,18 +1,101 @@
 #ifndef STRING_UTILS_MEMORY_HPP
 #define STRING_UTILS_MEMORY_HPP
 
+#include "word.hpp"
+
 #include <stddef.h>
 #include <stdint.h>
-
-#if (__BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__) && \
-    (__BYTE_ORDER__ != __ORDER_BIG_ENDIAN__)
-#error Unknown Endianness Detected!
-#endif
+#include <string.h>
 
 namespace internal {
-using qword_t = size_t;
 constexpr int threshold = sizeof(qword_t) * 2;
 
+// Sizes up to this are done with a few overlapping loads and stores.
+constexpr size_t small_max = 4 * sizeof(qword_t);
+// With ERMS but without FSRM, rep movsb/stosb only pays off from here on.
+constexpr size_t rep_threshold = 256;
+
+// STRING_FEATURE_* bits, set once at boot.
+extern unsigned int string_features __attribute__((visibility("hidden")));
+
+// Copy up to `small_max` bytes. The head and tail accesses overlap instead
+// of looping over the remainder, and every load happens before the first
+// store, so overlapping buffers are fine too.
+inline void copy_small(uintptr_t dest, uintptr_t src, size_t len) {
+  if (len >= 2 * sizeof(qword_t)) {
+    const qword_t a = load<qword_t>(src);
+    const qword_t b = load<qword_t>(src + sizeof(qword_t));
+    const qword_t c = load<qword_t>(src + len - 2 * sizeof(qword_t));
+    const qword_t d = load<qword_t>(src + len - sizeof(qword_t));
+
+    store(dest, a);
+    store(dest + sizeof(qword_t), b);
+    store(dest + len - 2 * sizeof(qword_t), c);
+    store(dest + len - sizeof(qword_t), d);
+  } else if (len >= sizeof(qword_t)) {
+    const qword_t a = load<qword_t>(src);
+    const qword_t b = load<qword_t>(src + len - sizeof(qword_t));
+
+    store(dest, a);
+    store(dest + len - sizeof(qword_t), b);
+  } else if (len >= sizeof(uint32_t)) {
+    const uint32_t a = load<uint32_t>(src);
+    const uint32_t b = load<uint32_t>(src + len - sizeof(uint32_t));
+
+    store(dest, a);
+    store(dest + len - sizeof(uint32_t), b);
+  } else if (len != 0) {
+    // 1 to 3 bytes: first, middle and last cover all of them.
+    const uint8_t a = load<uint8_t>(src);
+    const uint8_t b = load<uint8_t>(src + len / 2);
+    const uint8_t c = load<uint8_t>(src + len - 1);
+
+    store(dest, a);
+    store(dest + len / 2, b);
+    store(dest + len - 1, c);
+  }
+}
+
+// Same layout as copy_small(), with `word` holding the byte in every lane.
+inline void set_small(uintptr_t dest, qword_t word, size_t len) {
+  if (len >= 2 * sizeof(qword_t)) {
+    store(dest, word);
+    store(dest + sizeof(qword_t), word);
+    store(dest + len - 2 * sizeof(qword_t), word);
+    store(dest + len - sizeof(qword_t), word);
+  } else if (len >= sizeof(qword_t)) {
+    store(dest, word);
+    store(dest + len - sizeof(qword_t), word);
+  } else if (len >= sizeof(uint32_t)) {
+    store(dest, static_cast<uint32_t>(word));
+    store(dest + len - sizeof(uint32_t), static_cast<uint32_t>(word));
+  } else if (len != 0) {
+    store(dest, static_cast<uint8_t>(word));
+    store(dest + len / 2, static_cast<uint8_t>(word));
+    store(dest + len - 1, static_cast<uint8_t>(word));
+  }
+}
+
+#ifdef __x86_64__
+inline bool use_rep_movsb(size_t len) {
+  return (string_features & STRING_FEATURE_FSRM) ||
+         ((string_features & STRING_FEATURE_ERMS) && (len >= rep_threshold));
+}
+
+inline bool use_rep_stosb(size_t len) {
+  return (string_features & STRING_FEATURE_FSRS) ||
+         ((string_features & STRING_FEATURE_ERMS) && (len >= rep_threshold));
+}
+
+inline void rep_movsb(uintptr_t dest, uintptr_t src, size_t len) {
+  asm volatile("rep movsb" : "+D"(dest), "+S"(src), "+c"(len) : : "memory");
+}
+
+inline void rep_stosb(uintptr_t dest, uint8_t ch, size_t len) {
+  asm volatile("rep stosb" : "+D"(dest), "+c"(len) : "a"(ch) : "memory");
+}
+#endif
+
 inline qword_t merge(qword_t qword1, int shift1, qword_t qword2, int shift2) {
 #if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
   return (qword1 >> shift1) | (qword2 << shift2);
@@ -85,8 +168,8 @@ void copy_forward_dest_aligned(uintptr_t dest, uintptr_t src, size_t len)
     } else {                                                           \
       copy_forward_dest_aligned(destp, srcp, (len) / sizeof(qword_t)); \
     }                                                                  \
-    (srcp) += (len) & ~sizeof(qword_t);                                \
-    (destp) += (len) & ~sizeof(qword_t);                               \
+    (srcp) += (len) & -sizeof(qword_t);                                \
+    (destp) += (len) & -sizeof(qword_t);                               \
     (bytes_left) = (len) % sizeof(qword_t);                            \
   }
 
@@ -102,8 +185,8 @@ void copy_backward_dest_aligned(uintptr_t dest, uintptr_t src, size_t len)
     } else {                                                            \
       copy_backward_dest_aligned(destp, srcp, (len) / sizeof(qword_t)); \
     }                                                                   \
-    (srcp) -= (len) & ~sizeof(qword_t);                                 \
-    (destp) -= (len) & ~sizeof(qword_t);                                \
+    (srcp) -= (len) & -sizeof(qword_t);                                 \
+    (destp) -= (len) & -sizeof(qword_t);                                \
     (bytes_left) = (len) % sizeof(qword_t);                             \
   }
 }  // namespace internal
@@ -0,0 +1,174 @@
+#ifndef STRING_UTILS_STRING_HPP
+#define STRING_UTILS_STRING_HPP
+
+#include "word.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace internal {
+// Word-at-a-time scanning. Aligned words never straddle a page, so a scan
+// may read past the terminator of a string without faulting. Unaligned
+// loads are only used for bytes known to be in bounds, or after checking
+// that the word stays within the page.
+constexpr uintptr_t min_page_size = 4096;
+
+// High bit set in exactly the bytes of `word` that are zero. Unlike the
+// shorter (w - 0x01..) & ~w & 0x80.. form this never flags a 0x01 byte
+// sitting above a zero one, so it is usable for either byte order.
+inline qword_t zero_bytes(qword_t word) {
+  const qword_t low7 = broadcast(0x7f);
+  return ~(((word & low7) + low7) | word | low7);
+}
+
+// Index of the lowest-addressed byte with its high bit set in `mask`, or of
+// the first non-zero byte of a difference; `mask` must be non-zero.
+inline size_t first_byte(qword_t mask) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  return __builtin_ctzl(mask) / 8;
+#else
+  return __builtin_clzl(mask) / 8;
+#endif
+}
+
+// All bits of the first `count` bytes of a word, `count` < sizeof(qword_t).
+inline qword_t leading_bytes(size_t count) {
+  if (count == 0) {
+    return 0;
+  }
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  return ~static_cast<qword_t>(0) >> (8 * (sizeof(qword_t) - count));
+#else
+  return ~static_cast<qword_t>(0) << (8 * (sizeof(qword_t) - count));
+#endif
+}
+
+inline bool crosses_page(uintptr_t addr) {
+  return (addr & (min_page_size - 1)) > min_page_size - sizeof(qword_t);
+}
+
+inline size_t word_strlen(const char* str) {
+  const uintptr_t start = reinterpret_cast<uintptr_t>(str);
+  uintptr_t addr = start & -sizeof(qword_t);
+  qword_t mask =
+      zero_bytes(load<qword_t>(addr)) & ~leading_bytes(start - addr);
+
+  while (mask == 0) {
+    addr += sizeof(qword_t);
+    mask = zero_bytes(load<qword_t>(addr));
+  }
+
+  return addr + first_byte(mask) - start;
+}
+
+inline size_t word_strnlen(const char* str, size_t max_len) {
+  if (max_len == 0) {
+    return 0;
+  }
+
+  const uintptr_t start = reinterpret_cast<uintptr_t>(str);
+  uintptr_t addr = start & -sizeof(qword_t);
+  qword_t mask =
+      zero_bytes(load<qword_t>(addr)) & ~leading_bytes(start - addr);
+  // Bytes of the string covered by the words loaded so far.
+  size_t scanned = addr + sizeof(qword_t) - start;
+
+  while (mask == 0 && scanned < max_len) {
+    addr += sizeof(qword_t);
+    mask = zero_bytes(load<qword_t>(addr));
+    scanned += sizeof(qword_t);
+  }
+
+  if (mask == 0) {
+    return max_len;
+  }
+
+  const size_t len = addr + first_byte(mask) - start;
+  return len < max_len ? len : max_len;
+}
+
+inline char* word_strchr(const char* str, int ch) {
+  const uintptr_t start = reinterpret_cast<uintptr_t>(str);
+  const qword_t pattern = broadcast(static_cast<uint8_t>(ch));
+  uintptr_t addr = start & -sizeof(qword_t);
+  qword_t word = load<qword_t>(addr);
+  qword_t mask = (zero_bytes(word) | zero_bytes(word ^ pattern)) &
+                 ~leading_bytes(start - addr);
+
+  while (mask == 0) {
+    addr += sizeof(qword_t);
+    word = load<qword_t>(addr);
+    mask = zero_bytes(word) | zero_bytes(word ^ pattern);
+  }
+
+  // Either the terminator or `ch` came first; searching for '\0' finds the
+  // terminator, as it should.
+  const char* found = reinterpret_cast<const char*>(addr + first_byte(mask));
+  return *found == static_cast<char>(ch) ? const_cast<char*>(found) : nullptr;
+}
+
+inline int word_strcmp(const char* str1, const char* str2) {
+  const uint8_t* s1 = reinterpret_cast<const uint8_t*>(str1);
+  const uint8_t* s2 = reinterpret_cast<const uint8_t*>(str2);
+
+  while (true) {
+    // Byte steps until `s1` is aligned, or while an unaligned load from
+    // `s2` would touch the next page.
+    if ((reinterpret_cast<uintptr_t>(s1) % sizeof(qword_t)) != 0 ||
+        crosses_page(reinterpret_cast<uintptr_t>(s2))) {
+      if (*s1 == 0 || *s1 != *s2) {
+        return *s1 - *s2;
+      }
+
+      s1++;
+      s2++;
+      continue;
+    }
+
+    const qword_t a = load<qword_t>(reinterpret_cast<uintptr_t>(s1));
+    const qword_t b = load<qword_t>(reinterpret_cast<uintptr_t>(s2));
+
+    if (a != b || zero_bytes(a) != 0) {
+      // The answer is within this word.
+      while (*s1 != 0 && *s1 == *s2) {
+        s1++;
+        s2++;
+      }
+
+      return *s1 - *s2;
+    }
+
+    s1 += sizeof(qword_t);
+    s2 += sizeof(qword_t);
+  }
+}
+
+inline int word_memcmp(const void* src1, const void* src2, size_t len) {
+  const uintptr_t a = reinterpret_cast<uintptr_t>(src1);
+  const uintptr_t b = reinterpret_cast<uintptr_t>(src2);
+  size_t i = 0;
+
+  for (; i + sizeof(qword_t) <= len; i += sizeof(qword_t)) {
+    const qword_t diff = load<qword_t>(a + i) ^ load<qword_t>(b + i);
+
+    if (diff != 0) {
+      i += first_byte(diff);
+      return load<uint8_t>(a + i) - load<uint8_t>(b + i);
+    }
+  }
+
+  for (; i < len; i++) {
+    const uint8_t x = load<uint8_t>(a + i);
+    const uint8_t y = load<uint8_t>(b + i);
+
+    if (x != y) {
+      return x - y;
+    }
+  }
+
+  return 0;
+}
+}  // namespace internal
+
+#endif  // STRING_UTILS_STRING_HPP
@@ -0,0 +1,32 @@
+#ifndef STRING_UTILS_WORD_HPP
+#define STRING_UTILS_WORD_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if (__BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__) && \
+    (__BYTE_ORDER__ != __ORDER_BIG_ENDIAN__)
+#error Unknown Endianness Detected!
+#endif
+
+namespace internal {
+using qword_t = size_t;
+
+template <typename T>
+inline T load(uintptr_t addr) {
+  T value;
+  __builtin_memcpy(&value, reinterpret_cast<const void*>(addr), sizeof(T));
+  return value;
+}
+
+template <typename T>
+inline void store(uintptr_t addr, T value) {
+  __builtin_memcpy(reinterpret_cast<void*>(addr), &value, sizeof(T));
+}
+
+inline qword_t broadcast(uint8_t ch) {
+  return static_cast<qword_t>(ch) * (~static_cast<qword_t>(0) / 0xff);
+}
+}  // namespace internal
+
+#endif  // STRING_UTILS_WORD_HPP
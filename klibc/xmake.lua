@@ -14,4 +14,47 @@ target("noise-klibc")
     add_deps("klibc-headers")
 
     on_run(function (target)
-    end)
\ No newline at end of file
+    end)
+-- Host-side check and benchmark of the string scanners:
+--   xmake build string-bench && xmake run string-bench [iterations]
+target("string-bench")
+    set_default(false)
+    set_kind("binary")
+    set_plat(os.host())
+    set_arch(os.arch())
+    set_toolchains("gcc")
+    set_optimize("fastest")
+
+    add_files("bench/string.cpp")
+
+-- klibc built for the host with every public symbol renamed to klibc_*, so
+-- it links next to the host libc without interposing on it. crt is left out.
+target("klibc-host")
+    set_default(false)
+    set_kind("static")
+    set_plat(os.host())
+    set_arch(os.arch())
+    set_toolchains("gcc")
+    set_optimize("fastest")
+
+    add_files("src/*.cpp", "src/string/*.cpp", "src/utils/*.cpp")
+    add_includedirs("include")
+    add_forceincludes(path.join(os.scriptdir(), "host/rename.h"))
+    -- Keep GCC from turning the loops in memcpy/memset into calls to
+    -- themselves.
+    add_cxflags("-ffreestanding", "-fno-tree-loop-distribute-patterns")
+
+-- Checks every klibc mem*/str* routine against the host libc, then times
+-- both:
+--   xmake build klibc-bench && xmake run klibc-bench [--check-only]
+target("klibc-bench")
+    set_default(false)
+    set_kind("binary")
+    set_plat(os.host())
+    set_arch(os.arch())
+    set_toolchains("gcc")
+    set_optimize("fastest")
+
+    add_files("bench/klibc.cpp")
+    add_includedirs("host", "../libs/bench/include")
+    add_deps("klibc-host")
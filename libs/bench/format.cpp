@@ -0,0 +1,325 @@
+// Host check and benchmark of the formatting library: conversions through
+// format::fmt against their expected text, compiled printf formats against
+// the host snprintf(), the printf argument checker at compile time, the
+// logger with both kinds of sink, and the cost per formatted line.
+//
+// Usage: format-bench [--check-only]
+
+#include <format.hpp>
+#include <logger.hpp>
+#include <microbench.hpp>
+
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+
+#define LINE_SIZE 256
+
+namespace {
+using namespace microbench;
+
+// Fixed-size sink, like the kernel's log buffers.
+struct Line {
+  char data[LINE_SIZE];
+  size_t size = 0;
+
+  void append(char ch) {
+    if (this->size < LINE_SIZE - 1) {
+      this->data[this->size++] = ch;
+    }
+
+    this->data[this->size] = '\0';
+  }
+
+  void append(const char* str) {
+    while (*str) {
+      append(*str++);
+    }
+  }
+};
+
+template <typename... Args>
+bool formats_as(const char* want, std::string_view fmt, Args&&... args) {
+  Line line;
+  line.data[0] = '\0';
+  format::format(line, format::fmt(fmt, std::forward<Args>(args)...));
+
+  if (strcmp(line.data, want) != 0) {
+    fprintf(stderr, "\"%.*s\": got \"%s\", want \"%s\"\n",
+            static_cast<int>(fmt.size()), fmt.data(), line.data, want);
+    return false;
+  }
+
+  return true;
+}
+
+// format_printf<Fmt>() must match the host printf byte for byte.
+template <format::fixed_string Fmt, typename... Args>
+bool printf_matches(const Args&... args) {
+  char got[LINE_SIZE];
+  char want[LINE_SIZE];
+  format::buffer_sink sink(got, sizeof(got));
+
+  format::format_printf<Fmt>(sink, args...);
+  const size_t length = sink.finish();
+  const int want_length = snprintf(want, sizeof(want), Fmt.data, args...);
+
+  if (strcmp(got, want) != 0 || length != static_cast<size_t>(want_length)) {
+    fprintf(stderr, "\"%s\": got \"%s\" (%zu), want \"%s\" (%d)\n", Fmt.data,
+            got, length, want, want_length);
+    return false;
+  }
+
+  return true;
+}
+
+static_assert(format::check_printf<int, const char*>("%d %s"));
+static_assert(format::check_printf<unsigned long, void*>("%lx at %p"));
+static_assert(format::check_printf<int, int>("%*d"));
+static_assert(format::check_printf<>("100%%"));
+static_assert(!format::check_printf<int>("%s"));
+static_assert(!format::check_printf<int>("%lu"));
+static_assert(!format::check_printf<int, int>("%d"));
+static_assert(!format::check_printf<>("%d"));
+static_assert(!format::check_printf<int>("%q"));
+static_assert(!format::check_printf<const char*>("%p"));
+static_assert(format::check_printf<const void*>("%p"));
+
+// Every digit-count boundary in each radix, and a spread of other values,
+// against the host printf.
+void check_digits() {
+  auto check_value = [](unsigned long long value) {
+    char got[80];
+    char want[80];
+    const int length = format::details::write_digits<10>(got, value);
+    got[length] = '\0';
+    snprintf(want, sizeof(want), "%llu", value);
+    BENCH_CHECK(strcmp(got, want) == 0);
+
+    got[format::details::write_digits<16>(got, value)] = '\0';
+    snprintf(want, sizeof(want), "%llx", value);
+    BENCH_CHECK(strcmp(got, want) == 0);
+
+    got[format::details::write_digits<16, true>(got, value)] = '\0';
+    snprintf(want, sizeof(want), "%llX", value);
+    BENCH_CHECK(strcmp(got, want) == 0);
+
+    got[format::details::write_digits<8>(got, value)] = '\0';
+    snprintf(want, sizeof(want), "%llo", value);
+    BENCH_CHECK(strcmp(got, want) == 0);
+
+    const int bits = format::details::write_digits<2>(got, value);
+    BENCH_CHECK(bits == format::details::bit_width(value));
+
+    for (int i = 0; i < bits; i++) {
+      const unsigned long long bit = (value >> (bits - 1 - i)) & 1;
+      BENCH_CHECK(got[i] == static_cast<char>('0' + bit));
+    }
+  };
+
+  unsigned long long power = 1;
+
+  for (int i = 0; i < 20; i++, power *= 10) {
+    check_value(power - 1);
+    check_value(power);
+    check_value(power + 1);
+  }
+
+  for (int bit = 0; bit < 64; bit++) {
+    check_value((1ULL << bit) - 1);
+    check_value(1ULL << bit);
+    check_value((1ULL << bit) + 1);
+  }
+
+  unsigned long long value = 0x9e3779b97f4a7c15ULL;
+
+  for (int i = 0; i < 100000; i++) {
+    value = value * 6364136223846793005ULL + 1442695040888963407ULL;
+    check_value(value >> (i % 64));
+  }
+
+  check_value(UINT64_MAX);
+}
+
+// Collects what a logger passes on, and how many calls it took.
+struct SpanCollector {
+  Line* out;
+  size_t* calls;
+
+  void operator()(const char* str, size_t length) {
+    (*this->calls)++;
+
+    for (size_t i = 0; i < length; i++) {
+      this->out->append(str[i]);
+    }
+  }
+};
+
+// Lends out at most 16 bytes at a time, to make the logger come back often,
+// until `capacity` is used up.
+struct RingCollector {
+  char* storage;
+  size_t capacity;
+  size_t* used;
+
+  char* reserve(size_t* size) {
+    *size = std::min<size_t>(16, this->capacity - *this->used);
+    return (*size != 0) ? this->storage + *this->used : nullptr;
+  }
+
+  void commit(size_t length) {
+    *this->used += length;
+  }
+};
+
+void check_logger() {
+  char long_text[200];
+
+  memset(long_text, 'x', sizeof(long_text) - 1);
+  long_text[sizeof(long_text) - 1] = '\0';
+
+  Line line;
+  size_t calls = 0;
+
+  {
+    logger::logger<SpanCollector> log(SpanCollector{&line, &calls});
+    log.write(format::fmt("[PMM] freed {} pages at {:x}", 512, 0x7fe00000));
+    log.flush();
+    BENCH_CHECK(strcmp(line.data, "[PMM] freed 512 pages at 7fe00000") == 0);
+    BENCH_CHECK(calls == 1);
+
+    // A second flush has nothing to send.
+    log.flush();
+    BENCH_CHECK(calls == 1);
+
+    // Longer than the buffer: passed through in one call.
+    line.size = 0;
+    log.write(static_cast<const char*>(long_text));
+    BENCH_CHECK(calls == 2 && strcmp(line.data, long_text) == 0);
+
+    line.size = 0;
+    log.write(format::fmt("{}", "tail"));
+  }
+
+  // The destructor flushes.
+  BENCH_CHECK(calls == 3 && strcmp(line.data, "tail") == 0);
+
+  char storage[40];
+  size_t used = 0;
+  logger::logger<RingCollector> ring(
+      RingCollector{storage, sizeof(storage), &used});
+
+  ring.write(format::fmt("{} pages at {:x}, ", 512, 0x7fe00000));
+  ring.flush();
+  BENCH_CHECK(used == 23);
+  BENCH_CHECK(memcmp(storage, "512 pages at 7fe00000, ", 23) == 0);
+
+  // Whatever does not fit is dropped and counted.
+  ring.write(format::fmt("{}", "0123456789012345678901234567890123456789"));
+  ring.flush();
+  BENCH_CHECK(used == sizeof(storage) && ring.dropped() == 40 - 17);
+  BENCH_CHECK(memcmp(storage + 23, "01234567890123456", 17) == 0);
+}
+
+void check() {
+  check_digits();
+  check_logger();
+
+  BENCH_CHECK(formats_as("plain", "plain"));
+  BENCH_CHECK(formats_as("0 1 -1", "{} {} {}", 0, 1, -1));
+  BENCH_CHECK(formats_as("4294967295", "{}", 0xffffffffu));
+  BENCH_CHECK(formats_as("-9223372036854775808", "{}", INT64_MIN));
+  BENCH_CHECK(formats_as("18446744073709551615", "{}", UINT64_MAX));
+  BENCH_CHECK(formats_as("abcdef ABCDEF", "{:x} {:X}", 0xabcdef, 0xabcdef));
+  BENCH_CHECK(formats_as("fedcba9876543210", "{:x}", 0xfedcba9876543210UL));
+  BENCH_CHECK(formats_as("777 101", "{:o} {:b}", 0777, 5));
+  BENCH_CHECK(formats_as("   42|00042", "{:5}|{:05}", 42, 42));
+  BENCH_CHECK(formats_as("0000beef", "{:08x}", 0xbeefu));
+  BENCH_CHECK(formats_as("b a", "{1} {0}", 'a', 'b'));
+  BENCH_CHECK(formats_as("str x", "{} {}", "str", 'x'));
+  BENCH_CHECK(formats_as("0x1000", "{}", reinterpret_cast<void*>(0x1000)));
+  BENCH_CHECK(formats_as("{} {:q}", "{} {:q}"));
+  BENCH_CHECK(formats_as("{ok}", "{{ok}"));
+
+  BENCH_CHECK(printf_matches<"plain 100%%">());
+  BENCH_CHECK(printf_matches<"%d %i %d">(0, -1, INT32_MIN));
+  BENCH_CHECK(printf_matches<"%u %lu %llu">(7u, ULONG_MAX, 0ULL));
+  BENCH_CHECK(printf_matches<"%ld %lld %zu">(LONG_MIN, -5LL, size_t{9}));
+  BENCH_CHECK(printf_matches<"%x %X %lx %o">(0xabcu, 0xabcu, ~0UL, 8u));
+  BENCH_CHECK(printf_matches<"%#x %#X %#o %#o %#x">(255, 255, 8, 0, 0));
+  BENCH_CHECK(printf_matches<"[%5d|%-5d|%05d|%+d|% d]">(42, 42, -42, 7, 7));
+  BENCH_CHECK(printf_matches<"[%.3d|%8.3d|%-8.3x|%08.3d]">(5, -5, 10, 5));
+  BENCH_CHECK(printf_matches<"[%.0d|%.0x|%5.0d]">(0, 0u, 0));
+  BENCH_CHECK(printf_matches<"[%*d|%-*d|%.*d]">(6, 1, 6, 2, 4, 3));
+  BENCH_CHECK(printf_matches<"[%*d|%.*d]">(-6, 1, -1, 2));
+  BENCH_CHECK(printf_matches<"[%hhd|%hhu|%hd|%hx]">(300, -1, 70000, -1));
+  BENCH_CHECK(printf_matches<"[%s|%8s|%-8s|%.2s|%*.*s]">("abc", "abc", "abc",
+                                                         "abc", 5, 1, "xyz"));
+  BENCH_CHECK(printf_matches<"[%c|%3c|%-3c]">('a', 'b', 'c'));
+  BENCH_CHECK(printf_matches<"%016lx %09llu">(0xbeefUL, 123ULL));
+}
+
+void bench() {
+  Line line;
+
+  measure("fmt decimal", 0, [&] {
+    line.size = 0;
+    format::format(line, format::fmt("{} {} {}", 7, 123456, -98765432));
+    keep(line);
+  });
+  measure("fmt pointer", 0, [&] {
+    line.size = 0;
+    format::format(line, format::fmt("{:x}", 0xffff800012345678UL));
+    keep(line);
+  });
+  measure("fmt hex", 0, [&] {
+    line.size = 0;
+    format::format(line, format::fmt("{:016x}", 0xffff800012345678UL));
+    keep(line);
+  });
+  measure("fmt log line", 0, [&] {
+    line.size = 0;
+    format::format(line, format::fmt("[PMM] freed {} pages at {:x}", 512,
+                                     0x7fe00000UL));
+    keep(line);
+  });
+  measure("format_printf log line", 0, [&] {
+    char out[LINE_SIZE];
+    format::buffer_sink sink(out, sizeof(out));
+    format::format_printf<"[PMM] freed %d pages at %lx">(sink, 512,
+                                                         0x7fe00000UL);
+    keep(sink.finish());
+    keep(out);
+  });
+  measure("format_printf hex address", 0, [&] {
+    char out[LINE_SIZE];
+    format::buffer_sink sink(out, sizeof(out));
+    format::format_printf<"[PG] map 0x%lx -> 0x%lx">(sink, 0xffff800012345000UL,
+                                                       0x12345000UL);
+    keep(sink.finish());
+    keep(out);
+  });
+  measure("snprintf hex address", 0, [&] {
+    line.size = snprintf(line.data, sizeof(line.data),
+                         "[PG] map 0x%lx -> 0x%lx", 0xffff800012345000UL,
+                         0x12345000UL);
+    keep(line);
+  });
+  measure("snprintf log line", 0, [&] {
+    line.size = snprintf(line.data, sizeof(line.data),
+                         "[PMM] freed %d pages at %lx", 512, 0x7fe00000UL);
+    keep(line);
+  });
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  check();
+
+  if (argc > 1 && strcmp(argv[1], "--check-only") == 0) {
+    return finish();
+  }
+
+  bench();
+  return finish();
+}
@@ -0,0 +1,37 @@
+#ifndef ARCH_HPP
+#define ARCH_HPP 1
+
+// Hosted stand-in for the kernel's arch layer, so the lock headers in libs/
+// can be benchmarked as ordinary user-space threads.
+
+#include <stdint.h>
+
+#include <atomic>
+
+#define MAX_CPUS 256
+
+namespace arch {
+inline void pause() {
+  asm volatile("pause");
+}
+
+// Threads get a "CPU" id on first use.
+inline uint32_t cpu_id() {
+  static std::atomic_uint32_t next_id = 0;
+  thread_local uint32_t id = next_id.fetch_add(1) % MAX_CPUS;
+  return id;
+}
+
+inline uint64_t cycles() {
+  return __builtin_ia32_rdtsc();
+}
+
+inline bool int_status() {
+  return false;
+}
+
+inline void int_switch(bool) {
+}
+}  // namespace arch
+
+#endif  // ARCH_HPP
@@ -0,0 +1,100 @@
+#ifndef MICROBENCH_HPP
+#define MICROBENCH_HPP 1
+
+// Shared harness for the host benchmarks. Checks record failures and make
+// the binary exit non-zero; timings are the best of several batches, each
+// long enough to swamp the clock overhead, reported as ns/op and, when the
+// operation moves data, GB/s.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <chrono>
+
+#define MICROBENCH_BATCH_NS 20000000.0
+#define MICROBENCH_REPEATS 5
+
+#define BENCH_CHECK(cond) \
+  ::microbench::check((cond), #cond, __FILE__, __LINE__)
+
+namespace microbench {
+inline size_t failures = 0;
+
+inline bool check(bool ok, const char* expr, const char* file, int line) {
+  if (!ok) {
+    failures++;
+    fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expr);
+  }
+
+  return ok;
+}
+
+// Keep the compiler from dropping a result or hoisting work out of a loop.
+template <typename T>
+inline void keep(const T& value) {
+  asm volatile("" ::"r,m"(value) : "memory");
+}
+
+struct Result {
+  double ns_per_op;
+  double bytes_per_sec;
+};
+
+template <typename Op>
+double time_batch(size_t iterations, Op& op) {
+  const auto start = std::chrono::steady_clock::now();
+
+  for (size_t i = 0; i < iterations; ++i) {
+    op();
+  }
+
+  return std::chrono::duration<double, std::nano>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+// Time `op`, which handles `bytes` bytes per call (0 if not meaningful).
+template <typename Op>
+Result measure(const char* name, size_t bytes, Op op) {
+  size_t iterations = 1;
+
+  while (time_batch(iterations, op) < MICROBENCH_BATCH_NS / 16) {
+    iterations *= 2;
+  }
+
+  iterations *= 16;
+
+  double best = time_batch(iterations, op);
+
+  for (int i = 1; i < MICROBENCH_REPEATS; ++i) {
+    best = std::min(best, time_batch(iterations, op));
+  }
+
+  const Result result = {best / iterations,
+                         bytes * 1e9 / (best / iterations)};
+
+  if (bytes != 0) {
+    printf("%-32s %10.2f ns/op %8.2f GB/s\n", name, result.ns_per_op,
+           result.bytes_per_sec / 1e9);
+  } else {
+    printf("%-32s %10.2f ns/op\n", name, result.ns_per_op);
+  }
+
+  return result;
+}
+
+// Print the verdict; use as main()'s return value.
+inline int finish() {
+  if (failures != 0) {
+    printf("%zu checks FAILED\n", failures);
+    return 1;
+  }
+
+  printf("all checks ok\n");
+  return 0;
+}
+}  // namespace microbench
+
+#endif  // MICROBENCH_HPP
@@ -0,0 +1,147 @@
+// Page clear/copy cache pollution benchmark. A neighbour workload keeps a
+// working set hot by chasing pointers through it; between two walks, a burst
+// of pages is cleared or copied. The slowdown of the walk afterwards is how
+// much of the working set the page operation pushed out of the cache.
+//
+// Usage: page-bench [working set KiB] [pages per burst]
+
+#include "arch/x86_64/memory/page_ops.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#define ROUNDS 64
+
+namespace {
+using namespace memory::arch::x86_64;
+
+struct alignas(CACHE_LINE_SIZE) Line {
+  Line* next;
+};
+
+// A random cyclic walk over every line, so the prefetchers cannot hide
+// misses.
+std::vector<Line> make_working_set(size_t bytes) {
+  const size_t count = bytes / sizeof(Line);
+  std::vector<Line> lines(count);
+  std::vector<size_t> order(count);
+
+  for (size_t i = 0; i < count; ++i) {
+    order[i] = i;
+  }
+
+  std::shuffle(order.begin(), order.end(), std::mt19937_64(42));
+
+  for (size_t i = 0; i < count; ++i) {
+    lines[order[i]].next = &lines[order[(i + 1) % count]];
+  }
+
+  return lines;
+}
+
+double walk_ns_per_line(std::vector<Line>& lines) {
+  const auto start = std::chrono::steady_clock::now();
+  const Line* line = &lines[0];
+
+  for (size_t i = 0; i < lines.size(); ++i) {
+    line = line->next;
+  }
+
+  asm volatile("" ::"r"(line));
+
+  return std::chrono::duration<double, std::nano>(
+             std::chrono::steady_clock::now() - start)
+             .count() /
+         lines.size();
+}
+
+void* alloc_pages(size_t pages) {
+  return aligned_alloc(STREAM_PAGE_SIZE, pages * STREAM_PAGE_SIZE);
+}
+
+// `bytes` is what one call of `op` writes; 0 for the baseline.
+template <typename Op>
+void run(const char* name, std::vector<Line>& lines, size_t bytes, Op op) {
+  double op_ns = 0;
+  double walk_ns = 0;
+
+  for (size_t round = 0; round < ROUNDS; ++round) {
+    walk_ns_per_line(lines);
+
+    const auto start = std::chrono::steady_clock::now();
+    op();
+    op_ns += std::chrono::duration<double, std::nano>(
+                 std::chrono::steady_clock::now() - start)
+                 .count();
+
+    walk_ns += walk_ns_per_line(lines);
+  }
+
+  if (bytes == 0) {
+    printf("%-14s %8s       neighbour %6.2f ns/line\n", name, "-",
+           walk_ns / ROUNDS);
+  } else {
+    printf("%-14s %8.2f GB/s  neighbour %6.2f ns/line\n", name,
+           static_cast<double>(bytes) * ROUNDS / op_ns, walk_ns / ROUNDS);
+  }
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t working_set_kib = 512;
+  size_t pages = 1024;
+
+  if (argc > 1) {
+    working_set_kib = strtoul(argv[1], nullptr, 10);
+  }
+
+  if (argc > 2) {
+    pages = strtoul(argv[2], nullptr, 10);
+  }
+
+  if (working_set_kib == 0 || pages == 0) {
+    fprintf(stderr, "working set and page count must be non-zero\n");
+    return 1;
+  }
+
+  std::vector<Line> lines = make_working_set(working_set_kib * 1024);
+  auto* dest = static_cast<uint8_t*>(alloc_pages(pages));
+  auto* src = static_cast<uint8_t*>(alloc_pages(pages));
+  const size_t bytes = pages * STREAM_PAGE_SIZE;
+
+  for (size_t i = 0; i < bytes; ++i) {
+    src[i] = static_cast<uint8_t>(i * 7);
+  }
+
+  printf("working set %zu KiB, %zu pages per burst\n", working_set_kib, pages);
+
+  run("baseline", lines, 0, [] {});
+  run("memset", lines, bytes, [&] { memset(dest, 0, bytes); });
+  run("stream clear", lines, bytes, [&] { stream_clear_pages(dest, pages); });
+
+  bool ok = true;
+
+  for (size_t i = 0; i < bytes; ++i) {
+    ok = ok && dest[i] == 0;
+  }
+
+  run("memcpy", lines, bytes, [&] { memcpy(dest, src, bytes); });
+  memset(dest, 0xff, bytes);
+  run("stream copy", lines, bytes,
+      [&] { stream_copy_pages(dest, src, pages); });
+
+  ok = ok && memcmp(dest, src, bytes) == 0;
+
+  printf("%s\n", ok ? "ok" : "FAILED");
+
+  free(dest);
+  free(src);
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,171 @@
+// Ring buffer throughput and consistency check. Producers push tagged
+// sequence numbers; consumers verify that each producer's elements arrive
+// in order (per consumer) and that nothing is lost or duplicated.
+//
+// Usage: ring-bench [producers] [elements per producer]
+
+#include "percpu_counter.hpp"
+#include "ring.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#define RING_SIZE 1024
+
+namespace {
+uint64_t encode(uint64_t producer, uint64_t seq) {
+  return (producer << 48) | seq;
+}
+
+struct Check {
+  std::vector<uint64_t> last;
+  uint64_t sum = 0;
+  uint64_t count = 0;
+  bool ordered = true;
+
+  explicit Check(size_t producers) : last(producers, 0) {
+  }
+
+  void see(uint64_t value) {
+    const uint64_t producer = value >> 48;
+    const uint64_t seq = value & ((1ull << 48) - 1);
+
+    // Sequence numbers start at 1, so 0 means "nothing seen yet".
+    if (seq <= this->last[producer]) {
+      this->ordered = false;
+    }
+
+    this->last[producer] = seq;
+    this->sum += seq;
+    this->count++;
+  }
+};
+
+template <typename Ring>
+bool run(const char* name, size_t producers, size_t consumers,
+         uint64_t per_producer) {
+  static Ring ring;
+
+  std::atomic_size_t done = 0;
+  std::vector<std::thread> threads;
+  std::vector<Check> checks(consumers, Check(producers));
+
+  const auto start = std::chrono::steady_clock::now();
+
+  for (size_t p = 0; p < producers; ++p) {
+    threads.emplace_back([&, p] {
+      for (uint64_t seq = 1; seq <= per_producer; ++seq) {
+        while (!ring.push(encode(p, seq))) {
+          std::this_thread::yield();
+        }
+      }
+
+      done.fetch_add(1);
+    });
+  }
+
+  for (size_t c = 0; c < consumers; ++c) {
+    threads.emplace_back([&, c] {
+      uint64_t value = 0;
+
+      while (true) {
+        if (ring.pop(value)) {
+          checks[c].see(value);
+        } else if (done.load() == producers) {
+          // Producers are finished; drain whatever is left.
+          if (!ring.pop(value)) {
+            break;
+          }
+
+          checks[c].see(value);
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  const double seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+
+  uint64_t count = 0;
+  uint64_t sum = 0;
+  bool ordered = true;
+
+  for (const Check& check : checks) {
+    count += check.count;
+    sum += check.sum;
+    ordered = ordered && check.ordered;
+  }
+
+  const uint64_t total = producers * per_producer;
+  const uint64_t expected = producers * (per_producer * (per_producer + 1) / 2);
+  const bool ok = (count == total) && (sum == expected) && ordered;
+
+  printf("%-6s %2zuP/%zuC %10.2f Mop/s  %s\n", name, producers, consumers,
+         total / seconds / 1e6, ok ? "ok" : "FAILED");
+
+  return ok;
+}
+
+bool run_counter(size_t threads, uint64_t per_thread) {
+  static libs::PerCpuCounter<int64_t> counter;
+  std::vector<std::thread> workers;
+
+  for (size_t i = 0; i < threads; ++i) {
+    workers.emplace_back([&] {
+      for (uint64_t n = 0; n < per_thread; ++n) {
+        counter.inc();
+      }
+    });
+  }
+
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+
+  const bool ok = counter.read() == static_cast<int64_t>(threads * per_thread);
+  printf("percpu %2zu threads %s\n", threads, ok ? "ok" : "FAILED");
+
+  return ok;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t producers = 4;
+  uint64_t per_producer = 1000000;
+
+  if (argc > 1) {
+    producers = strtoul(argv[1], nullptr, 10);
+  }
+
+  if (argc > 2) {
+    per_producer = strtoull(argv[2], nullptr, 10);
+  }
+
+  if ((producers == 0) || (producers > 0xffff)) {
+    fprintf(stderr, "producer count must be within 1..65535\n");
+    return 1;
+  }
+
+  bool ok = true;
+
+  ok &= run<libs::SpscRing<uint64_t, RING_SIZE>>("spsc", 1, 1, per_producer);
+  ok &= run<libs::MpscRing<uint64_t, RING_SIZE>>("mpsc", producers, 1,
+                                                 per_producer);
+  ok &= run<libs::MpmcQueue<uint64_t, RING_SIZE>>("mpmc", producers, producers,
+                                                  per_producer);
+  ok &= run_counter(producers, per_producer);
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,129 @@
+// Lock handoff benchmark: N threads increment a shared counter under a lock
+// for a fixed amount of time. Each critical section also touches a few cache
+// lines, so the cost of moving the protected data is part of the number,
+// as it would be for the PMM free lists.
+//
+// Usage: spinlock-bench [max-threads] [milliseconds]
+
+#include "spinlock.hpp"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace {
+struct alignas(64) Shared {
+  uint64_t data[8];
+};
+
+struct alignas(64) Result {
+  uint64_t ops;
+};
+
+void pin(size_t cpu) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu % std::thread::hardware_concurrency(), &set);
+  pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+template <typename Lock>
+double run(size_t threads, uint32_t duration_ms) {
+  Lock lock;
+  Shared shared = {};
+
+  std::atomic_bool start = false;
+  std::atomic_bool stop = false;
+  std::vector<Result> results(threads);
+  std::vector<std::thread> workers;
+
+  for (size_t i = 0; i < threads; ++i) {
+    workers.emplace_back([&, i] {
+      pin(i);
+      uint64_t ops = 0;
+
+      while (!start.load(std::memory_order_acquire)) {
+        arch::pause();
+      }
+
+      while (!stop.load(std::memory_order_relaxed)) {
+        libs::LockGuard guard(lock);
+
+        for (uint64_t& word : shared.data) {
+          word++;
+        }
+
+        ops++;
+      }
+
+      results[i].ops = ops;
+    });
+  }
+
+  start.store(true, std::memory_order_release);
+  std::this_thread::sleep_for(std::chrono::milliseconds(duration_ms));
+  stop.store(true, std::memory_order_relaxed);
+
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+
+  uint64_t total = 0;
+  for (const Result& result : results) {
+    total += result.ops;
+  }
+
+  if (total != shared.data[0]) {
+    fprintf(stderr, "mutual exclusion broken: %lu ops, counter %lu\n", total,
+            shared.data[0]);
+    exit(1);
+  }
+
+  return static_cast<double>(total) / (duration_ms * 1000.0);
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t max_threads = std::thread::hardware_concurrency();
+  uint32_t duration_ms = 500;
+
+  if (argc > 1) {
+    max_threads = strtoul(argv[1], nullptr, 10);
+  }
+
+  if (argc > 2) {
+    duration_ms = strtoul(argv[2], nullptr, 10);
+  }
+
+  if ((max_threads == 0) || (max_threads > MAX_CPUS)) {
+    fprintf(stderr, "thread count must be within 1..%d\n", MAX_CPUS);
+    return 1;
+  }
+
+  printf("%8s %16s %16s\n", "threads", "ticket (Mop/s)", "queued (Mop/s)");
+
+  // 1, 2, 4, ... and the maximum itself.
+  size_t threads = 1;
+
+  while (true) {
+    const double ticket = run<libs::SpinLock>(threads, duration_ms);
+    const double queued = run<libs::QueuedLock>(threads, duration_ms);
+
+    printf("%8zu %16.2f %16.2f\n", threads, ticket, queued);
+
+    if (threads == max_threads) {
+      break;
+    }
+
+    threads = std::min(threads * 2, max_threads);
+  }
+
+  return 0;
+}
@@ -10,6 +10,7 @@
 #include <optional>
 #include <ranges>
 #include <string_view>
+#include <tuple>
 #include <type_traits>
 #include <utility>
 
@@ -54,7 +55,7 @@ struct format_spec {
   bool dollar_arg_pos = false;
   bool left_justify = false;
   bool always_sign = false;
-  bool plus_becomes_space;
+  bool plus_becomes_space = false;
   bool alt_conversion = false;
   bool fill_zeros = false;
   bool group_thousands = false;
@@ -62,7 +63,11 @@ struct format_spec {
 };
 
 struct locale_options {
-  locale_options() : decimal_point("."), thousands_sep(""), grouping("\255") {
+  locale_options()
+      : decimal_point("."),
+        thousands_sep(""),
+        grouping("\255"),
+        thousands_sep_size(0) {
   }
 
   locale_options(const char *prec, const char *sep, const char *grp)
@@ -76,26 +81,173 @@ struct locale_options {
   size_t thousands_sep_size;
 };
 
+// Append `count` bytes of `str`, in one call if the sink takes a length.
+template <Sink S>
+void append_n(S &sink, const char *str, size_t count) {
+  if constexpr (requires { sink.append(str, count); }) {
+    sink.append(str, count);
+  } else {
+    for (size_t i = 0; i < count; i++) {
+      sink.append(str[i]);
+    }
+  }
+}
+
+template <Sink S>
+void append_fill(S &sink, char ch, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    sink.append(ch);
+  }
+}
+
+// Integer to text. Decimal goes two digits per step through a table of
+// pairs, power-of-two radixes by shift and mask, and the digit count comes
+// from the highest set bit, so the digits are written in place, most
+// significant first, with no reversal and no division per digit.
+inline constexpr char digit_pairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536"
+    "37383940414243444546474849505152535455565758596061626364656667686970717273"
+    "7475767778798081828384858687888990919293949596979899";
+
+inline constexpr unsigned long long powers_of_10[] = {
+    1ULL,
+    10ULL,
+    100ULL,
+    1000ULL,
+    10000ULL,
+    100000ULL,
+    1000000ULL,
+    10000000ULL,
+    100000000ULL,
+    1000000000ULL,
+    10000000000ULL,
+    100000000000ULL,
+    1000000000000ULL,
+    10000000000000ULL,
+    100000000000000ULL,
+    1000000000000000ULL,
+    10000000000000000ULL,
+    100000000000000000ULL,
+    1000000000000000000ULL,
+    10000000000000000000ULL,
+};
+
+// Significant bits of `value`, at least 1 so that zero has one digit.
+constexpr int bit_width(unsigned long long value) {
+  return 64 - __builtin_clzll(value | 1);
+}
+
+template <unsigned Radix>
+constexpr int count_digits(unsigned long long value) {
+  if constexpr (Radix == 10) {
+    // bits * log10(2) is the count give or take one; one compare settles
+    // it. Or-ing in 1 keeps zero at one digit and changes nothing else, as
+    // powers of ten are even.
+    const int guess = (bit_width(value) * 1233) >> 12;
+    return guess + 1 - ((value | 1) < powers_of_10[guess] ? 1 : 0);
+  } else {
+    static_assert((Radix & (Radix - 1)) == 0, "unsupported radix");
+    constexpr int shift = __builtin_ctz(Radix);
+    return (bit_width(value) + shift - 1) / shift;
+  }
+}
+
+// Write the digits of `value` to `out`, which needs room for 64, and return
+// how many there are. Nothing is NUL-terminated.
+template <unsigned Radix, bool Capitals = false>
+int write_digits(char *out, unsigned long long value) {
+  const int count = count_digits<Radix>(value);
+
+  if constexpr (Radix == 10) {
+    char *pos = out + count;
+
+    while (value >= 100) {
+      pos -= 2;
+      memcpy(pos, &digit_pairs[(value % 100) * 2], 2);
+      value /= 100;
+    }
+
+    if (value >= 10) {
+      memcpy(pos - 2, &digit_pairs[value * 2], 2);
+    } else {
+      pos[-1] = static_cast<char>('0' + value);
+    }
+  } else {
+    const char *digits =
+        Capitals ? "0123456789ABCDEF" : "0123456789abcdef";
+    constexpr int shift = __builtin_ctz(Radix);
+
+    for (int i = count - 1; i >= 0; --i) {
+      out[i] = digits[value & (Radix - 1)];
+      value >>= shift;
+    }
+  }
+
+  return count;
+}
+
+inline int write_digits(char *out, unsigned long long value, int radix,
+                        bool capitals) {
+  switch (radix) {
+    case 2:
+      return write_digits<2>(out, value);
+    case 8:
+      return write_digits<8>(out, value);
+    case 16:
+      return capitals ? write_digits<16, true>(out, value)
+                      : write_digits<16>(out, value);
+    default:
+      return write_digits<10>(out, value);
+  }
+}
+
 template <Sink S, typename T>
   requires(std::is_integral_v<T>)
 void print_digits(S &sink, T num, bool neg, int radix, int width, int precision,
                   char padding, bool left_justify, bool group_thousands,
                   bool always_sign, bool plus_becomes_space, bool use_capitals,
-                  locale_options options) {
-  const char *digits = use_capitals ? "0123456789ABCDEF" : "0123456789abcedf";
+                  const locale_options &options) {
   char buffer[64];
+  const int num_digits = write_digits(
+      buffer, static_cast<unsigned long long>(num), radix, use_capitals);
+
+  auto emit_sign = [&]() {
+    if (neg) {
+      sink.append('-');
+    } else if (always_sign) {
+      sink.append('+');
+    } else if (plus_becomes_space) {
+      sink.append(' ');
+    }
+  };
+
+  if (!group_thousands) {
+    const int final_width = std::max(num_digits, precision);
+    const size_t pad = std::max(width - final_width, 0);
+
+    if (!left_justify) {
+      append_fill(sink, padding, pad);
+    }
+
+    emit_sign();
+    append_fill(sink, '0', final_width - num_digits);
+    append_n(sink, buffer, num_digits);
+
+    if (left_justify) {
+      append_fill(sink, padding, pad);
+    }
+
+    return;
+  }
+
+  // Thousands grouping: count the separators first, to know the width.
 
-  int num_digits = 0;
   int num_chars = 0;
   int group_idx = 0;
   int repeats = 0;
   size_t extra = 0;
 
   auto step_grouping = [&]() {
-    if (!group_thousands) {
-      return;
-    }
-
     if (++num_chars == options.grouping[group_idx]) {
       if (options.grouping[group_idx + 1] > 0) {
         group_idx++;
@@ -109,10 +261,6 @@ void print_digits(S &sink, T num, bool neg, int radix, int width, int precision,
   };
 
   auto emit_grouping = [&]() {
-    if (!group_thousands) {
-      return;
-    }
-
     if (--num_chars == 0) {
       sink.append(options.thousands_sep);
 
@@ -124,11 +272,9 @@ void print_digits(S &sink, T num, bool neg, int radix, int width, int precision,
     }
   };
 
-  do {
-    buffer[num_digits++] = digits[num % radix];
-    num /= radix;
+  for (int i = 0; i < num_digits; i++) {
     step_grouping();
-  } while (num);
+  }
 
   if (num_digits < precision) {
     for (int i = 0; i < precision - num_digits; i++) {
@@ -148,13 +294,7 @@ void print_digits(S &sink, T num, bool neg, int radix, int width, int precision,
     }
   }
 
-  if (neg) {
-    sink.append('-');
-  } else if (always_sign) {
-    sink.append('+');
-  } else if (plus_becomes_space) {
-    sink.append(' ');
-  }
+  emit_sign();
 
   if (num_digits < precision) {
     for (int i = 0; i < (precision - num_digits); i++) {
@@ -163,7 +303,7 @@ void print_digits(S &sink, T num, bool neg, int radix, int width, int precision,
     }
   }
 
-  for (int i = num_digits - 1; i >= 0; i--) {
+  for (int i = 0; i < num_digits; i++) {
     sink.append(buffer[i]);
     emit_grouping();
   }
@@ -258,16 +398,12 @@ void format_obj(S &sink, char ch, format_spec) {
 
 template <Sink S>
 void format_obj(S &sink, std::string_view &str, format_spec) {
-  for (const auto ch : str) {
-    sink.append(ch);
-  }
+  details::append_n(sink, str.data(), str.size());
 }
 
 template <Sink S>
 void format_obj(S &sink, const char *str, format_spec) {
-  while (*str) {
-    sink.append(*str++);
-  }
+  sink.append(str);
 }
 
 template <Sink S>
@@ -370,7 +506,7 @@ struct format_impl {
     return false;
   }
 
-  bool parse(std::string_view fmt, size_t &pos, format_spec spec) const {
+  bool parse(std::string_view fmt, size_t &pos, format_spec &spec) const {
     using namespace details;
 
     enum class modes { pos, fill, width, conv };
@@ -519,6 +655,541 @@ auto fmt(std::string_view fmt, Args &&...args) {
   return format_impl<Args...>{fmt,
                               std::tuple<Args...>{std::forward<Args>(args)...}};
 }
+
+// printf-style format strings, for callers that keep the C conventions
+// (the kernel log). The parser is constexpr so that argument lists can be
+// checked at compile time and the same code can walk the string at runtime.
+namespace details {
+struct printf_spec {
+  // The conversion spans [start, end) of the format string.
+  size_t start = 0;
+  size_t end = 0;
+
+  // Length modifier: "", "hh", "h", "l", "ll", "z", "j", "t".
+  char length[3] = {};
+  char conversion = 0;
+
+  int width = 0;
+  // -1 if the conversion has no precision.
+  int precision = -1;
+
+  bool left_justify = false;
+  bool always_sign = false;
+  bool space_sign = false;
+  bool alt_form = false;
+  bool fill_zeros = false;
+  bool star_width = false;
+  bool star_precision = false;
+};
+
+// Parse the conversion that starts at fmt[pos] == '%'. Returns false on a
+// malformed or unsupported conversion.
+constexpr bool parse_printf_spec(std::string_view fmt, size_t pos,
+                                 printf_spec &spec) {
+  spec = {};
+  spec.start = pos++;
+
+  for (; pos < fmt.size(); ++pos) {
+    if (fmt[pos] == '-') {
+      spec.left_justify = true;
+    } else if (fmt[pos] == '+') {
+      spec.always_sign = true;
+    } else if (fmt[pos] == ' ') {
+      spec.space_sign = true;
+    } else if (fmt[pos] == '#') {
+      spec.alt_form = true;
+    } else if (fmt[pos] == '0') {
+      spec.fill_zeros = true;
+    } else {
+      break;
+    }
+  }
+
+  if ((pos < fmt.size()) && (fmt[pos] == '*')) {
+    spec.star_width = true;
+    pos++;
+  } else {
+    while ((pos < fmt.size()) && (fmt[pos] >= '0') && (fmt[pos] <= '9')) {
+      spec.width = (spec.width * 10) + (fmt[pos++] - '0');
+    }
+  }
+
+  if ((pos < fmt.size()) && (fmt[pos] == '.')) {
+    spec.precision = 0;
+    pos++;
+
+    if ((pos < fmt.size()) && (fmt[pos] == '*')) {
+      spec.star_precision = true;
+      pos++;
+    } else {
+      while ((pos < fmt.size()) && (fmt[pos] >= '0') && (fmt[pos] <= '9')) {
+        spec.precision = (spec.precision * 10) + (fmt[pos++] - '0');
+      }
+    }
+  }
+
+  size_t length = 0;
+
+  while ((pos < fmt.size()) && (length < 2) &&
+         std::string_view("hlzjt").find(fmt[pos]) != std::string_view::npos) {
+    spec.length[length++] = fmt[pos++];
+  }
+
+  if (pos >= fmt.size()) {
+    return false;
+  }
+
+  spec.conversion = fmt[pos++];
+  spec.end = pos;
+
+  return std::string_view("diouxXcsp%").find(spec.conversion) !=
+         std::string_view::npos;
+}
+
+enum class printf_arg {
+  integer,
+  pointer,
+  string,
+  other,
+};
+
+template <typename T>
+consteval printf_arg classify_printf_arg() {
+  using D = std::decay_t<T>;
+
+  if constexpr (std::is_same_v<D, const char *> || std::is_same_v<D, char *>) {
+    return printf_arg::string;
+  } else if constexpr (std::is_pointer_v<D> || std::is_null_pointer_v<D>) {
+    return printf_arg::pointer;
+  } else if constexpr (std::is_integral_v<D> || std::is_enum_v<D>) {
+    return printf_arg::integer;
+  } else {
+    return printf_arg::other;
+  }
+}
+
+constexpr bool printf_size_matches(const printf_spec &spec, size_t size) {
+  const std::string_view length(spec.length);
+
+  // No modifier, "h" and "hh" take an int after promotion.
+  if (length.empty() || (length[0] == 'h')) {
+    return size <= sizeof(int);
+  }
+
+  return size == sizeof(long);
+}
+}  // namespace details
+
+// True if `args` fit the printf-style `fmt`: one argument per conversion and
+// per '*', integers of the size the length modifier asks for, strings for
+// %s and pointers or strings for %p. Floating point is not supported.
+template <typename... Args>
+consteval bool check_printf(std::string_view fmt) {
+  using namespace details;
+
+  constexpr printf_arg kinds[] = {classify_printf_arg<Args>()...,
+                                  printf_arg::other};
+  constexpr size_t sizes[] = {sizeof(std::decay_t<Args>)..., 0};
+
+  size_t arg = 0;
+
+  auto take = [&](printf_arg kind) -> bool {
+    return (arg < sizeof...(Args)) && (kinds[arg++] == kind);
+  };
+
+  for (size_t i = 0; i < fmt.size(); ++i) {
+    if (fmt[i] != '%') {
+      continue;
+    }
+
+    printf_spec spec;
+
+    if (!parse_printf_spec(fmt, i, spec)) {
+      return false;
+    }
+
+    i = spec.end - 1;
+
+    if (spec.conversion == '%') {
+      continue;
+    }
+
+    if (spec.star_width && !take(printf_arg::integer)) {
+      return false;
+    }
+
+    if (spec.star_precision && !take(printf_arg::integer)) {
+      return false;
+    }
+
+    switch (spec.conversion) {
+      case 's':
+        if (!take(printf_arg::string)) {
+          return false;
+        }
+        break;
+      case 'p':
+        // Not strings: the kernel log keeps a copy of those, not the
+        // pointer. Cast to const void* to print a string's address.
+        if (!take(printf_arg::pointer)) {
+          return false;
+        }
+        break;
+      default:
+        if ((arg >= sizeof...(Args)) ||
+            !printf_size_matches(spec, sizes[arg]) ||
+            !take(printf_arg::integer)) {
+          return false;
+        }
+        break;
+    }
+  }
+
+  return arg == sizeof...(Args);
+}
+
+// A string literal as a template argument, e.g. format_printf<"%d">().
+template <size_t N>
+struct fixed_string {
+  consteval fixed_string(const char (&str)[N]) {
+    std::copy_n(str, N, this->data);
+  }
+
+  constexpr std::string_view view() const {
+    return std::string_view(this->data, N - 1);
+  }
+
+  char data[N] = {};
+};
+
+// Fixed-size output buffer with snprintf() semantics: what does not fit is
+// dropped but still counted, and finish() NUL-terminates.
+class buffer_sink {
+ public:
+  buffer_sink(char *out, size_t size) : m_out(out), m_size(size) {
+  }
+
+  void append(char ch) {
+    if ((this->m_length + 1) < this->m_size) {
+      this->m_out[this->m_length] = ch;
+    }
+
+    this->m_length++;
+  }
+
+  void append(const char *str) {
+    this->append(str, strlen(str));
+  }
+
+  void append(const char *str, size_t count) {
+    if ((this->m_length + 1) < this->m_size) {
+      memcpy(this->m_out + this->m_length, str,
+             std::min(count, this->m_size - this->m_length - 1));
+    }
+
+    this->m_length += count;
+  }
+
+  // Length of the full output, which may exceed the buffer.
+  size_t finish() {
+    if (this->m_size != 0) {
+      this->m_out[std::min(this->m_length, this->m_size - 1)] = '\0';
+    }
+
+    return this->m_length;
+  }
+
+ private:
+  char *m_out;
+  size_t m_size;
+  size_t m_length = 0;
+};
+
+// Compiled printf formats. The format string is split at compile time into
+// literal runs and conversions with their flags decoded, and each piece is
+// instantiated as its own emitter, so a call expands to straight-line code
+// with no parsing left at runtime.
+namespace details {
+struct printf_piece {
+  printf_spec spec;
+  // Literal text [start, start + length) of the format string.
+  size_t start = 0;
+  size_t length = 0;
+  // First argument taken by a conversion, counting '*' ones.
+  size_t arg = 0;
+  bool literal = false;
+};
+
+template <size_t N>
+struct printf_program {
+  printf_piece pieces[N];
+  size_t count = 0;
+};
+
+// Split `fmt` into pieces, stored in `out` unless it is null. Returns the
+// number of pieces. A "%%" becomes a one-character literal.
+constexpr size_t split_printf(std::string_view fmt, printf_piece *out) {
+  size_t count = 0;
+  size_t arg = 0;
+  size_t literal = 0;
+
+  auto add = [&](size_t start, size_t length, const printf_spec *spec) {
+    if (out != nullptr) {
+      out[count].start = start;
+      out[count].length = length;
+      out[count].literal = (spec == nullptr);
+
+      if (spec != nullptr) {
+        out[count].spec = *spec;
+        out[count].arg = arg;
+      }
+    }
+
+    count++;
+  };
+
+  for (size_t i = 0; i <= fmt.size(); ++i) {
+    if ((i < fmt.size()) && (fmt[i] != '%')) {
+      continue;
+    }
+
+    if (i > literal) {
+      add(literal, i - literal, nullptr);
+    }
+
+    printf_spec spec;
+
+    // check_printf() rejects a malformed conversion.
+    if ((i == fmt.size()) || !parse_printf_spec(fmt, i, spec)) {
+      break;
+    }
+
+    i = spec.end - 1;
+    literal = spec.end;
+
+    if (spec.conversion == '%') {
+      add(spec.end - 1, 1, nullptr);
+      continue;
+    }
+
+    add(0, 0, &spec);
+    arg += 1 + (spec.star_width ? 1 : 0) + (spec.star_precision ? 1 : 0);
+  }
+
+  return count;
+}
+
+template <fixed_string Fmt>
+consteval auto compile_printf() {
+  printf_program<split_printf(Fmt.view(), nullptr) + 1> program;
+  program.count = split_printf(Fmt.view(), program.pieces);
+  return program;
+}
+
+// The argument as the integer type the conversion and its length modifier
+// ask for.
+template <printf_spec Spec, typename T>
+constexpr auto printf_integer(T value) {
+  constexpr bool is_signed = (Spec.conversion == 'd') ||
+                             (Spec.conversion == 'i');
+
+  if constexpr (std::is_enum_v<T>) {
+    return printf_integer<Spec>(std::to_underlying(value));
+  } else if constexpr ((Spec.length[0] == 'h') && (Spec.length[1] == 'h')) {
+    return static_cast<std::conditional_t<is_signed, signed char,
+                                          unsigned char>>(value);
+  } else if constexpr (Spec.length[0] == 'h') {
+    return static_cast<std::conditional_t<is_signed, short, unsigned short>>(
+        value);
+  } else {
+    using P = decltype(+value);
+    return static_cast<std::conditional_t<is_signed, std::make_signed_t<P>,
+                                          std::make_unsigned_t<P>>>(value);
+  }
+}
+
+template <Sink S>
+void emit_padded(S &sink, const char *str, size_t length, int width,
+                 bool left) {
+  const size_t pad =
+      (static_cast<size_t>(width) > length) ? (width - length) : 0;
+
+  if (!left) {
+    append_fill(sink, ' ', pad);
+  }
+
+  append_n(sink, str, length);
+
+  if (left) {
+    append_fill(sink, ' ', pad);
+  }
+}
+
+template <printf_spec Spec, Sink S>
+void emit_integer(S &sink, unsigned long long magnitude, bool negative,
+                  int width, int precision, bool left) {
+  constexpr char conv = Spec.conversion;
+  constexpr bool is_hex = (conv == 'x') || (conv == 'X') || (conv == 'p');
+  constexpr unsigned radix = (conv == 'o') ? 8 : (is_hex ? 16 : 10);
+
+  // A precision turns the '0' flag off.
+  const bool zero_pad = Spec.fill_zeros && !left && (precision < 0);
+
+  char buffer[24];
+  const char *begin = buffer;
+  int digits = 0;
+
+  // "%.0d" prints nothing for zero.
+  if ((magnitude != 0) || (precision != 0)) {
+    digits = write_digits<radix, conv == 'X'>(buffer, magnitude);
+  }
+
+  const char *prefix = "";
+  char sign = 0;
+
+  if (negative) {
+    sign = '-';
+  } else if (Spec.always_sign && ((conv == 'd') || (conv == 'i'))) {
+    sign = '+';
+  } else if (Spec.space_sign && ((conv == 'd') || (conv == 'i'))) {
+    sign = ' ';
+  }
+
+  if constexpr (conv == 'p') {
+    // Pointers always print every hex digit.
+    prefix = "0x";
+    precision = std::max<int>(precision, 2 * sizeof(void *));
+  } else if constexpr (Spec.alt_form && is_hex) {
+    if (magnitude != 0) {
+      prefix = (conv == 'X') ? "0X" : "0x";
+    }
+  } else if constexpr (Spec.alt_form && (conv == 'o')) {
+    // The first digit printed must be a zero.
+    if ((digits == 0) || (*begin != '0')) {
+      precision = std::max(precision, digits + 1);
+    }
+  }
+
+  const size_t prefix_length = strlen(prefix);
+  size_t zeros = (precision > digits) ? (precision - digits) : 0;
+  const size_t body = ((sign != 0) ? 1 : 0) + prefix_length + zeros + digits;
+  const size_t pad =
+      (static_cast<size_t>(width) > body) ? (width - body) : 0;
+
+  if (!left && !zero_pad) {
+    append_fill(sink, ' ', pad);
+  }
+
+  if (sign != 0) {
+    sink.append(sign);
+  }
+
+  append_n(sink, prefix, prefix_length);
+
+  if (zero_pad) {
+    zeros += pad;
+  }
+
+  append_fill(sink, '0', zeros);
+  append_n(sink, begin, digits);
+
+  if (left) {
+    append_fill(sink, ' ', pad);
+  }
+}
+
+template <printf_spec Spec, Sink S, typename T>
+void emit_value(S &sink, const T &value, int width, int precision,
+                bool left) {
+  using D = std::decay_t<T>;
+
+  if constexpr (Spec.conversion == 's') {
+    const char *str = value;
+
+    if (str == nullptr) {
+      str = "(null)";
+    }
+
+    const size_t length = (precision >= 0) ? strnlen(str, precision)
+                                           : strlen(str);
+    emit_padded(sink, str, length, width, left);
+  } else if constexpr (Spec.conversion == 'c') {
+    const char ch = static_cast<char>(value);
+    emit_padded(sink, &ch, 1, width, left);
+  } else if constexpr (Spec.conversion == 'p') {
+    uintptr_t addr = 0;
+
+    if constexpr (!std::is_null_pointer_v<D>) {
+      addr = reinterpret_cast<uintptr_t>(value);
+    }
+
+    emit_integer<Spec>(sink, addr, false, width, precision, left);
+  } else {
+    const auto num = printf_integer<Spec>(value);
+
+    if constexpr (std::is_signed_v<decltype(num)>) {
+      const bool negative = num < 0;
+      const unsigned long long magnitude =
+          negative ? (0ULL - static_cast<unsigned long long>(num)) : num;
+      emit_integer<Spec>(sink, magnitude, negative, width, precision, left);
+    } else {
+      emit_integer<Spec>(sink, num, false, width, precision, left);
+    }
+  }
+}
+
+template <fixed_string Fmt, printf_piece Piece, Sink S, typename... Args>
+void emit_piece(S &sink, const std::tuple<const Args &...> &args) {
+  if constexpr (Piece.literal && (Piece.length == 1)) {
+    sink.append(Fmt.data[Piece.start]);
+  } else if constexpr (Piece.literal) {
+    append_n(sink, Fmt.data + Piece.start, Piece.length);
+  } else {
+    constexpr printf_spec spec = Piece.spec;
+    constexpr size_t precision_arg = Piece.arg + (spec.star_width ? 1 : 0);
+    constexpr size_t value_arg =
+        precision_arg + (spec.star_precision ? 1 : 0);
+
+    int width = spec.width;
+    int precision = spec.precision;
+    bool left = spec.left_justify;
+
+    // As in printf(), a negative '*' width left-justifies and a negative
+    // '*' precision is no precision.
+    if constexpr (spec.star_width) {
+      width = static_cast<int>(std::get<Piece.arg>(args));
+
+      if (width < 0) {
+        left = true;
+        width = -width;
+      }
+    }
+
+    if constexpr (spec.star_precision) {
+      precision = std::max(static_cast<int>(std::get<precision_arg>(args)), -1);
+    }
+
+    emit_value<spec>(sink, std::get<value_arg>(args), width, precision, left);
+  }
+}
+}  // namespace details
+
+// printf() into `sink`, with `Fmt` compiled down to its pieces. Arguments
+// are checked like check_printf(); a mismatch fails to compile.
+template <fixed_string Fmt, Sink S, typename... Args>
+void format_printf(S &sink, const Args &...args) {
+  static_assert(check_printf<Args...>(Fmt.view()),
+                "printf format does not match the arguments");
+
+  if constexpr (check_printf<Args...>(Fmt.view())) {
+    static constexpr auto program = details::compile_printf<Fmt>();
+    const std::tuple<const Args &...> refs(args...);
+
+    [&]<size_t... Idx>(std::index_sequence<Idx...>) {
+      (details::emit_piece<Fmt, program.pieces[Idx]>(sink, refs), ...);
+    }(std::make_index_sequence<program.count>{});
+  }
+}
 }  // namespace format
 
 #endif  // LIBS_FORMAT_HPP
@@ -0,0 +1,214 @@
+#ifndef LOCKSTAT_HPP
+#define LOCKSTAT_HPP 1
+
+// Lock contention statistics. Debug builds only: with NOISE_DEBUG=0 none of
+// this exists and the locks carry no extra state or code.
+
+#if NOISE_DEBUG
+
+#include "arch/arch.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <atomic>
+
+// Distinct lock classes tracked. The last slot is the "overflow" class,
+// which collects every class past the others.
+#define LOCKSTAT_MAX_CLASSES 64
+
+namespace libs {
+// Counters of one lock class, i.e. every lock created with the same name.
+// Cycles are TSC cycles.
+struct LockClassStats {
+  const char* name;
+
+  uint64_t acquisitions;
+  uint64_t contended;
+
+  uint64_t wait_cycles;
+  uint64_t max_wait_cycles;
+
+  uint64_t hold_cycles;
+  uint64_t max_hold_cycles;
+};
+
+namespace details {
+struct LockClass {
+  std::atomic<const char*> name;
+
+  std::atomic_uint64_t acquisitions;
+  std::atomic_uint64_t contended;
+
+  std::atomic_uint64_t wait_cycles;
+  std::atomic_uint64_t max_wait_cycles;
+
+  std::atomic_uint64_t hold_cycles;
+  std::atomic_uint64_t max_hold_cycles;
+};
+
+inline LockClass lock_classes[LOCKSTAT_MAX_CLASSES];
+inline std::atomic_size_t lock_class_count;
+inline std::atomic_bool lock_class_busy;
+
+inline void update_max(std::atomic_uint64_t& max, uint64_t value) {
+  uint64_t curr = max.load(std::memory_order_relaxed);
+
+  while ((value > curr) &&
+         !max.compare_exchange_weak(curr, value, std::memory_order_relaxed)) {
+  }
+}
+
+// Slow path, once per lock: classes are matched by name, since the same
+// literal may live at different addresses in different objects. Interrupts
+// stay off while the table is busy, or a handler taking a lock for the first
+// time would spin on it forever.
+inline LockClass* find_lock_class(const char* name) {
+  const bool interrupts = arch::int_status();
+  arch::int_switch(false);
+
+  while (lock_class_busy.exchange(true, std::memory_order_acquire)) {
+    arch::pause();
+  }
+
+  const size_t count = lock_class_count.load(std::memory_order_relaxed);
+  LockClass* ret = nullptr;
+
+  for (size_t i = 0; i < count; ++i) {
+    const char* curr = lock_classes[i].name.load(std::memory_order_relaxed);
+
+    if ((curr == name) || (strcmp(curr, name) == 0)) {
+      ret = &lock_classes[i];
+      break;
+    }
+  }
+
+  if (ret == nullptr) {
+    if (count < (LOCKSTAT_MAX_CLASSES - 1)) {
+      ret = &lock_classes[count];
+      ret->name.store(name, std::memory_order_relaxed);
+      lock_class_count.store(count + 1, std::memory_order_release);
+    } else {
+      ret = &lock_classes[LOCKSTAT_MAX_CLASSES - 1];
+
+      if (count < LOCKSTAT_MAX_CLASSES) {
+        ret->name.store("overflow", std::memory_order_relaxed);
+        lock_class_count.store(LOCKSTAT_MAX_CLASSES, std::memory_order_release);
+      }
+    }
+  }
+
+  lock_class_busy.store(false, std::memory_order_release);
+  arch::int_switch(interrupts);
+  return ret;
+}
+
+// Per-lock bookkeeping embedded in every spinlock.
+class LockStat {
+ public:
+  constexpr explicit LockStat(const char* name)
+      : name(name), lock_class(nullptr), acquired_at(0) {
+  }
+
+  // Called with the lock held.
+  void acquired(uint64_t wait_start, bool contended) {
+    const uint64_t now = arch::cycles();
+
+    if (this->lock_class == nullptr) {
+      this->lock_class =
+          find_lock_class((this->name != nullptr) ? this->name : "unnamed");
+    }
+
+    LockClass* cls = this->lock_class;
+    cls->acquisitions.fetch_add(1, std::memory_order_relaxed);
+
+    if (contended) {
+      const uint64_t wait = now - wait_start;
+
+      cls->contended.fetch_add(1, std::memory_order_relaxed);
+      cls->wait_cycles.fetch_add(wait, std::memory_order_relaxed);
+      update_max(cls->max_wait_cycles, wait);
+    }
+
+    this->acquired_at = now;
+  }
+
+  // Called with the lock still held.
+  void released() {
+    if (this->lock_class == nullptr) {
+      return;
+    }
+
+    const uint64_t hold = arch::cycles() - this->acquired_at;
+
+    this->lock_class->hold_cycles.fetch_add(hold, std::memory_order_relaxed);
+    update_max(this->lock_class->max_hold_cycles, hold);
+  }
+
+ private:
+  const char* name;
+  LockClass* lock_class;
+  uint64_t acquired_at;
+};
+}  // namespace details
+
+// Copy up to `max` classes into `out`, sorted by total wait time, worst
+// first. Returns the number copied.
+inline size_t get_lock_stats(LockClassStats* out, size_t max) {
+  const size_t count =
+      details::lock_class_count.load(std::memory_order_acquire);
+  size_t ret = 0;
+
+  for (size_t i = 0; i < count; ++i) {
+    const details::LockClass& cls = details::lock_classes[i];
+
+    LockClassStats stats = {
+        .name = cls.name.load(std::memory_order_relaxed),
+        .acquisitions = cls.acquisitions.load(std::memory_order_relaxed),
+        .contended = cls.contended.load(std::memory_order_relaxed),
+        .wait_cycles = cls.wait_cycles.load(std::memory_order_relaxed),
+        .max_wait_cycles = cls.max_wait_cycles.load(std::memory_order_relaxed),
+        .hold_cycles = cls.hold_cycles.load(std::memory_order_relaxed),
+        .max_hold_cycles = cls.max_hold_cycles.load(std::memory_order_relaxed),
+    };
+
+    // Insertion sort; there are only a few dozen classes.
+    size_t pos = (ret < max) ? ret++ : max;
+
+    while ((pos > 0) && (out[pos - 1].wait_cycles < stats.wait_cycles)) {
+      if (pos < max) {
+        out[pos] = out[pos - 1];
+      }
+
+      pos--;
+    }
+
+    if (pos < max) {
+      out[pos] = stats;
+    }
+  }
+
+  return ret;
+}
+
+inline void reset_lock_stats() {
+  const size_t count =
+      details::lock_class_count.load(std::memory_order_acquire);
+
+  for (size_t i = 0; i < count; ++i) {
+    details::LockClass& cls = details::lock_classes[i];
+
+    cls.acquisitions.store(0, std::memory_order_relaxed);
+    cls.contended.store(0, std::memory_order_relaxed);
+    cls.wait_cycles.store(0, std::memory_order_relaxed);
+    cls.max_wait_cycles.store(0, std::memory_order_relaxed);
+    cls.hold_cycles.store(0, std::memory_order_relaxed);
+    cls.max_hold_cycles.store(0, std::memory_order_relaxed);
+  }
+}
+}  // namespace libs
+
+#endif  // NOISE_DEBUG
+
+#endif  // LOCKSTAT_HPP
@@ -3,17 +3,51 @@
 
 #include "format.hpp"
 
+#include <stddef.h>
+#include <string.h>
+
+#include <algorithm>
+#include <concepts>
+#include <utility>
+
 namespace logger {
+// A sink that takes the logger's output one span at a time, each span valid
+// only for the duration of the call.
+template <typename T>
+concept SpanSink = requires(T t, const char* str, size_t length) {
+  t(str, length);
+};
+
+// A sink that lends the logger its own storage, e.g. free space in a ring
+// buffer. reserve() returns the contiguous free space and its size, or
+// nullptr when full; commit() publishes the first `length` bytes of it.
+template <typename T>
+concept RingSink = requires(T t, size_t* size, size_t length) {
+  { t.reserve(size) } -> std::same_as<char*>;
+  t.commit(length);
+};
+
+// Formats into a window and hands it to the sink when full or flushed. With
+// a RingSink the window is the sink's reserved space, so output is written
+// in place; otherwise it is a local buffer, and spans that would not fit in
+// it go to the sink directly.
 template <typename Sink>
+  requires SpanSink<Sink> || RingSink<Sink>
 struct logger {
  public:
   logger(Sink sink = {}) : m_sink(std::move(sink)) {
+    if constexpr (!RingSink<Sink>) {
+      this->m_window = this->m_buffer;
+      this->m_window_size = sizeof(this->m_buffer);
+    }
   }
 
   logger(const logger&) = delete;
   logger& operator=(const logger&) = delete;
 
-  ~logger() = default;
+  ~logger() {
+    this->flush();
+  }
 
   template <typename T>
   void write(T&& obj) {
@@ -21,31 +55,88 @@ struct logger {
   }
 
   void append(char ch) {
-    constexpr size_t buf_size = sizeof(m_buffer) / sizeof(m_buffer[0]);
-
-    if ((this->m_offset + 1) == buf_size) {
-      this->m_buffer[this->m_offset] = '\0';
-      this->flush();
-      this->m_offset = 0;
+    if (this->m_offset < this->m_window_size) {
+      this->m_window[this->m_offset++] = ch;
+      return;
     }
 
-    this->m_buffer[this->m_offset++] = ch;
+    this->append(&ch, 1);
   }
 
   void append(const char* str) {
-    while (*str) {
-      this->append(*str++);
+    this->append(str, strlen(str));
+  }
+
+  void append(const char* str, size_t count) {
+    while (count != 0) {
+      if (this->m_offset == this->m_window_size && !this->refill()) {
+        this->m_dropped += count;
+        return;
+      }
+
+      if constexpr (!RingSink<Sink>) {
+        if (this->m_offset == 0 && count >= this->m_window_size) {
+          this->m_sink(str, count);
+          return;
+        }
+      }
+
+      const size_t chunk =
+          std::min(count, this->m_window_size - this->m_offset);
+
+      memcpy(this->m_window + this->m_offset, str, chunk);
+      this->m_offset += chunk;
+      str += chunk;
+      count -= chunk;
     }
   }
 
+  // Pass everything appended so far to the sink.
   void flush() {
-    this->m_sink(this->m_buffer);
+    if constexpr (RingSink<Sink>) {
+      if (this->m_window != nullptr) {
+        this->m_sink.commit(this->m_offset);
+      }
+
+      // Do not hold on to ring space between messages.
+      this->m_window = nullptr;
+      this->m_window_size = 0;
+    } else if (this->m_offset != 0) {
+      this->m_sink(this->m_buffer, this->m_offset);
+    }
+
+    this->m_offset = 0;
+  }
+
+  // Bytes lost because a RingSink had no space left.
+  size_t dropped() const {
+    return this->m_dropped;
   }
 
  private:
+  // Make room after the window filled up. Returns false if there is none.
+  bool refill() {
+    if constexpr (RingSink<Sink>) {
+      this->flush();
+      this->m_window = this->m_sink.reserve(&this->m_window_size);
+
+      if (this->m_window == nullptr) {
+        this->m_window_size = 0;
+      }
+
+      return this->m_window_size != 0;
+    } else {
+      this->flush();
+      return true;
+    }
+  }
+
   Sink m_sink = {};
-  char m_buffer[128] = {0};
+  char m_buffer[RingSink<Sink> ? 1 : 128] = {0};
+  char* m_window = nullptr;
+  size_t m_window_size = 0;
   size_t m_offset = 0;
+  size_t m_dropped = 0;
 };
 }  // namespace logger
 
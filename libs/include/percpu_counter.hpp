@@ -0,0 +1,70 @@
+#ifndef PERCPU_COUNTER_HPP
+#define PERCPU_COUNTER_HPP 1
+
+#include "arch/arch.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+namespace libs {
+// Counter split into one cache line per CPU. Updates touch only the local
+// line, so hot statistics do not bounce between CPUs; reading sums every
+// slot and is only exact when no update is in flight. Safe from interrupt
+// context.
+template <typename T = int64_t>
+class PerCpuCounter {
+ public:
+  constexpr PerCpuCounter() = default;
+
+  PerCpuCounter(const PerCpuCounter&) = delete;
+  PerCpuCounter(PerCpuCounter&&) = delete;
+
+  PerCpuCounter& operator=(const PerCpuCounter&) = delete;
+  PerCpuCounter& operator=(PerCpuCounter&&) = delete;
+
+  void add(T delta) {
+    this->slots[arch::cpu_id()].value.fetch_add(delta,
+                                                std::memory_order_relaxed);
+  }
+
+  void inc() {
+    this->add(1);
+  }
+
+  void dec() {
+    this->add(-1);
+  }
+
+  // This CPU's share only.
+  T read_local() const {
+    return this->slots[arch::cpu_id()].value.load(std::memory_order_relaxed);
+  }
+
+  T read() const {
+    T ret = 0;
+
+    for (const Slot& slot : this->slots) {
+      ret += slot.value.load(std::memory_order_relaxed);
+    }
+
+    return ret;
+  }
+
+  void reset() {
+    for (Slot& slot : this->slots) {
+      slot.value.store(0, std::memory_order_relaxed);
+    }
+  }
+
+ private:
+  struct alignas(64) Slot {
+    std::atomic<T> value = 0;
+  };
+
+  Slot slots[MAX_CPUS];
+};
+}  // namespace libs
+
+#endif  // PERCPU_COUNTER_HPP
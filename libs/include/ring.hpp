@@ -0,0 +1,258 @@
+#ifndef RING_HPP
+#define RING_HPP 1
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <utility>
+
+// Bounded lock-free queues. None of them allocate or block, so they can be
+// used from interrupt context: a full push and an empty pop just fail.
+// Capacities must be powers of two.
+
+namespace libs {
+namespace details {
+template <size_t N>
+constexpr bool is_ring_size() {
+  return (N >= 2) && ((N & (N - 1)) == 0);
+}
+
+// Slot with a sequence number, after Dmitry Vyukov's bounded MPMC queue.
+// The sequence tells whose turn the slot is: `pos` when free for the
+// producer of position `pos`, `pos + 1` once that element is published.
+template <typename T>
+struct SequencedSlot {
+  std::atomic_size_t sequence;
+  T value;
+};
+}  // namespace details
+
+// Single producer, single consumer. Head and tail live on separate cache
+// lines and each side keeps a stale copy of the other's index, so in steady
+// state the two sides only touch each other's line once per wraparound.
+template <typename T, size_t N>
+class SpscRing {
+  static_assert(details::is_ring_size<N>(), "size must be a power of two");
+
+ public:
+  constexpr SpscRing() = default;
+
+  SpscRing(const SpscRing&) = delete;
+  SpscRing(SpscRing&&) = delete;
+
+  SpscRing& operator=(const SpscRing&) = delete;
+  SpscRing& operator=(SpscRing&&) = delete;
+
+  bool push(const T& value) {
+    const size_t tail = this->producer.tail.load(std::memory_order_relaxed);
+
+    if ((tail - this->producer.cached_head) == N) {
+      this->producer.cached_head =
+          this->consumer.head.load(std::memory_order_acquire);
+
+      if ((tail - this->producer.cached_head) == N) {
+        return false;
+      }
+    }
+
+    this->slots[tail & (N - 1)] = value;
+    this->producer.tail.store(tail + 1, std::memory_order_release);
+
+    return true;
+  }
+
+  bool pop(T& value) {
+    const size_t head = this->consumer.head.load(std::memory_order_relaxed);
+
+    if (head == this->consumer.cached_tail) {
+      this->consumer.cached_tail =
+          this->producer.tail.load(std::memory_order_acquire);
+
+      if (head == this->consumer.cached_tail) {
+        return false;
+      }
+    }
+
+    value = std::move(this->slots[head & (N - 1)]);
+    this->consumer.head.store(head + 1, std::memory_order_release);
+
+    return true;
+  }
+
+  size_t size() const {
+    return this->producer.tail.load(std::memory_order_acquire) -
+           this->consumer.head.load(std::memory_order_acquire);
+  }
+
+  bool empty() const {
+    return this->size() == 0;
+  }
+
+  static constexpr size_t capacity() {
+    return N;
+  }
+
+ private:
+  struct alignas(64) Producer {
+    std::atomic_size_t tail = 0;
+    size_t cached_head = 0;
+  };
+
+  struct alignas(64) Consumer {
+    std::atomic_size_t head = 0;
+    size_t cached_tail = 0;
+  };
+
+  Producer producer;
+  Consumer consumer;
+
+  alignas(64) T slots[N] = {};
+};
+
+namespace details {
+// Producer side shared by MpmcQueue and MpscRing: a producer claims a
+// position with one compare-exchange on the tail line, fills the slot, then
+// publishes it through the slot's sequence number.
+template <typename T, size_t N>
+class SequencedRing {
+  static_assert(is_ring_size<N>(), "size must be a power of two");
+
+ public:
+  // Not constexpr on purpose: the slots start out non-zero, so a constant
+  // initialized ring would be stored in full in the image's data section.
+  SequencedRing() {
+    for (size_t i = 0; i < N; ++i) {
+      this->slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  SequencedRing(const SequencedRing&) = delete;
+  SequencedRing(SequencedRing&&) = delete;
+
+  SequencedRing& operator=(const SequencedRing&) = delete;
+  SequencedRing& operator=(SequencedRing&&) = delete;
+
+  bool push(const T& value) {
+    size_t pos = this->tail.load(std::memory_order_relaxed);
+    SequencedSlot<T>* slot = nullptr;
+
+    while (true) {
+      slot = &this->slots[pos & (N - 1)];
+
+      const size_t seq = slot->sequence.load(std::memory_order_acquire);
+      const intptr_t diff =
+          static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+      if (diff == 0) {
+        if (this->tail.compare_exchange_weak(pos, pos + 1,
+                                             std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        // The slot still holds the element from one lap ago: full.
+        return false;
+      } else {
+        pos = this->tail.load(std::memory_order_relaxed);
+      }
+    }
+
+    slot->value = value;
+    slot->sequence.store(pos + 1, std::memory_order_release);
+
+    return true;
+  }
+
+  size_t size() const {
+    const size_t tail = this->tail.load(std::memory_order_acquire);
+    const size_t head = this->head.load(std::memory_order_acquire);
+
+    return (tail > head) ? (tail - head) : 0;
+  }
+
+  bool empty() const {
+    return this->size() == 0;
+  }
+
+  static constexpr size_t capacity() {
+    return N;
+  }
+
+ protected:
+  // Move the element at `pos` out and hand the slot to the producer one lap
+  // ahead.
+  void take(size_t pos, T& value) {
+    SequencedSlot<T>& slot = this->slots[pos & (N - 1)];
+
+    value = std::move(slot.value);
+    slot.sequence.store(pos + N, std::memory_order_release);
+  }
+
+  bool published(size_t pos) const {
+    return this->slots[pos & (N - 1)].sequence.load(
+               std::memory_order_acquire) == (pos + 1);
+  }
+
+  alignas(64) std::atomic_size_t tail = 0;
+  alignas(64) std::atomic_size_t head = 0;
+
+  alignas(64) SequencedSlot<T> slots[N];
+};
+}  // namespace details
+
+// Bounded multi-producer, multi-consumer queue. Consumers claim a position
+// with one compare-exchange on the head line, mirroring the producers.
+template <typename T, size_t N>
+class MpmcQueue : public details::SequencedRing<T, N> {
+ public:
+  bool pop(T& value) {
+    size_t pos = this->head.load(std::memory_order_relaxed);
+
+    while (true) {
+      const size_t seq =
+          this->slots[pos & (N - 1)].sequence.load(std::memory_order_acquire);
+      const intptr_t diff =
+          static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+
+      if (diff == 0) {
+        if (this->head.compare_exchange_weak(pos, pos + 1,
+                                             std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        // Empty, or the producer of this slot has not published yet.
+        return false;
+      } else {
+        pos = this->head.load(std::memory_order_relaxed);
+      }
+    }
+
+    this->take(pos, value);
+    return true;
+  }
+};
+
+// Bounded multi-producer, single-consumer ring; the consumer needs no
+// compare-exchange. A producer interrupted between claiming and publishing
+// a slot only delays the consumer, which sees the ring as empty until the
+// slot is filled. So an interrupt handler may push onto a ring that its own
+// CPU is in the middle of pushing to.
+template <typename T, size_t N>
+class MpscRing : public details::SequencedRing<T, N> {
+ public:
+  bool pop(T& value) {
+    const size_t pos = this->head.load(std::memory_order_relaxed);
+
+    if (!this->published(pos)) {
+      return false;
+    }
+
+    this->take(pos, value);
+    this->head.store(pos + 1, std::memory_order_relaxed);
+
+    return true;
+  }
+};
+}  // namespace libs
+
+#endif  // RING_HPP
@@ -0,0 +1,162 @@
+#ifndef RWLOCK_HPP
+#define RWLOCK_HPP 1
+
+#include "arch/arch.hpp"
+#include "spinlock.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+namespace libs {
+namespace details {
+struct alignas(64) ReaderCount {
+  std::atomic_uint32_t count;
+};
+}  // namespace details
+
+// Big-reader lock. Every CPU has its own reader count on its own cache line,
+// so readers never write a shared line and scale with the number of CPUs.
+// Writers are expensive in exchange: they walk all MAX_CPUS counters.
+//
+// The write side keeps interrupts off, so an interrupt handler may take the
+// read side without deadlocking against a writer on the same CPU. Readers
+// must unlock on the CPU they locked on.
+//
+//   libs::LockGuard guard(rw);           // writer
+//   libs::LockGuard guard(rw.reader());  // reader
+class BrLock {
+ public:
+  // Read side in the lock()/unlock() shape LockGuard expects.
+  class Reader {
+   public:
+    Reader(const Reader&) = delete;
+    Reader(Reader&&) = delete;
+
+    Reader& operator=(const Reader&) = delete;
+    Reader& operator=(Reader&&) = delete;
+
+    void lock() {
+      this->owner->lock_shared();
+    }
+
+    bool try_lock() {
+      return this->owner->try_lock_shared();
+    }
+
+    bool unlock() {
+      return this->owner->unlock_shared();
+    }
+
+   private:
+    friend class BrLock;
+
+    constexpr explicit Reader(BrLock* owner) : owner(owner) {
+    }
+
+    BrLock* owner;
+  };
+
+  constexpr BrLock() : BrLock(nullptr) {
+  }
+
+  constexpr explicit BrLock(const char* name)
+      : writer(false), writer_lock(name), counts{}, read_side(this) {
+  }
+
+  BrLock(const BrLock&) = delete;
+  BrLock(BrLock&&) = delete;
+
+  BrLock& operator=(const BrLock&) = delete;
+  BrLock& operator=(BrLock&&) = delete;
+
+  Reader& reader() {
+    return this->read_side;
+  }
+
+  bool try_lock_shared() {
+    std::atomic_uint32_t& count = this->counts[arch::cpu_id()].count;
+
+    // Announce first, then look for a writer. The writer does the opposite,
+    // so at least one of the two sees the other.
+    count.fetch_add(1, std::memory_order_seq_cst);
+
+    if (this->writer.load(std::memory_order_seq_cst)) {
+      count.fetch_sub(1, std::memory_order_release);
+      return false;
+    }
+
+    return true;
+  }
+
+  void lock_shared() {
+    while (!this->try_lock_shared()) {
+      while (this->writer.load(std::memory_order_relaxed)) {
+        arch::pause();
+      }
+    }
+  }
+
+  bool unlock_shared() {
+    std::atomic_uint32_t& count = this->counts[arch::cpu_id()].count;
+
+    if (count.load(std::memory_order_relaxed) == 0) {
+      return false;
+    }
+
+    count.fetch_sub(1, std::memory_order_release);
+    return true;
+  }
+
+  void lock() {
+    this->writer_lock.lock();
+    this->writer.store(true, std::memory_order_seq_cst);
+
+    for (const details::ReaderCount& reader : this->counts) {
+      while (reader.count.load(std::memory_order_acquire) != 0) {
+        arch::pause();
+      }
+    }
+  }
+
+  bool try_lock() {
+    if (!this->writer_lock.try_lock()) {
+      return false;
+    }
+
+    this->writer.store(true, std::memory_order_seq_cst);
+
+    for (const details::ReaderCount& reader : this->counts) {
+      if (reader.count.load(std::memory_order_acquire) != 0) {
+        this->unlock();
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  bool unlock() {
+    if (!this->writer.load(std::memory_order_relaxed)) {
+      return false;
+    }
+
+    this->writer.store(false, std::memory_order_release);
+    return this->writer_lock.unlock();
+  }
+
+  bool is_locked() const {
+    return this->writer.load(std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic_bool writer;
+  QueuedIrqLock writer_lock;
+
+  details::ReaderCount counts[MAX_CPUS];
+  Reader read_side;
+};
+}  // namespace libs
+
+#endif  // RWLOCK_HPP
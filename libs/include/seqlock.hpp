@@ -0,0 +1,139 @@
+#ifndef SEQLOCK_HPP
+#define SEQLOCK_HPP 1
+
+#include "arch/arch.hpp"
+#include "spinlock.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+namespace libs {
+// Sequence counter for small read-mostly data. Readers never write and never
+// block a writer: they copy the data and retry if a write overlapped. The
+// counter is odd while a write is in progress.
+//
+// Writers must already be serialized, e.g. by a lock protecting the data;
+// see SeqLock otherwise. lock()/unlock() are the write side, so a LockGuard
+// can mark the write section.
+class SeqCount {
+ public:
+  constexpr SeqCount() : sequence(0) {
+  }
+
+  SeqCount(const SeqCount&) = delete;
+  SeqCount(SeqCount&&) = delete;
+
+  SeqCount& operator=(const SeqCount&) = delete;
+  SeqCount& operator=(SeqCount&&) = delete;
+
+  uint32_t read_begin() const {
+    uint32_t seq = this->sequence.load(std::memory_order_acquire);
+
+    while ((seq & 1) != 0) {
+      arch::pause();
+      seq = this->sequence.load(std::memory_order_acquire);
+    }
+
+    return seq;
+  }
+
+  // True if the data read since read_begin() may be torn.
+  bool read_retry(uint32_t seq) const {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return this->sequence.load(std::memory_order_relaxed) != seq;
+  }
+
+  // Runs `func` until it observes a consistent snapshot, returns its result.
+  template <typename F>
+  auto read(F&& func) const {
+    while (true) {
+      const uint32_t seq = this->read_begin();
+      auto ret = func();
+
+      if (!this->read_retry(seq)) {
+        return ret;
+      }
+    }
+  }
+
+  void lock() {
+    this->sequence.store(this->sequence.load(std::memory_order_relaxed) + 1,
+                         std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+  bool unlock() {
+    const uint32_t seq = this->sequence.load(std::memory_order_relaxed);
+
+    if ((seq & 1) == 0) {
+      return false;
+    }
+
+    this->sequence.store(seq + 1, std::memory_order_release);
+    return true;
+  }
+
+ private:
+  std::atomic_uint32_t sequence;
+};
+
+// Sequence counter with its own writer lock. Writers keep interrupts off, so
+// readers in interrupt context cannot spin forever on a writer they
+// interrupted.
+class SeqLock {
+ public:
+  constexpr SeqLock() = default;
+
+  constexpr explicit SeqLock(const char* name) : writer_lock(name) {
+  }
+
+  SeqLock(const SeqLock&) = delete;
+  SeqLock(SeqLock&&) = delete;
+
+  SeqLock& operator=(const SeqLock&) = delete;
+  SeqLock& operator=(SeqLock&&) = delete;
+
+  uint32_t read_begin() const {
+    return this->count.read_begin();
+  }
+
+  bool read_retry(uint32_t seq) const {
+    return this->count.read_retry(seq);
+  }
+
+  template <typename F>
+  auto read(F&& func) const {
+    return this->count.read(static_cast<F&&>(func));
+  }
+
+  void lock() {
+    this->writer_lock.lock();
+    this->count.lock();
+  }
+
+  bool try_lock() {
+    if (!this->writer_lock.try_lock()) {
+      return false;
+    }
+
+    this->count.lock();
+    return true;
+  }
+
+  bool unlock() {
+    if (!this->count.unlock()) {
+      return false;
+    }
+
+    return this->writer_lock.unlock();
+  }
+
+ private:
+  SeqCount count;
+  IrqLock writer_lock;
+};
+}  // namespace libs
+
+#endif  // SEQLOCK_HPP
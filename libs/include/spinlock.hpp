@@ -2,25 +2,53 @@
 #define SPINLOCK_HPP 1
 
 #include "arch/arch.hpp"
+#include "lockstat.hpp"
 
 #include <stddef.h>
 #include <stdint.h>
 
 #include <atomic>
 
+// Queue nodes per CPU, one for each context that can nest on top of another
+// while waiting: thread, softirq, hardirq and NMI.
+#define QUEUED_LOCK_NESTING 4
+
 namespace libs {
 enum class LockType {
   SpinlockSpin,
   SpinlockIrq,
+  SpinlockQueued,
+  SpinlockQueuedIrq,
+};
+
+// MCS queue node. A waiter spins on its own node instead of the lock word, so
+// a handoff only touches the cache line of the next waiter.
+struct alignas(64) QueuedLockNode {
+  std::atomic<QueuedLockNode*> next;
+  std::atomic_bool locked;
 };
 
+inline QueuedLockNode queued_lock_nodes[MAX_CPUS][QUEUED_LOCK_NESTING];
+inline uint32_t queued_lock_depth[MAX_CPUS];
+
 template <LockType type>
 class Spinlock {};
 
 template <>
 class Spinlock<LockType::SpinlockSpin> {
  public:
-  constexpr Spinlock() : next_ticket(0), serving_ticket(0) {
+  constexpr Spinlock() : Spinlock(nullptr) {
+  }
+
+  // Locks sharing a name are one class in the lock statistics.
+  constexpr explicit Spinlock([[maybe_unused]] const char* name)
+      : next_ticket(0),
+        serving_ticket(0)
+#if NOISE_DEBUG
+        ,
+        stat(name)
+#endif
+  {
   }
 
   Spinlock(const Spinlock&) = delete;
@@ -32,9 +60,19 @@ class Spinlock<LockType::SpinlockSpin> {
   void lock() {
     size_t ticket = this->next_ticket.fetch_add(1, std::memory_order_relaxed);
 
+#if NOISE_DEBUG
+    const uint64_t start = arch::cycles();
+    const bool contended =
+        this->serving_ticket.load(std::memory_order_acquire) != ticket;
+#endif
+
     while (this->serving_ticket.load(std::memory_order_acquire) != ticket) {
       arch::pause();
     }
+
+#if NOISE_DEBUG
+    this->stat.acquired(start, contended);
+#endif
   }
 
   bool unlock() {
@@ -42,6 +80,10 @@ class Spinlock<LockType::SpinlockSpin> {
       return false;
     }
 
+#if NOISE_DEBUG
+    this->stat.released();
+#endif
+
     size_t curr = this->serving_ticket.load(std::memory_order_relaxed);
     this->serving_ticket.store(curr + 1, std::memory_order_release);
 
@@ -68,19 +110,44 @@ class Spinlock<LockType::SpinlockSpin> {
  private:
   std::atomic_size_t next_ticket;
   std::atomic_size_t serving_ticket;
+
+#if NOISE_DEBUG
+  details::LockStat stat;
+#endif
 };
 
 template <>
 class Spinlock<LockType::SpinlockIrq>
     : public Spinlock<LockType::SpinlockSpin> {
  public:
-  constexpr Spinlock() : Spinlock<LockType::SpinlockSpin>(), interrupts(false) {
+  constexpr Spinlock() : Spinlock(nullptr) {
+  }
+
+  constexpr explicit Spinlock(const char* name)
+      : Spinlock<LockType::SpinlockSpin>(name), interrupts(false) {
   }
 
   void lock() {
+    // Interrupts go off before spinning, so an interrupt handler on this CPU
+    // can never find the lock held by the code it interrupted.
+    const bool state = arch::int_status();
+    arch::int_switch(false);
+
     Spinlock<LockType::SpinlockSpin>::lock();
-    this->interrupts = arch::int_status();
+    this->interrupts = state;
+  }
+
+  bool try_lock() {
+    const bool state = arch::int_status();
     arch::int_switch(false);
+
+    if (!Spinlock<LockType::SpinlockSpin>::try_lock()) {
+      arch::int_switch(state);
+      return false;
+    }
+
+    this->interrupts = state;
+    return true;
   }
 
   bool unlock() {
@@ -99,6 +166,234 @@ class Spinlock<LockType::SpinlockIrq>
   bool interrupts;
 };
 
+// Queued spinlock in the style of Linux's qspinlock. The 32-bit lock word
+// holds the owner in its low byte and the tail of the MCS waiter queue in the
+// upper half. An uncontended lock is a single compare-exchange; under
+// contention only the queue head watches the lock word, everybody else spins
+// on their per-CPU node. Nodes are only used while waiting, so holding any
+// number of queued locks at once is fine.
+template <>
+class Spinlock<LockType::SpinlockQueued> {
+ public:
+  constexpr Spinlock() : Spinlock(nullptr) {
+  }
+
+  constexpr explicit Spinlock([[maybe_unused]] const char* name)
+      : value(0)
+#if NOISE_DEBUG
+        ,
+        stat(name)
+#endif
+  {
+  }
+
+  Spinlock(const Spinlock&) = delete;
+  Spinlock(Spinlock&&) = delete;
+
+  Spinlock& operator=(const Spinlock&) = delete;
+  Spinlock& operator=(Spinlock&&) = delete;
+
+  void lock() {
+    uint32_t expected = 0;
+
+    if (this->value.compare_exchange_strong(expected, LOCKED,
+                                            std::memory_order_acquire,
+                                            std::memory_order_relaxed)) {
+#if NOISE_DEBUG
+      this->stat.acquired(0, false);
+#endif
+      return;
+    }
+
+#if NOISE_DEBUG
+    const uint64_t start = arch::cycles();
+#endif
+
+    this->lock_slow();
+
+#if NOISE_DEBUG
+    this->stat.acquired(start, true);
+#endif
+  }
+
+  bool unlock() {
+    if (!is_locked()) {
+      return false;
+    }
+
+#if NOISE_DEBUG
+    this->stat.released();
+#endif
+
+    this->value.fetch_and(~LOCKED_MASK, std::memory_order_release);
+
+    return true;
+  }
+
+  bool is_locked() const {
+    return (this->value.load(std::memory_order_relaxed) & LOCKED_MASK) != 0;
+  }
+
+  bool try_lock() {
+    // Only when nobody is queued either, so queued waiters are not starved.
+    uint32_t expected = 0;
+
+    if (!this->value.compare_exchange_strong(expected, LOCKED,
+                                             std::memory_order_acquire,
+                                             std::memory_order_relaxed)) {
+      return false;
+    }
+
+#if NOISE_DEBUG
+    this->stat.acquired(0, false);
+#endif
+
+    return true;
+  }
+
+ private:
+  static constexpr uint32_t LOCKED = 1;
+  static constexpr uint32_t LOCKED_MASK = 0xff;
+  static constexpr uint32_t TAIL_SHIFT = 16;
+  static constexpr uint32_t TAIL_MASK = 0xffff0000;
+
+  static uint32_t encode_tail(uint32_t cpu, uint32_t idx) {
+    // CPU + 1, so that a zero tail means an empty queue.
+    return (((cpu + 1) << 2) | idx) << TAIL_SHIFT;
+  }
+
+  static QueuedLockNode* decode_tail(uint32_t value) {
+    const uint32_t tail = value >> TAIL_SHIFT;
+    return &queued_lock_nodes[(tail >> 2) - 1][tail & 3];
+  }
+
+  // Take the lock once the owner byte is clear. Clears the tail as well when
+  // we are the last waiter. Returns the lock word seen before.
+  uint32_t claim(uint32_t tail) {
+    uint32_t curr = this->value.load(std::memory_order_relaxed);
+
+    while (true) {
+      if ((curr & LOCKED_MASK) != 0) {
+        arch::pause();
+        curr = this->value.load(std::memory_order_relaxed);
+        continue;
+      }
+
+      const uint32_t desired = ((tail != 0) && ((curr & TAIL_MASK) == tail))
+                                   ? LOCKED
+                                   : (curr | LOCKED);
+
+      if (this->value.compare_exchange_weak(curr, desired,
+                                            std::memory_order_acquire,
+                                            std::memory_order_relaxed)) {
+        return curr;
+      }
+    }
+  }
+
+  void lock_slow() {
+    const uint32_t cpu = arch::cpu_id();
+    const uint32_t idx = queued_lock_depth[cpu]++;
+
+    if (idx >= QUEUED_LOCK_NESTING) {
+      // Out of nodes, nested too deep: spin on the lock word.
+      this->claim(0);
+      queued_lock_depth[cpu]--;
+      return;
+    }
+
+    QueuedLockNode* node = &queued_lock_nodes[cpu][idx];
+    node->next.store(nullptr, std::memory_order_relaxed);
+    node->locked.store(false, std::memory_order_relaxed);
+
+    const uint32_t tail = encode_tail(cpu, idx);
+    uint32_t prev = this->value.load(std::memory_order_relaxed);
+
+    while (!this->value.compare_exchange_weak(
+        prev, (prev & ~TAIL_MASK) | tail, std::memory_order_acq_rel,
+        std::memory_order_relaxed)) {
+    }
+
+    if ((prev & TAIL_MASK) != 0) {
+      decode_tail(prev)->next.store(node, std::memory_order_release);
+
+      while (!node->locked.load(std::memory_order_acquire)) {
+        arch::pause();
+      }
+    }
+
+    // Head of the queue: wait for the owner to go away.
+    const uint32_t seen = this->claim(tail);
+
+    if ((seen & TAIL_MASK) != tail) {
+      // Somebody queued behind us; they may not have linked in yet.
+      QueuedLockNode* next = nullptr;
+
+      while ((next = node->next.load(std::memory_order_acquire)) == nullptr) {
+        arch::pause();
+      }
+
+      next->locked.store(true, std::memory_order_release);
+    }
+
+    queued_lock_depth[cpu]--;
+  }
+
+  std::atomic_uint32_t value;
+
+#if NOISE_DEBUG
+  details::LockStat stat;
+#endif
+};
+
+template <>
+class Spinlock<LockType::SpinlockQueuedIrq>
+    : public Spinlock<LockType::SpinlockQueued> {
+ public:
+  constexpr Spinlock() : Spinlock(nullptr) {
+  }
+
+  constexpr explicit Spinlock(const char* name)
+      : Spinlock<LockType::SpinlockQueued>(name), interrupts(false) {
+  }
+
+  void lock() {
+    const bool state = arch::int_status();
+    arch::int_switch(false);
+
+    Spinlock<LockType::SpinlockQueued>::lock();
+    this->interrupts = state;
+  }
+
+  bool try_lock() {
+    const bool state = arch::int_status();
+    arch::int_switch(false);
+
+    if (!Spinlock<LockType::SpinlockQueued>::try_lock()) {
+      arch::int_switch(state);
+      return false;
+    }
+
+    this->interrupts = state;
+    return true;
+  }
+
+  bool unlock() {
+    if (!Spinlock<LockType::SpinlockQueued>::unlock()) {
+      return false;
+    }
+
+    if (arch::int_status() != interrupts) {
+      arch::int_switch(interrupts);
+    }
+
+    return true;
+  }
+
+ private:
+  bool interrupts;
+};
+
 struct DeferLock {
   explicit DeferLock() = default;
 };
@@ -251,6 +546,8 @@ LockGuard(Mutex&) -> LockGuard<Mutex>;
 
 using SpinLock = Spinlock<LockType::SpinlockSpin>;
 using IrqLock = Spinlock<LockType::SpinlockIrq>;
+using QueuedLock = Spinlock<LockType::SpinlockQueued>;
+using QueuedIrqLock = Spinlock<LockType::SpinlockQueuedIrq>;
 }  // namespace libs
 
 #endif  // SPINLOCK_HPP
@@ -3,3 +3,56 @@ target("libs-headers")
     set_kind("headeronly")
 
     add_includedirs("$(projectdir)/libs/include", {public = true})
+
+-- Host-side benchmarks, built with the native toolchain:
+--   xmake build spinlock-bench && xmake run spinlock-bench [threads] [ms]
+target("spinlock-bench")
+    set_default(false)
+    set_kind("binary")
+    set_plat(os.host())
+    set_arch(os.arch())
+    set_toolchains("gcc")
+    set_optimize("fastest")
+
+    add_files("bench/spinlock.cpp")
+    add_includedirs("bench/include", "include")
+    add_syslinks("pthread")
+
+target("ring-bench")
+    set_default(false)
+    set_kind("binary")
+    set_plat(os.host())
+    set_arch(os.arch())
+    set_toolchains("gcc")
+    set_optimize("fastest")
+
+    add_files("bench/ring.cpp")
+    add_includedirs("bench/include", "include")
+    add_syslinks("pthread")
+
+-- Shares the kernel's page clear/copy primitives, which are header-only and
+-- written in Intel syntax like the rest of the kernel.
+target("page-bench")
+    set_default(false)
+    set_kind("binary")
+    set_plat(os.host())
+    set_arch(os.arch())
+    set_toolchains("gcc")
+    set_optimize("fastest")
+
+    add_files("bench/page_ops.cpp")
+    add_includedirs("bench/include", "include", "../kernel/include")
+    add_cxflags("-masm=intel")
+
+-- Conversion checks for format.hpp plus formatting cost:
+--   xmake build format-bench && xmake run format-bench [--check-only]
+target("format-bench")
+    set_default(false)
+    set_kind("binary")
+    set_plat(os.host())
+    set_arch(os.arch())
+    set_toolchains("gcc")
+    set_optimize("fastest")
+
+    add_files("bench/format.cpp")
+    add_includedirs("bench/include", "include")
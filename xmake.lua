@@ -275,112 +275,146 @@ includes("dependencies/xmake.lua")
 
 -- targets.build
 
+-- Correctness checks run on the host, in bench binaries that exit non-zero
+-- on any failure (`--check-only` skips the timing where offered):
+--   klibc-bench   klibc mem*/str* against the host libc
+--   string-bench  word-at-a-time string scanners
+--   format-bench  format.hpp, compiled printf formats and the logger
+--   ring-bench    lock-free rings and per-CPU counters
+--   page-bench    page clear/copy results and cache pollution
+--   memory-sim    PMM and page tables replaying allocation traces
+-- e.g. `xmake build klibc-bench && xmake run klibc-bench --check-only`.
+-- `xmake bench` runs the in-kernel benchmarks under QEMU.
+
 includes("klibc/xmake.lua")
 includes("libs/xmake.lua")
 includes("kernel/xmake.lua")
 
-target("iso")
-    set_default(true)
-    set_kind("phony")
-    add_deps("limine", "ovmf-binaries", "noise.elf")
+-- Builds the bootable image of `target` around noise.elf. The image is
+-- named after its "image_name" value and boots with misc/<limine_conf>.
+local function build_iso(target)
+    import("core.project.project")
+    import("core.project.depend")
+    import("lib.detect.find_program")
 
-    on_clean(function (target)
-        os.rm(get_targetfile(target:targetdir(), "image", ".iso"))
-    end)
+    local targetfile = get_targetfile(target:targetdir(),
+        target:values("image_name"), ".iso")
+    target:set("values", "targetfile", targetfile)
 
-    on_build(function (target)
-        import("core.project.project")
-        import("core.project.depend")
-        import("lib.detect.find_program")
+    local kernel = project.target("noise.elf")
 
-        targetfile = get_targetfile(target:targetdir(), "image", ".iso")
-        target:set("values", "targetfile", targetfile)
+    local iso_dirname = "noise-" .. target:name() .. ".dir"
+    local iso_dir = path.join(os.tmpdir(), iso_dirname)
+    local iso_dir_b = path.join(iso_dir, "boot")
+    local iso_dir_bl = path.join(iso_dir, "boot/limine")
+    local iso_dir_eb = path.join(iso_dir, "EFI/BOOT")
 
-        local kernel = project.target("noise.elf")
+    local limine_dep = target:deps()["limine"]
+    local limine_exec = limine_dep:targetfile()
 
-        local iso_dirname = "noise.iso.dir"
-        local iso_dir = path.join(os.tmpdir(), iso_dirname)
-        local iso_dir_b = path.join(iso_dir, "boot")
-        local iso_dir_bl = path.join(iso_dir, "boot/limine")
-        local iso_dir_eb = path.join(iso_dir, "EFI/BOOT")
+    local binaries = limine_dep:get("values")["binaries"]
+    local uefi_binaries = limine_dep:get("values")["uefi-binaries"]
 
-        local limine_dep = target:deps()["limine"]
-        local limine_exec = limine_dep:targetfile()
+    local limine_conf = path.join(os.projectdir(), "misc",
+        target:values("limine_conf"))
 
-        local binaries = limine_dep:get("values")["binaries"]
-        local uefi_binaries = limine_dep:get("values")["uefi-binaries"]
+    local xorriso_args = {
+        "-as", "mkisofs"
+    }
 
-        local limine_files = {
-            "$(projectdir)/misc/limine.conf"
-        }
+    if is_arch("x86_64") then
+        multi_insert(xorriso_args,
+            "-b", "boot/limine/limine-bios-cd.bin",
+            "-no-emul-boot", "-boot-load-size", "4",
+            "-boot-info-table"
+        )
+    end
 
-        local xorriso_args = {
-            "-as", "mkisofs"
-        }
+    multi_insert(xorriso_args,
+        "--efi-boot", "boot/limine/limine-uefi-cd.bin",
+        "-efi-boot-part", "--efi-boot-image",
+        "--protective-msdos-label"
+    )
 
-        if is_arch("x86_64") then
-            multi_insert(xorriso_args,
-                "-b", "boot/limine/limine-bios-cd.bin",
-                "-no-emul-boot", "-boot-load-size", "4",
-                "-boot-info-table"
-            )
+    local kernelfile = kernel:targetfile()
+    local created = false
+
+    local function create_iso()
+        os.tryrm(targetfile)
+        os.tryrm(iso_dir)
+
+        os.mkdir(iso_dir)
+        os.mkdir(iso_dir_b)
+        os.mkdir(iso_dir_bl)
+        os.mkdir(iso_dir_eb)
+
+        print(" => copying target files to temporary iso directory...")
+
+        os.cp(limine_conf, path.join(iso_dir_bl, "limine.conf"))
+
+        for idx, val in ipairs(binaries) do
+            os.cp(val, iso_dir_bl)
         end
 
-        multi_insert(xorriso_args,
-            "--efi-boot", "boot/limine/limine-uefi-cd.bin",
-            "-efi-boot-part", "--efi-boot-image",
-            "--protective-msdos-label"
-        )
+        for idx, val in ipairs(uefi_binaries) do
+            os.cp(val, iso_dir_eb)
+        end
 
-        local kernelfile = kernel:targetfile()
-        local created = false
+        os.cp(kernelfile, path.join(iso_dir_b, "kernel.elf"))
 
-        local function create_iso()
-            os.tryrm(targetfile)
-            os.tryrm(iso_dir)
+        multi_insert(xorriso_args,
+            iso_dir, "-o", targetfile
+        )
 
-            os.mkdir(iso_dir)
-            os.mkdir(iso_dir_b)
-            os.mkdir(iso_dir_bl)
-            os.mkdir(iso_dir_eb)
+        print(" => building the iso...")
+        os.execv(find_program("xorriso"), xorriso_args)
 
-            print(" => copying target files to temporary iso directory...")
+        print(" => installing limine...")
+        os.execv(limine_exec, { "bios-install", targetfile })
 
-            for idx, val in ipairs(limine_files) do
-                os.cp(val, iso_dir_bl)
-            end
+        created = true
+        os.tryrm(iso_dir)
+    end
 
-            for idx, val in ipairs(binaries) do
-                os.cp(val, iso_dir_bl)
-            end
+    depend.on_changed(create_iso, {
+        dependfile = target:dependfile(),
+        files = { kernelfile, limine_conf }
+    })
 
-            for idx, val in ipairs(uefi_binaries) do
-                os.cp(val, iso_dir_eb)
-            end
+    if not created and not os.isfile(targetfile) then
+        create_iso()
+    end
+end
 
-            os.cp(kernelfile, path.join(iso_dir_b, "kernel.elf"))
+target("iso")
+    set_default(true)
+    set_kind("phony")
+    add_deps("limine", "ovmf-binaries", "noise.elf")
 
-            multi_insert(xorriso_args,
-                iso_dir, "-o", targetfile
-            )
+    set_values("image_name", "image")
+    set_values("limine_conf", "limine.conf")
 
-            print(" => building the iso...")
-            os.execv(find_program("xorriso"), xorriso_args)
+    on_clean(function (target)
+        os.rm(get_targetfile(target:targetdir(), "image", ".iso"))
+    end)
 
-            print(" => installing limine...")
-            os.execv(limine_exec, { "bios-install", targetfile })
+    on_build(build_iso)
 
-            created = true
-            os.tryrm(iso_dir)
-        end
+-- Same kernel, booting straight into the in-kernel benchmarks.
+target("bench-iso")
+    set_default(false)
+    set_kind("phony")
+    add_deps("limine", "noise.elf")
 
-        depend.on_changed(create_iso, { files = { kernelfile } })
+    set_values("image_name", "bench")
+    set_values("limine_conf", "limine-bench.conf")
 
-        if not created and not os.isfile(targetfile) then
-            create_iso()
-        end
+    on_clean(function (target)
+        os.rm(get_targetfile(target:targetdir(), "bench", ".iso"))
     end)
 
+    on_build(build_iso)
+
 -- targets.run
 
 task("qemu")
@@ -446,6 +480,76 @@ task("qemu")
         os.execv(qemu_exec, qemu_args)
     end)
 
+-- Boots the bench image headless and collects its `bench:` lines, which the
+-- kernel prints on the serial port, into build/bench.txt.
+task("bench")
+    set_menu {
+        usage = "xmake bench [options]",
+        description = "Run the in-kernel benchmarks under QEMU.",
+        options = {
+            { nil, "tcg", "k", nil, "Use TCG even if an accelerator exists." },
+        }
+    }
+
+    on_run(function ()
+        import("core.base.option")
+        import("core.project.config")
+        import("core.project.project")
+        import("core.project.task")
+        import("lib.detect.find_program")
+
+        config.load()
+        task.run("build", { target = "bench-iso" })
+
+        local iso = project.target("bench-iso")
+        local image = get_targetfile(iso:targetdir(), "bench", ".iso")
+        local outdir = path.join(os.projectdir(), "build")
+        local logpath = path.join(outdir, "bench.log")
+        local resultpath = path.join(outdir, "bench.txt")
+
+        local args = {
+            "-M", "q35,smm=off", "-m", get_config("qemu_memory"),
+            "-cpu", "max,migratable=off,+invtsc,+tsc-deadline",
+            "-display", "none", "-serial", "stdio", "-no-reboot",
+            "-device", "isa-debug-exit,iobase=0xf4,iosize=0x04",
+            "-cdrom", image
+        }
+
+        if option.get("tcg") then
+            multi_insert(args, "-M", "accel=tcg")
+        else
+            multi_insert(args, unpack(qemu_accel_args))
+        end
+
+        print(" => running benchmarks...")
+        os.mkdir(outdir)
+
+        -- isa-debug-exit turns the kernel's exit code 0 into status 1.
+        local status = os.execv(find_program("qemu-system-x86_64"), args, {
+            stdout = logpath, try = true
+        })
+
+        local results = {}
+
+        for line in io.lines(logpath) do
+            line = line:gsub("\r$", "")
+
+            if line:startswith("bench: ") then
+                table.insert(results, line)
+                print(line)
+            end
+        end
+
+        io.writefile(resultpath, table.concat(results, "\n") .. "\n")
+
+        if status ~= 1 then
+            raise("benchmark run failed (qemu status %d), see %s",
+                status, logpath)
+        end
+
+        print(" => results in %s", resultpath)
+    end)
+
 target("bios")
     set_default(false)
     set_kind("phony")